@@ -219,6 +219,10 @@ SOURCE=..\..\src\lib\WPSList.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\lib\WPSMappedFileStream.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\lib\WPSOLEParser.cpp
 # End Source File
 # Begin Source File
@@ -235,6 +239,10 @@ SOURCE=..\..\src\lib\WPSParser.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\lib\WPSPlainTextGenerator.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\lib\WPSSubDocument.cpp
 # End Source File
 # Begin Source File
@@ -307,10 +315,18 @@ SOURCE=..\..\src\lib\WKS4Spreadsheet.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\lib\WKSCellStore.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\lib\WKSContentListener.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\lib\WKSFormulaCache.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\lib\WKSParser.h
 # End Source File
 # Begin Source File
@@ -375,6 +391,10 @@ SOURCE=..\..\src\lib\WPSEntry.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\lib\WPSFODIndex.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\lib\WPSFont.h
 # End Source File
 # Begin Source File
@@ -395,6 +415,10 @@ SOURCE=..\..\src\lib\WPSList.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\lib\WPSMappedFileStream.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\lib\WPSOLEParser.h
 # End Source File
 # Begin Source File
@@ -411,6 +435,10 @@ SOURCE=..\..\src\lib\WPSParser.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\lib\WPSPlainTextGenerator.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\lib\WPSPosition.h
 # End Source File
 # Begin Source File
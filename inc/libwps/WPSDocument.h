@@ -58,8 +58,48 @@ enum WPSCreator { WPS_MSWORKS=0 /**< Microsoft Works documents (all wps, wks and
 enum WPSKind { WPS_TEXT=0, WPS_SPREADSHEET, WPS_DATABASE };
 enum WPSResult { WPS_OK, WPS_ENCRYPTION_ERROR, WPS_FILE_ACCESS_ERROR, WPS_PARSE_ERROR, WPS_OLE_ERROR, WPS_UNKNOWN_ERROR };
 
+/** Some options which restrict the part of a document which is parsed and sent to the
+	document interface.
+
+	The default options send the whole document.
+*/
+struct WPSParseOptions
+{
+	//! constructor: sends everything
+	WPSParseOptions() : m_sheetId(-1), m_minRow(0), m_maxRow(-1), m_minColumn(0), m_maxColumn(-1), m_rangeName(), m_skipEmbeddedObjects(false), m_textOnly(false)
+	{
+	}
+	/** the spreadsheet to send (0 means the first sheet), or -1 to send all the sheets
+		(another negative value sends no sheet).
+
+		\note the other sheets are skipped when reading the file: their cells are not stored */
+	int m_sheetId;
+	/** the window of cells to send: the first and the last row (0 means the first row),
+		m_maxRow=-1 means no limit.
+
+		\note the cells outside the window are skipped when reading the file and the sheet's
+		rows after m_maxRow are not sent. The positions of the sent cells are not changed */
+	int m_minRow, m_maxRow;
+	/** the first and the last column of the window of cells to send,
+		m_maxColumn=-1 means no limit */
+	int m_minColumn, m_maxColumn;
+	/** the name of a range of cells to send. If it is set, the window and the sheet
+		are replaced by the range's cells; if the range is not found, no sheet is sent */
+	librevenge::RVNGString m_rangeName;
+	/** a flag to skip the embedded objects of the text documents: the pictures
+		and the OLE objects are neither decoded nor sent */
+	bool m_skipEmbeddedObjects;
+	/** a flag to only send the characters of the text documents: the page, section, paragraph
+		and span properties are empty, the lists, the headers/footers and the pictures are not sent */
+	bool m_textOnly;
+};
+
 /**
 This class provides all the functions an application would need to parse Works documents.
+
+\note the functions of this class are reentrant: the library does not keep any global
+mutable state, so different threads can parse different documents simultaneously. An input
+stream and an output interface must not be used by two threads at the same time.
 */
 class WPSDocument
 {
@@ -86,6 +126,45 @@ public:
 		- If no encoding is given, CP850 or CP1250 will be used.
 	*/
 	static WPSLIB WPSConfidence isFileFormatSupported(librevenge::RVNGInputStream *input, WPSKind &kind, WPSCreator &creator, bool &needCharSetEncoding);
+	/** Analyzes quickly the signature of an input stream: no parser is created, only the first
+		bytes of the file or, for an OLE file, the directory and the first bytes of the main stream
+		are read.
+		\param input The input stream
+		\param kind The document kind
+		\param creator The document creator
+		\param version The file format version found in the signature
+
+		\return WPS_CONFIDENCE_EXCELLENT if a known signature is found, WPS_CONFIDENCE_NONE otherwise.
+
+		\note as the content of the file is not checked, this function can accept some files
+		which are rejected by isFileFormatSupported. The creator and the version are deduced from
+		the signature only: for instance, a Works spreadsheet and a Lotus WK1 file with the same
+		signature can not be differentiated if the file is corrupted.
+	*/
+	static WPSLIB WPSConfidence sniffFileFormat(librevenge::RVNGInputStream *input, WPSKind &kind, WPSCreator &creator, int &version);
+	/**
+	   Analyzes the content of an input stream and parses it in one pass: the header and the parser
+	   created to check the file are kept to parse the document. The document is sent to
+	   textInterface if it is a text document, or to spreadsheetInterface if it is a spreadsheet
+	   or a database.
+	   \param input The input stream
+	   \param textInterface A librevenge::RVNGTextInterface implementation, can be null
+	   \param spreadsheetInterface A librevenge::RVNGSpreadsheetInterface implementation, can be null
+	   \param confidence The confidence value, see isFileFormatSupported
+	   \param kind The document kind
+	   \param creator The document creator
+	   \param options the parsing options
+	   \param password the file password
+	   \param encoding the encoding
+
+	   \note if the file is not supported, confidence is set to WPS_CONFIDENCE_NONE and
+	   WPS_UNKNOWN_ERROR is returned. If the interface corresponding to the document's kind
+	   is null, kind and creator are set and WPS_UNKNOWN_ERROR is returned.
+	*/
+	static WPSLIB WPSResult detectAndParse(librevenge::RVNGInputStream *input, librevenge::RVNGTextInterface *textInterface,
+	                                       librevenge::RVNGSpreadsheetInterface *spreadsheetInterface, WPSConfidence &confidence,
+	                                       WPSKind &kind, WPSCreator &creator, WPSParseOptions const &options=WPSParseOptions(),
+	                                       char const *password="", char const *encoding="");
 
 	/**
 	   Parses the input stream content. It will make callbacks to the functions provided by a
@@ -98,6 +177,16 @@ public:
 	*/
 	static WPSLIB WPSResult parse(librevenge::RVNGInputStream *input, librevenge::RVNGTextInterface *documentInterface,
 	                              char const *password="", char const *encoding="");
+	/**
+	   Parses the input stream content, but only sends the part of the document selected by options.
+	   \param input The input stream
+	   \param documentInterface A librevenge::RVNGTextInterface implementation
+	   \param options the parsing options, for instance to skip the embedded objects
+	   \param password the file password
+	   \param encoding the encoding
+	*/
+	static WPSLIB WPSResult parse(librevenge::RVNGInputStream *input, librevenge::RVNGTextInterface *documentInterface,
+	                              WPSParseOptions const &options, char const *password="", char const *encoding="");
 	/**
 	   Parses the input stream content. It will make callbacks to the functions provided by a
 	   librevenge::RVNGSpreadsheetInterface class implementation when needed. This is often commonly called the
@@ -109,6 +198,112 @@ public:
 	*/
 	static WPSLIB WPSResult parse(librevenge::RVNGInputStream *input, librevenge::RVNGSpreadsheetInterface *documentInterface,
 	                              char const *password="", char const *encoding="");
+	/**
+	   Extracts the characters of a text document: the document is parsed with the options
+	   m_textOnly and m_skipEmbeddedObjects, each paragraph ends with a line break.
+	   \param input The input stream
+	   \param text The UTF-8 string where the characters are appended
+	   \param password the file password
+	   \param encoding the encoding
+	*/
+	static WPSLIB WPSResult parseText(librevenge::RVNGInputStream *input, librevenge::RVNGString &text,
+	                                  char const *password="", char const *encoding="");
+	/**
+	   Parses the input stream content, but only sends the part of the document selected by options.
+	   \param input The input stream
+	   \param documentInterface A librevenge::RVNGSpreadsheetInterface implementation
+	   \param options the parsing options, for instance the sheet to send
+	   \param password the file password
+	   \param encoding the encoding
+	*/
+	static WPSLIB WPSResult parse(librevenge::RVNGInputStream *input, librevenge::RVNGSpreadsheetInterface *documentInterface,
+	                              WPSParseOptions const &options, char const *password="", char const *encoding="");
+
+	/** Analyzes the content of a local file to see if it can be parsed.
+		The file is mapped in memory, so that the parsers read directly its data.
+		\param fileName The file path
+		\param kind The document kind
+		\param creator The document creator
+		\param needCharSetEncoding A flag set to true if we need the character set encoding
+
+		\return A confidence value, see isFileFormatSupported(librevenge::RVNGInputStream *,...)
+	*/
+	static WPSLIB WPSConfidence isFileFormatSupported(char const *fileName, WPSKind &kind, WPSCreator &creator, bool &needCharSetEncoding);
+	/** Analyzes quickly the signature of a local file which is mapped in memory,
+		see sniffFileFormat(librevenge::RVNGInputStream *,...)
+		\param fileName The file path
+		\param kind The document kind
+		\param creator The document creator
+		\param version The file format version found in the signature
+	*/
+	static WPSLIB WPSConfidence sniffFileFormat(char const *fileName, WPSKind &kind, WPSCreator &creator, int &version);
+	/**
+	   Analyzes and parses a local file which is mapped in memory in one pass,
+	   see detectAndParse(librevenge::RVNGInputStream *,...)
+	   \param fileName The file path
+	   \param textInterface A librevenge::RVNGTextInterface implementation, can be null
+	   \param spreadsheetInterface A librevenge::RVNGSpreadsheetInterface implementation, can be null
+	   \param confidence The confidence value, see isFileFormatSupported
+	   \param kind The document kind
+	   \param creator The document creator
+	   \param options the parsing options
+	   \param password the file password
+	   \param encoding the encoding
+	*/
+	static WPSLIB WPSResult detectAndParse(char const *fileName, librevenge::RVNGTextInterface *textInterface,
+	                                       librevenge::RVNGSpreadsheetInterface *spreadsheetInterface, WPSConfidence &confidence,
+	                                       WPSKind &kind, WPSCreator &creator, WPSParseOptions const &options=WPSParseOptions(),
+	                                       char const *password="", char const *encoding="");
+	/**
+	   Parses a local file which is mapped in memory. It will make callbacks to the functions provided by a
+	   librevenge::RVNGTextInterface class implementation when needed.
+	   \param fileName The file path
+	   \param documentInterface A librevenge::RVNGTextInterface implementation
+	   \param password the file password
+	   \param encoding the encoding
+	*/
+	static WPSLIB WPSResult parse(char const *fileName, librevenge::RVNGTextInterface *documentInterface,
+	                              char const *password="", char const *encoding="");
+	/**
+	   Parses a local file which is mapped in memory, but only sends the part of the document selected by options.
+	   \param fileName The file path
+	   \param documentInterface A librevenge::RVNGTextInterface implementation
+	   \param options the parsing options, for instance to skip the embedded objects
+	   \param password the file password
+	   \param encoding the encoding
+	*/
+	static WPSLIB WPSResult parse(char const *fileName, librevenge::RVNGTextInterface *documentInterface,
+	                              WPSParseOptions const &options, char const *password="", char const *encoding="");
+	/**
+	   Parses a local file which is mapped in memory. It will make callbacks to the functions provided by a
+	   librevenge::RVNGSpreadsheetInterface class implementation when needed.
+	   \param fileName The file path
+	   \param documentInterface A librevenge::RVNGSpreadsheetInterface implementation
+	   \param password the file password
+	   \param encoding the encoding
+	*/
+	static WPSLIB WPSResult parse(char const *fileName, librevenge::RVNGSpreadsheetInterface *documentInterface,
+	                              char const *password="", char const *encoding="");
+	/**
+	   Extracts the characters of a local text document which is mapped in memory,
+	   see parseText(librevenge::RVNGInputStream *,...)
+	   \param fileName The file path
+	   \param text The UTF-8 string where the characters are appended
+	   \param password the file password
+	   \param encoding the encoding
+	*/
+	static WPSLIB WPSResult parseText(char const *fileName, librevenge::RVNGString &text,
+	                                  char const *password="", char const *encoding="");
+	/**
+	   Parses a local file which is mapped in memory, but only sends the part of the document selected by options.
+	   \param fileName The file path
+	   \param documentInterface A librevenge::RVNGSpreadsheetInterface implementation
+	   \param options the parsing options, for instance the sheet to send
+	   \param password the file password
+	   \param encoding the encoding
+	*/
+	static WPSLIB WPSResult parse(char const *fileName, librevenge::RVNGSpreadsheetInterface *documentInterface,
+	                              WPSParseOptions const &options, char const *password="", char const *encoding="");
 };
 
 } // namespace libwps
@@ -0,0 +1,153 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* libwps
+ * Version: MPL 2.0 / LGPLv2.1+
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * For minor contributions see the git repository.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU Lesser General Public License Version 2.1 or later
+ * (LGPLv2.1+), in which case the provisions of the LGPLv2.1+ are
+ * applicable instead of those above.
+ *
+ * For further information visit http://libwps.sourceforge.net
+ */
+
+/* a microbenchmark of the attribute index used by the text parsers:
+   builds a large synthetic set of FDP runs (fonts, paragraphs and PLCs),
+   merges it in the index like WPS4Text does, then looks for many text
+   zones and walks their attributes like the readText functions. The
+   lookups are also done on the attribute records to compare with the
+   search on the separated position array. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "WPSFODIndex.h"
+
+namespace
+{
+//! a small deterministic random generator
+struct Random
+{
+	//! constructor
+	explicit Random(unsigned long seed) : m_value(seed)
+	{
+	}
+	//! returns a value in [0, max[
+	long get(long max)
+	{
+		m_value = (m_value*1103515245UL+12345UL)&0x7fffffffUL;
+		return long(m_value%(unsigned long)(max));
+	}
+	//! the actual value
+	unsigned long m_value;
+};
+
+//! compares the position of an attribute with a text position
+struct FODPosLess
+{
+	//! compares the position of an attribute with a text position
+	bool operator()(WPSFOD const &fod, long pos) const
+	{
+		return fod.m_pos < pos;
+	}
+};
+
+//! creates the runs of one FDP type: one run every step bytes (in average)
+void createRuns(std::vector<WPSFOD> &runs, WPSFOD::Type type, long textLength, long step, Random &random)
+{
+	runs.resize(0);
+	int id = 0;
+	for (long pos = 0; pos < textLength; pos += 1+random.get(2*step))
+	{
+		WPSFOD fod;
+		fod.m_type = type;
+		fod.m_pos = pos;
+		fod.m_defPos = 0x80*(long(runs.size())/20);
+		fod.m_id = id++%1000;
+		runs.push_back(fod);
+	}
+}
+
+//! returns the time spent since start in seconds
+double elapsed(clock_t start)
+{
+	return double(clock()-start)/CLOCKS_PER_SEC;
+}
+}
+
+int main(int argc, char const *argv[])
+{
+	long const textLength = argc > 1 ? atol(argv[1]) : 8000000;
+	long const numZones = argc > 2 ? atol(argv[2]) : 200000;
+	long const zoneLength = 512;
+	if (textLength <= zoneLength || numZones <= 0)
+	{
+		fprintf(stderr, "Usage: wps-fod-bench [text length (> %ld)] [number of zones]\n", zoneLength);
+		return 1;
+	}
+
+	Random random(1);
+	std::vector<WPSFOD> fonts, paragraphs, plcs;
+	createRuns(fonts, WPSFOD::ATTR_TEXT, textLength, 8, random);
+	createRuns(paragraphs, WPSFOD::ATTR_PARAG, textLength, 64, random);
+	createRuns(plcs, WPSFOD::ATTR_PLC, textLength, 512, random);
+
+	clock_t start = clock();
+	WPSFODIndex index;
+	index.merge(fonts, 0, textLength, true);
+	index.merge(paragraphs, 0, textLength, true);
+	index.merge(plcs, 0, textLength, true);
+	printf("merge of %ld attributes: %.3fs\n", long(index.size()), elapsed(start));
+
+	std::vector<long> zones(static_cast<size_t>(numZones));
+	for (size_t z = 0; z < zones.size(); ++z)
+		zones[z] = random.get(textLength-zoneLength);
+
+	// the index: search, then search and walk on the positions
+	long checksum = 0;
+	start = clock();
+	for (size_t z = 0; z < zones.size(); ++z)
+		checksum += long(index.findFirst(zones[z]));
+	printf("%ld searches, position array: %.3fs (%ld)\n", numZones, elapsed(start), checksum);
+	checksum = 0;
+	start = clock();
+	for (size_t z = 0; z < zones.size(); ++z)
+	{
+		long const end = zones[z]+zoneLength;
+		for (size_t i = index.findFirst(zones[z]); i < index.size() && index.position(i) < end; ++i)
+			checksum += index[i].m_id;
+	}
+	printf("%ld zones, position array: %.3fs (%ld)\n", numZones, elapsed(start), checksum);
+
+	// the same lookups on the attribute records
+	std::vector<WPSFOD> records;
+	records.reserve(index.size());
+	for (size_t i = 0; i < index.size(); ++i)
+		records.push_back(index[i]);
+	checksum = 0;
+	start = clock();
+	for (size_t z = 0; z < zones.size(); ++z)
+		checksum += long(std::lower_bound(records.begin(), records.end(), zones[z], FODPosLess())-records.begin());
+	printf("%ld searches, attribute records: %.3fs (%ld)\n", numZones, elapsed(start), checksum);
+	checksum = 0;
+	start = clock();
+	for (size_t z = 0; z < zones.size(); ++z)
+	{
+		long const end = zones[z]+zoneLength;
+		std::vector<WPSFOD>::const_iterator it = std::lower_bound(records.begin(), records.end(), zones[z], FODPosLess());
+		for (; it != records.end() && it->m_pos < end; ++it)
+			checksum += it->m_id;
+	}
+	printf("%ld zones, attribute records: %.3fs (%ld)\n", numZones, elapsed(start), checksum);
+	return 0;
+}
+/* vim:set shiftwidth=4 softtabstop=4 noexpandtab: */
@@ -0,0 +1,190 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* libwps
+ * Version: MPL 2.0 / LGPLv2.1+
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * For minor contributions see the git repository.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU Lesser General Public License Version 2.1 or later
+ * (LGPLv2.1+), in which case the provisions of the LGPLv2.1+ are
+ * applicable instead of those above.
+ *
+ * For further information visit http://libwps.sourceforge.net
+ */
+
+/* a benchmark of the format detection: compares the per-file latency of
+   WPSDocument::sniffFileFormat with WPSDocument::isFileFormatSupported.
+   The files are loaded in memory first, so that only the detection is
+   timed. Without argument, a small synthetic corpus is used: a Works
+   text file, a Works spreadsheet with many cells and a file with random
+   data. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+#include <librevenge/librevenge.h>
+#include <librevenge-stream/librevenge-stream.h>
+
+#include <libwps/libwps.h>
+
+namespace
+{
+//! a file loaded in memory
+struct File
+{
+	//! constructor
+	File() : m_name(), m_data()
+	{
+	}
+	//! the file name
+	std::string m_name;
+	//! the file content
+	std::vector<unsigned char> m_data;
+};
+
+//! loads a file in memory
+bool loadFile(char const *name, File &file)
+{
+	FILE *f = fopen(name, "rb");
+	if (!f) return false;
+	file.m_name = name;
+	file.m_data.resize(0);
+	unsigned char buffer[4096];
+	size_t numRead;
+	while ((numRead = fread(buffer, 1, sizeof(buffer), f)) > 0)
+		file.m_data.insert(file.m_data.end(), buffer, buffer+numRead);
+	fclose(f);
+	return !file.m_data.empty();
+}
+
+//! appends a little endian 16 bits value
+void appendU16(std::vector<unsigned char> &data, unsigned val)
+{
+	data.push_back((unsigned char)(val&0xff));
+	data.push_back((unsigned char)((val>>8)&0xff));
+}
+
+//! creates the synthetic corpus
+void createCorpus(std::vector<File> &corpus)
+{
+	File file;
+	// a Works DOS text file: the header, then the text
+	file.m_name = "synthetic text";
+	file.m_data.assign(0x100, 0);
+	file.m_data[0] = 0x3;
+	file.m_data[1] = 0xfe;
+	for (int i = 0; i < 20000; ++i)
+		file.m_data.push_back((unsigned char)(i%64==63 ? 0xd : 'a'+i%26));
+	corpus.push_back(file);
+
+	// a Works DOS spreadsheet: the BOF record, many integer cells, then the EOF record
+	file.m_name = "synthetic spreadsheet";
+	file.m_data.resize(0);
+	appendU16(file.m_data, 0);
+	appendU16(file.m_data, 2);
+	appendU16(file.m_data, 0x404);
+	for (unsigned i = 0; i < 20000; ++i)
+	{
+		appendU16(file.m_data, 0xd);
+		appendU16(file.m_data, 7);
+		file.m_data.push_back(0xff);
+		appendU16(file.m_data, i%256);
+		appendU16(file.m_data, i/256);
+		appendU16(file.m_data, i);
+	}
+	appendU16(file.m_data, 1);
+	appendU16(file.m_data, 0);
+	corpus.push_back(file);
+
+	// random data
+	file.m_name = "synthetic random data";
+	file.m_data.resize(0);
+	unsigned long value = 1;
+	for (int i = 0; i < 0x10000; ++i)
+	{
+		value = (value*1103515245UL+12345UL)&0x7fffffffUL;
+		file.m_data.push_back((unsigned char)(value>>16));
+	}
+	corpus.push_back(file);
+}
+
+//! returns the time spent since start in microseconds
+double elapsed(clock_t start)
+{
+	return 1e6*double(clock()-start)/CLOCKS_PER_SEC;
+}
+}
+
+int main(int argc, char const *argv[])
+{
+	int numLoops = 100;
+	int firstFile = 1;
+	if (argc > 2 && std::string(argv[1]) == "-n")
+	{
+		numLoops = atoi(argv[2]);
+		firstFile = 3;
+	}
+	if (numLoops <= 0)
+	{
+		fprintf(stderr, "Usage: wps-sniff-bench [-n numLoops] [file]...\n");
+		return 1;
+	}
+	std::vector<File> corpus;
+	for (int i = firstFile; i < argc; ++i)
+	{
+		File file;
+		if (!loadFile(argv[i], file))
+		{
+			fprintf(stderr, "wps-sniff-bench: can not read %s\n", argv[i]);
+			continue;
+		}
+		corpus.push_back(file);
+	}
+	if (firstFile == argc)
+		createCorpus(corpus);
+
+	double totalSniff = 0, totalCheck = 0;
+	for (size_t f = 0; f < corpus.size(); ++f)
+	{
+		File const &file = corpus[f];
+		libwps::WPSKind kind = libwps::WPS_TEXT;
+		libwps::WPSCreator creator = libwps::WPS_MSWORKS;
+		int version = 0;
+		libwps::WPSConfidence sniffConfidence = libwps::WPS_CONFIDENCE_NONE;
+		clock_t start = clock();
+		for (int l = 0; l < numLoops; ++l)
+		{
+			librevenge::RVNGStringStream input(&file.m_data[0], (unsigned int)(file.m_data.size()));
+			sniffConfidence = libwps::WPSDocument::sniffFileFormat(&input, kind, creator, version);
+		}
+		double const sniffTime = elapsed(start)/numLoops;
+
+		bool needEncoding;
+		libwps::WPSConfidence checkConfidence = libwps::WPS_CONFIDENCE_NONE;
+		start = clock();
+		for (int l = 0; l < numLoops; ++l)
+		{
+			librevenge::RVNGStringStream input(&file.m_data[0], (unsigned int)(file.m_data.size()));
+			checkConfidence = libwps::WPSDocument::isFileFormatSupported(&input, kind, creator, needEncoding);
+		}
+		double const checkTime = elapsed(start)/numLoops;
+
+		printf("%s (%ld bytes): sniffFileFormat %.1fus [confidence %d], isFileFormatSupported %.1fus [confidence %d]\n",
+		       file.m_name.c_str(), long(file.m_data.size()), sniffTime, int(sniffConfidence), checkTime, int(checkConfidence));
+		totalSniff += sniffTime;
+		totalCheck += checkTime;
+	}
+	if (!corpus.empty())
+		printf("average by file: sniffFileFormat %.1fus, isFileFormatSupported %.1fus\n",
+		       totalSniff/double(corpus.size()), totalCheck/double(corpus.size()));
+	return 0;
+}
+/* vim:set shiftwidth=4 softtabstop=4 noexpandtab: */
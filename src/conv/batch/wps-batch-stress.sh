@@ -0,0 +1,101 @@
+#!/bin/sh
+# libwps
+# Version: MPL 2.0 / LGPLv2.1+
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# Alternatively, the contents of this file may be used under the terms
+# of the GNU Lesser General Public License Version 2.1 or later
+# (LGPLv2.1+), in which case the provisions of the LGPLv2.1+ are
+# applicable instead of those above.
+
+# Concurrent parsing stress test: parses the same files many times with
+# several threads of wps-batch and checks that the reports are identical
+# to a single thread run.
+#
+# To detect the data races, build the library and wps-batch with the
+# ThreadSanitizer (and without --enable-static-tools), for instance:
+#
+#   ./configure --disable-werror \
+#       CXXFLAGS="-g -O1 -fsanitize=thread" LDFLAGS="-fsanitize=thread"
+#   make
+#   src/conv/batch/wps-batch-stress.sh -j 8 -n 20 /path/to/documents
+#
+# Any ThreadSanitizer report stops wps-batch with the exit code 66, which
+# makes this script fail; the files which can not be converted (exit code
+# 1) are not errors, only the reports must be identical. Note that wps-batch uses only one thread if the
+# POSIX threads have not been found by configure.
+#
+# Usage: wps-batch-stress.sh [-j threads] [-n repeat] <file or directory>...
+#   -j threads: the number of worker threads (default 8)
+#   -n repeat:  the number of times each file is parsed (default 10)
+# The WPS_BATCH environment variable can be used to define the wps-batch
+# executable (default: wps-batch in the directory of this script).
+
+threads=8
+repeat=10
+while getopts "j:n:" opt; do
+	case $opt in
+	j) threads=$OPTARG ;;
+	n) repeat=$OPTARG ;;
+	*) sed -n 's/^# \{0,1\}//;/^Usage:/,/^executable/p' "$0" >&2; exit 1 ;;
+	esac
+done
+shift $((OPTIND-1))
+if [ $# -eq 0 ]; then
+	echo "wps-batch-stress.sh: no input file" >&2
+	exit 1
+fi
+
+batch=${WPS_BATCH:-$(dirname "$0")/wps-batch}
+if [ ! -x "$batch" ]; then
+	echo "wps-batch-stress.sh: can not find the wps-batch executable $batch" >&2
+	exit 1
+fi
+
+TSAN_OPTIONS="halt_on_error=1 exitcode=66 $TSAN_OPTIONS"
+export TSAN_OPTIONS
+
+tmp=$(mktemp -d) || exit 1
+trap 'rm -rf "$tmp"' EXIT
+
+# the list of files, each file repeated, so that the workers parse the same files at the same time
+find "$@" -type f | sort > "$tmp/files"
+: > "$tmp/list"
+i=0
+while [ $i -lt "$repeat" ]; do
+	cat "$tmp/files" >> "$tmp/list"
+	i=$((i+1))
+done
+
+# runs wps-batch: returns 0 if the run is complete, i.e. if wps-batch
+# returns 0 or 1 (some files can not be converted), 1 otherwise
+run_batch() {
+	report=$1
+	shift
+	"$batch" "$@" -l "$tmp/list" -r "$report"
+	rc=$?
+	case $rc in
+	0|1) return 0 ;;
+	66) echo "wps-batch $*: ThreadSanitizer finds a data race" >&2 ;;
+	*) echo "wps-batch $*: fails with the exit code $rc" >&2 ;;
+	esac
+	return 1
+}
+
+status=0
+for mode in "" "-t" "-d"; do
+	# shellcheck disable=SC2086
+	run_batch "$tmp/reference" $mode -j 1 || { status=1; continue; }
+	# shellcheck disable=SC2086
+	run_batch "$tmp/report" $mode -j "$threads" || { status=1; continue; }
+	if ! cmp -s "$tmp/reference" "$tmp/report"; then
+		echo "wps-batch $mode: the reports with 1 and $threads threads differ" >&2
+		diff "$tmp/reference" "$tmp/report" | head -n 20 >&2
+		status=1
+	fi
+done
+[ $status -eq 0 ] && echo "wps-batch-stress.sh: $(wc -l < "$tmp/list") parses by mode with $threads threads: ok"
+exit $status
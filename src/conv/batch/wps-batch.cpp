@@ -0,0 +1,496 @@
+/* libwps
+ * Version: MPL 2.0 / LGPLv2.1+
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * For minor contributions see the git repository.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU Lesser General Public License Version 2.1 or later
+ * (LGPLv2.1+), in which case the provisions of the LGPLv2.1+ are
+ * applicable instead of those above.
+ *
+ * For further information visit http://libwps.sourceforge.net
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <librevenge/librevenge.h>
+#include <librevenge-generators/librevenge-generators.h>
+#include <librevenge-stream/librevenge-stream.h>
+
+#include <libwps/libwps.h>
+
+using namespace libwps;
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_DIRENT_H
+#include <dirent.h>
+#endif
+
+#if defined(HAVE_PTHREAD) && defined(HAVE_PTHREAD_H)
+#include <pthread.h>
+#define WPS_BATCH_USE_THREADS 1
+#endif
+
+#ifndef VERSION
+#define VERSION "UNKNOWN VERSION"
+#endif
+
+static int printUsage()
+{
+	printf("Usage: wps-batch [OPTION] <file or directory>...\n");
+	printf("\n");
+	printf("Converts a list of Works, Write, Word for DOS, Lotus or Quattro Pro files:\n");
+	printf("the text documents in text files, the spreadsheets and databases in csv files\n");
+	printf("(first sheet), then writes a report: one line by file containing its status,\n");
+	printf("its kind, its name and the output name separated by tabs.\n");
+	printf("\n");
+	printf("Options:\n");
+	printf("\t-d:                Only detects the format of the files from their signature (fast)\n");
+	printf("\t-e \"encoding\":   Define the file encoding where encoding can be\n");
+	printf("\t\t CP037, CP424, CP437, CP737, CP500, CP775, CP850, CP852, CP855, CP856, CP857,\n");
+	printf("\t\t CP860, CP861, CP862, CP863, CP864, CP865, CP866, CP869, CP874, CP875, CP932,\n");
+	printf("\t\t CP950, CP1006, CP1026, CP1250, CP1251, CP1252, CP1253, CP1254, CP1255, CP1256,\n");
+	printf("\t\t CP1257, CP1258, MacArabic, MacCeltic, MacCEurope, MacCroation, MacCyrillic,\n");
+	printf("\t\t MacDevanage, MacFarsi, MacGaelic, MacGreek, MacGujarati, MacGurmukhi, MacHebrew,\n");
+	printf("\t\t MacIceland, MacInuit, MacRoman, MacRomanian, MacThai, MacTurkish.\n");
+	printf("\t-h:                Shows this help message\n");
+	printf("\t-j num:            Sets the number of worker threads: default the number of processors\n");
+	printf("\t-l list:           Reads the file names in list, one by line (- means the standard input)\n");
+	printf("\t-o directory:      Defines the output directory, if not set, the files are\n");
+	printf("\t\t only checked and parsed\n");
+	printf("\t-p password:       Password to open the files\n");
+	printf("\t-r report:         Defines the report file: default the standard output\n");
+	printf("\t-t:                Only extracts the characters of the text documents (faster)\n");
+	printf("\t-v:                Output wps-batch version\n");
+	printf("\n");
+	printf("Note:\n");
+	printf("\t The directories are read recursively. The output name is the input path\n");
+	printf("\t where the '/' are replaced by '_', followed by .txt or .csv.\n");
+	return -1;
+}
+
+static int printVersion()
+{
+	printf("wps-batch %s\n", VERSION);
+	return 0;
+}
+
+//! the parameters shared by all the workers
+struct BatchParameters
+{
+	//! constructor
+	BatchParameters() : m_encoding(""), m_password(0), m_outputDir(), m_detectOnly(false), m_textOnly(false)
+	{
+	}
+	//! the file encoding
+	char const *m_encoding;
+	//! the file password
+	char const *m_password;
+	//! the output directory (empty if we do not write the output)
+	std::string m_outputDir;
+	//! a flag to only detect the format of the files
+	bool m_detectOnly;
+	//! a flag to only extract the characters of the text documents
+	bool m_textOnly;
+private:
+	BatchParameters(BatchParameters const &orig);
+	BatchParameters &operator=(BatchParameters const &orig);
+};
+
+//! the result of a conversion
+struct BatchResult
+{
+	//! constructor
+	BatchResult() : m_status("unknown"), m_kind("-"), m_output("-"), m_ok(false)
+	{
+	}
+	//! the status: ok, unsupported or the error
+	std::string m_status;
+	//! the document kind
+	std::string m_kind;
+	//! the output name
+	std::string m_output;
+	//! true if the conversion succeeds
+	bool m_ok;
+};
+
+//! the work list: the files and the results, the next file to convert
+struct BatchWork
+{
+	//! constructor
+	explicit BatchWork(BatchParameters const &param) : m_parameters(param), m_files(), m_results(), m_next(0)
+#ifdef WPS_BATCH_USE_THREADS
+		, m_mutex()
+#endif
+	{
+#ifdef WPS_BATCH_USE_THREADS
+		pthread_mutex_init(&m_mutex, 0);
+#endif
+	}
+	//! destructor
+	~BatchWork()
+	{
+#ifdef WPS_BATCH_USE_THREADS
+		pthread_mutex_destroy(&m_mutex);
+#endif
+	}
+	//! returns the next file to convert or -1
+	long nextFile();
+
+	//! the parameters
+	BatchParameters const &m_parameters;
+	//! the list of files
+	std::vector<std::string> m_files;
+	//! the list of results
+	std::vector<BatchResult> m_results;
+	//! the next file to convert
+	size_t m_next;
+#ifdef WPS_BATCH_USE_THREADS
+	//! the mutex which protects m_next
+	pthread_mutex_t m_mutex;
+#endif
+private:
+	BatchWork(BatchWork const &orig);
+	BatchWork &operator=(BatchWork const &orig);
+};
+
+long BatchWork::nextFile()
+{
+#ifdef WPS_BATCH_USE_THREADS
+	pthread_mutex_lock(&m_mutex);
+#endif
+	long res=m_next<m_files.size() ? long(m_next++) : -1;
+#ifdef WPS_BATCH_USE_THREADS
+	pthread_mutex_unlock(&m_mutex);
+#endif
+	return res;
+}
+
+static char const *getErrorString(WPSResult error)
+{
+	switch (error)
+	{
+	case WPS_OK:
+		return "ok";
+	case WPS_ENCRYPTION_ERROR:
+		return "encryption-error";
+	case WPS_FILE_ACCESS_ERROR:
+		return "file-access-error";
+	case WPS_PARSE_ERROR:
+		return "parse-error";
+	case WPS_OLE_ERROR:
+		return "ole-error";
+	case WPS_UNKNOWN_ERROR:
+	default:
+		break;
+	}
+	return "unknown-error";
+}
+
+static std::string getOutputName(BatchParameters const &param, std::string const &file, char const *extension)
+{
+	std::string name(file);
+	for (size_t c=0; c<name.length(); ++c)
+	{
+		if (name[c]=='/' || name[c]=='\\' || name[c]==':')
+			name[c]='_';
+	}
+	return param.m_outputDir+"/"+name+extension;
+}
+
+static bool writeOutput(std::string const &name, librevenge::RVNGString const &data)
+{
+	std::ofstream out(name.c_str());
+	if (!out.is_open())
+		return false;
+	out << data.cstr();
+	return out.good();
+}
+
+//! converts a file and returns the result
+static BatchResult convert(BatchParameters const &param, std::string const &file)
+{
+	BatchResult res;
+	WPSCreator creator;
+	WPSKind kind=WPS_TEXT;
+	WPSConfidence confidence=WPS_CONFIDENCE_NONE;
+	if (param.m_detectOnly)
+	{
+		int version;
+		if (WPSDocument::sniffFileFormat(file.c_str(), kind, creator, version)==WPS_CONFIDENCE_NONE)
+		{
+			res.m_status="unsupported";
+			return res;
+		}
+		res.m_status="ok";
+		res.m_kind=kind==WPS_TEXT ? "text" : kind==WPS_DATABASE ? "database" : "spreadsheet";
+		res.m_ok=true;
+		return res;
+	}
+	WPSParseOptions options;
+	options.m_sheetId=0;
+	if (param.m_textOnly)
+		options.m_skipEmbeddedObjects=options.m_textOnly=true;
+
+	librevenge::RVNGString document;
+	librevenge::RVNGStringVector sheets;
+	librevenge::RVNGTextTextGenerator textImpl(document);
+	librevenge::RVNGCSVSpreadsheetGenerator spreadsheetImpl(sheets, false);
+	WPSResult error=WPS_OK;
+	try
+	{
+		// detects the format and parses the file in one pass
+		error=WPSDocument::detectAndParse(file.c_str(), &textImpl, &spreadsheetImpl, confidence, kind, creator, options,
+		                                  param.m_password, param.m_encoding);
+	}
+	catch (...)
+	{
+		error=WPS_UNKNOWN_ERROR;
+	}
+	if (confidence == WPS_CONFIDENCE_NONE)
+	{
+		res.m_status="unsupported";
+		return res;
+	}
+
+	char const *extension=".txt";
+	if (kind==WPS_TEXT)
+		res.m_kind="text";
+	else
+	{
+		res.m_kind=kind==WPS_DATABASE ? "database" : "spreadsheet";
+		extension=".csv";
+		if (error==WPS_OK && sheets.empty())
+			error=WPS_PARSE_ERROR;
+		else if (error==WPS_OK)
+			document=sheets[0];
+	}
+	res.m_status=getErrorString(error);
+	if (error!=WPS_OK)
+		return res;
+	if (!param.m_outputDir.empty())
+	{
+		res.m_output=getOutputName(param, file, extension);
+		if (!writeOutput(res.m_output, document))
+		{
+			res.m_status="write-error";
+			return res;
+		}
+	}
+	res.m_ok=true;
+	return res;
+}
+
+//! the worker main function: converts the files until the list is empty
+static void *convertFiles(void *data)
+{
+	BatchWork *work=static_cast<BatchWork *>(data);
+	if (!work) return 0;
+	long id;
+	while ((id=work->nextFile())>=0)
+		work->m_results[size_t(id)]=convert(work->m_parameters, work->m_files[size_t(id)]);
+	return 0;
+}
+
+//! adds a file or the files of a directory (recursively) in the list
+static void addFiles(std::string const &name, std::vector<std::string> &files)
+{
+	struct stat status;
+	if (stat(name.c_str(), &status)!=0)
+	{
+		fprintf(stderr, "ERROR: Can not find %s\n", name.c_str());
+		return;
+	}
+	if (!S_ISDIR(status.st_mode))
+	{
+		files.push_back(name);
+		return;
+	}
+#ifdef HAVE_DIRENT_H
+	DIR *dir=opendir(name.c_str());
+	if (!dir)
+	{
+		fprintf(stderr, "ERROR: Can not open the directory %s\n", name.c_str());
+		return;
+	}
+	std::vector<std::string> children;
+	struct dirent *entry;
+	while ((entry=readdir(dir))!=0)
+	{
+		if (strcmp(entry->d_name, ".")==0 || strcmp(entry->d_name, "..")==0)
+			continue;
+		children.push_back(name+"/"+entry->d_name);
+	}
+	closedir(dir);
+	for (size_t c=0; c<children.size(); ++c)
+		addFiles(children[c], files);
+#else
+	fprintf(stderr, "ERROR: Can not read the directory %s\n", name.c_str());
+#endif
+}
+
+//! reads a list of file names, one by line
+static bool readFileList(char const *listName, std::vector<std::string> &files)
+{
+	std::ifstream listFile;
+	bool useStdin=strcmp(listName, "-")==0;
+	if (!useStdin)
+	{
+		listFile.open(listName);
+		if (!listFile.is_open())
+			return false;
+	}
+	std::istream &input=useStdin ? std::cin : listFile;
+	std::string line;
+	while (std::getline(input, line))
+	{
+		if (!line.empty() && line[line.length()-1]=='\r')
+			line.resize(line.length()-1);
+		if (!line.empty())
+			addFiles(line, files);
+	}
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	bool printHelp=false;
+	int ch;
+	int numThreads=1;
+#if defined(WPS_BATCH_USE_THREADS) && defined(_SC_NPROCESSORS_ONLN)
+	numThreads=int(sysconf(_SC_NPROCESSORS_ONLN));
+#endif
+	char const *listName=0;
+	char const *reportName=0;
+	BatchParameters param;
+
+	while ((ch = getopt(argc, argv, "de:hj:l:o:p:r:tv")) != -1)
+	{
+		switch (ch)
+		{
+		case 'd':
+			param.m_detectOnly=true;
+			break;
+		case 'e':
+			param.m_encoding=optarg;
+			break;
+		case 'j':
+			numThreads=std::atoi(optarg);
+			break;
+		case 'l':
+			listName=optarg;
+			break;
+		case 'o':
+			param.m_outputDir=optarg;
+			break;
+		case 'p':
+			param.m_password=optarg;
+			break;
+		case 'r':
+			reportName=optarg;
+			break;
+		case 't':
+			param.m_textOnly=true;
+			break;
+		case 'v':
+			printVersion();
+			return 0;
+		default:
+		case 'h':
+			printHelp = true;
+			break;
+		}
+	}
+	if ((argc == optind && !listName) || printHelp)
+	{
+		printUsage();
+		return -1;
+	}
+	if (numThreads<1) numThreads=1;
+
+	BatchWork work(param);
+	if (listName && !readFileList(listName, work.m_files))
+	{
+		fprintf(stderr, "ERROR: Can not read the list %s\n", listName);
+		return 1;
+	}
+	for (int i=optind; i<argc; ++i)
+		addFiles(argv[i], work.m_files);
+	work.m_results.resize(work.m_files.size());
+
+#ifdef WPS_BATCH_USE_THREADS
+	if (size_t(numThreads)>work.m_files.size())
+		numThreads=int(work.m_files.size());
+	if (numThreads>1)
+	{
+		std::vector<pthread_t> threads;
+		for (int i=0; i<numThreads; ++i)
+		{
+			pthread_t thread;
+			if (pthread_create(&thread, 0, convertFiles, &work)!=0)
+			{
+				fprintf(stderr, "ERROR: Can not create a new thread\n");
+				break;
+			}
+			threads.push_back(thread);
+		}
+		// if no thread can be created, the main thread does the work
+		if (threads.empty())
+			convertFiles(&work);
+		for (size_t i=0; i<threads.size(); ++i)
+			pthread_join(threads[i], 0);
+	}
+	else
+		convertFiles(&work);
+#else
+	if (numThreads>1)
+		fprintf(stderr, "WARNING: The threads are not supported, the files are converted sequentially\n");
+	convertFiles(&work);
+#endif
+
+	std::ofstream reportFile;
+	if (reportName)
+	{
+		reportFile.open(reportName);
+		if (!reportFile.is_open())
+		{
+			fprintf(stderr, "ERROR: Can not create the report %s\n", reportName);
+			return 1;
+		}
+	}
+	std::ostream &report=reportName ? reportFile : std::cout;
+	size_t numOk=0, numUnsupported=0;
+	for (size_t i=0; i<work.m_files.size(); ++i)
+	{
+		BatchResult const &res=work.m_results[i];
+		report << res.m_status << "\t" << res.m_kind << "\t" << work.m_files[i] << "\t" << res.m_output << "\n";
+		if (res.m_ok)
+			++numOk;
+		else if (res.m_status=="unsupported")
+			++numUnsupported;
+	}
+	report.flush();
+	fprintf(stderr, "wps-batch: %lu files, %lu converted, %lu unsupported, %lu errors\n",
+	        (unsigned long) work.m_files.size(), (unsigned long) numOk, (unsigned long) numUnsupported,
+	        (unsigned long)(work.m_files.size()-numOk-numUnsupported));
+	return numOk+numUnsupported==work.m_files.size() ? 0 : 1;
+}
+
+/* vim:set shiftwidth=4 softtabstop=4 noexpandtab: */
@@ -97,12 +97,12 @@ int main(int argc, char *argv[])
 		return -1;
 	}
 
-	librevenge::RVNGFileStream input(argv[optind]);
+	char const *file=argv[optind];
 
 	WPSCreator creator;
 	WPSKind kind;
 	bool needCharEncoding;
-	WPSConfidence confidence = WPSDocument::isFileFormatSupported(&input,kind,creator,needCharEncoding);
+	WPSConfidence confidence = WPSDocument::isFileFormatSupported(file,kind,creator,needCharEncoding);
 	if (confidence == WPS_CONFIDENCE_NONE || kind != WPS_TEXT)
 	{
 		printf("ERROR: Unsupported file format!\n");
@@ -111,7 +111,7 @@ int main(int argc, char *argv[])
 
 	librevenge::RVNGString document;
 	librevenge::RVNGHTMLTextGenerator listenerImpl(document);
-	WPSResult error = WPSDocument::parse(&input, &listenerImpl, password, encoding);
+	WPSResult error = WPSDocument::parse(file, &listenerImpl, password, encoding);
 
 	if (error == WPS_ENCRYPTION_ERROR)
 		fprintf(stderr, "ERROR: Encrypted file, bad Password!\n");
@@ -89,12 +89,10 @@ int main(int argc, char *argv[])
 	if (!file)
 		return printUsage();
 
-	librevenge::RVNGFileStream input(file);
-
 	WPSCreator creator;
 	WPSKind kind;
 	bool needCharEncoding;
-	WPSConfidence confidence = WPSDocument::isFileFormatSupported(&input,kind,creator, needCharEncoding);
+	WPSConfidence confidence = WPSDocument::isFileFormatSupported(file,kind,creator, needCharEncoding);
 	if (confidence == WPS_CONFIDENCE_NONE || kind != WPS_TEXT)
 	{
 		printf("ERROR: Unsupported file format!\n");
@@ -102,7 +100,7 @@ int main(int argc, char *argv[])
 	}
 
 	librevenge::RVNGRawTextGenerator listenerImpl(printIndentLevel);
-	WPSResult error= WPSDocument::parse(&input, &listenerImpl, password);
+	WPSResult error= WPSDocument::parse(file, &listenerImpl, password);
 
 	if (error == WPS_ENCRYPTION_ERROR)
 		fprintf(stderr, "ERROR: Encrypted file, bad Password!\n");
@@ -53,6 +53,7 @@ static int printUsage()
 	printf("\t\t MacIceland, MacInuit, MacRoman, MacRomanian, MacThai, MacTurkish.\n");
 	printf("\t-h:                Shows this help message\n");
 	printf("\t-p password:       Password to open the file\n");
+	printf("\t-t:                Only extracts the characters (faster, ignores the headers/footers)\n");
 	printf("\t-v:                Output wps2text version \n");
 	return -1;
 }
@@ -69,8 +70,9 @@ int main(int argc, char *argv[])
 	int ch;
 	char const *encoding="";
 	char const *password=0;
+	bool textOnly=false;
 
-	while ((ch = getopt(argc, argv, "e:hp:v")) != -1)
+	while ((ch = getopt(argc, argv, "e:hp:tv")) != -1)
 	{
 		switch (ch)
 		{
@@ -80,6 +82,9 @@ int main(int argc, char *argv[])
 		case 'p':
 			password=optarg;
 			break;
+		case 't':
+			textOnly=true;
+			break;
 		case 'v':
 			printVersion();
 			return 0;
@@ -95,12 +100,12 @@ int main(int argc, char *argv[])
 		return -1;
 	}
 
-	librevenge::RVNGFileStream input(argv[optind]);
+	char const *file=argv[optind];
 
 	WPSCreator creator;
 	WPSKind kind;
 	bool needCharEncoding;
-	WPSConfidence confidence = WPSDocument::isFileFormatSupported(&input,kind,creator, needCharEncoding);
+	WPSConfidence confidence = WPSDocument::isFileFormatSupported(file,kind,creator, needCharEncoding);
 	if (confidence == WPS_CONFIDENCE_NONE || kind != WPS_TEXT)
 	{
 		printf("ERROR: Unsupported file format!\n");
@@ -108,8 +113,14 @@ int main(int argc, char *argv[])
 	}
 
 	librevenge::RVNGString document;
-	librevenge::RVNGTextTextGenerator listenerImpl(document);
-	WPSResult error = WPSDocument::parse(&input, &listenerImpl, password, encoding);
+	WPSResult error;
+	if (textOnly)
+		error = WPSDocument::parseText(file, document, password, encoding);
+	else
+	{
+		librevenge::RVNGTextTextGenerator listenerImpl(document);
+		error = WPSDocument::parse(file, &listenerImpl, password, encoding);
+	}
 
 	if (error == WPS_ENCRYPTION_ERROR)
 		fprintf(stderr, "ERROR: Encrypted file, bad Password!\n");
@@ -148,12 +148,11 @@ int main(int argc, char *argv[])
 		return -1;
 	}
 	char const *file=argv[optind];
-	librevenge::RVNGFileStream input(file);
 
 	WPSCreator creator;
 	WPSKind kind;
 	bool needCharEncoding;
-	WPSConfidence confidence = WPSDocument::isFileFormatSupported(&input,kind,creator,needCharEncoding);
+	WPSConfidence confidence = WPSDocument::isFileFormatSupported(file,kind,creator,needCharEncoding);
 	if (confidence == WPS_CONFIDENCE_NONE || (kind != WPS_SPREADSHEET && kind != WPS_DATABASE))
 	{
 		printf("ERROR: Unsupported file format!\n");
@@ -168,7 +167,11 @@ int main(int argc, char *argv[])
 		librevenge::RVNGCSVSpreadsheetGenerator listenerImpl(vec, generateFormula);
 		listenerImpl.setSeparators(fieldSeparator, textSeparator, decSeparator);
 		listenerImpl.setDTFormats(dateFormat.c_str(),timeFormat.c_str());
-		error= WPSDocument::parse(&input, &listenerImpl, password, encoding);
+		// only read and convert the needed sheet (excepted if we need to count the sheets)
+		WPSParseOptions options;
+		if (!printNumberOfSheet)
+			options.m_sheetId=sheetToConvert>0 ? sheetToConvert-1 : 0;
+		error= WPSDocument::parse(file, &listenerImpl, options, password, encoding);
 	}
 	catch (...)
 	{
@@ -185,12 +188,12 @@ int main(int argc, char *argv[])
 		fprintf(stderr, "ERROR: File is an OLE document, but does not contain a Works stream!\n");
 	else if (error != WPS_OK)
 		fprintf(stderr, "ERROR: Unknown Error!\n");
-	else if (vec.empty())
+	else if (vec.empty() && (printNumberOfSheet || sheetToConvert<=0))
 	{
 		fprintf(stderr, "ERROR: bad output!\n");
 		error = WPS_PARSE_ERROR;
 	}
-	else if (sheetToConvert>0 && sheetToConvert>(int) vec.size())
+	else if (vec.empty())
 	{
 		fprintf(stderr, "ERROR: Can not find sheet %d\n", sheetToConvert);
 		error = WPS_PARSE_ERROR;
@@ -203,11 +206,11 @@ int main(int argc, char *argv[])
 		return 0;
 	}
 	if (!output)
-		std::cout << vec[sheetToConvert>0 ? unsigned(sheetToConvert-1) : 0].cstr() << std::endl;
+		std::cout << vec[0].cstr() << std::endl;
 	else
 	{
 		std::ofstream out(output);
-		out << vec[sheetToConvert>0 ? unsigned(sheetToConvert-1) : 0].cstr() << std::endl;
+		out << vec[0].cstr() << std::endl;
 	}
 	return 0;
 }
@@ -104,12 +104,11 @@ int main(int argc, char *argv[])
 		return -1;
 	}
 	char const *file=argv[optind];
-	librevenge::RVNGFileStream input(file);
 
 	WPSCreator creator;
 	WPSKind kind;
 	bool needCharEncoding;
-	WPSConfidence confidence = WPSDocument::isFileFormatSupported(&input,kind,creator,needCharEncoding);
+	WPSConfidence confidence = WPSDocument::isFileFormatSupported(file,kind,creator,needCharEncoding);
 	if (confidence == WPS_CONFIDENCE_NONE || (kind != WPS_SPREADSHEET && kind != WPS_DATABASE))
 	{
 		printf("ERROR: Unsupported file format!\n");
@@ -121,7 +120,7 @@ int main(int argc, char *argv[])
 	try
 	{
 		librevenge::RVNGTextSpreadsheetGenerator listenerImpl(vec);
-		error= WPSDocument::parse(&input, &listenerImpl, password, encoding);
+		error= WPSDocument::parse(file, &listenerImpl, password, encoding);
 	}
 	catch (...)
 	{
@@ -105,7 +105,7 @@ enum HeaderOffset
 
 DosWordParser::DosWordParser(RVNGInputStreamPtr &input, WPSHeaderPtr &header,
                              libwps_tools_win::Font::Type encoding):
-	MSWriteParser(input, header, encoding)
+	MSWriteParser(input, header, encoding), m_headerChecked(false)
 {
 }
 
@@ -119,7 +119,7 @@ void DosWordParser::readFFNTB()
 }
 
 // basic function to check if the header is ok
-bool DosWordParser::checkHeader(WPSHeader *header, bool /*strict*/)
+bool DosWordParser::checkHeader(WPSHeader *header, bool strict)
 {
 	RVNGInputStreamPtr input = getInput();
 	if (!input || !checkFilePosition(0x100))
@@ -171,9 +171,19 @@ bool DosWordParser::checkHeader(WPSHeader *header, bool /*strict*/)
 	if (!codepage)
 		header->setNeedEncoding(true);
 
+	if (strict)
+		m_headerChecked=true;
 	return true;
 }
 
+void DosWordParser::parse(librevenge::RVNGTextInterface *documentInterface)
+{
+	// the header may have already been checked by WPSDocument
+	if (!m_headerChecked && !checkHeader(getHeader().get(), true))
+		throw (libwps::ParseException());
+	MSWriteParser::parse(documentInterface);
+}
+
 libwps_tools_win::Font::Type DosWordParser::getFileEncoding(libwps_tools_win::Font::Type encoding)
 {
 	RVNGInputStreamPtr input = getInput();
@@ -215,7 +225,7 @@ WPSColor DosWordParser::color(int clr)
 	}
 }
 
-void DosWordParser::readCHP(uint32_t fcFirst, uint32_t fcLim, unsigned cch)
+unsigned DosWordParser::readCHP(unsigned cch)
 {
 	RVNGInputStreamPtr input = getInput();
 
@@ -252,7 +262,7 @@ void DosWordParser::readCHP(uint32_t fcFirst, uint32_t fcLim, unsigned cch)
 			font.m_annotation = true;
 			break;
 		default:
-			WPS_DEBUG_MSG(("Style sheet stc=%u %x-%x\n", chp.m_fStyled / 2, fcFirst, fcLim));
+			WPS_DEBUG_MSG(("Style sheet stc=%u\n", chp.m_fStyled / 2));
 			break;
 		}
 	}
@@ -301,8 +311,6 @@ void DosWordParser::readCHP(uint32_t fcFirst, uint32_t fcLim, unsigned cch)
 			font.m_attributes |= WPS_SUPERSCRIPT_BIT;
 	}
 
-	font.m_fcFirst = fcFirst;
-	font.m_fcLim = fcLim;
 	font.m_encoding = libwps_tools_win::Font::getFontType(font.m_name);
 	if (font.m_encoding == libwps_tools_win::Font::UNKNOWN)
 		font.m_encoding = m_fontType;
@@ -310,9 +318,10 @@ void DosWordParser::readCHP(uint32_t fcFirst, uint32_t fcLim, unsigned cch)
 	font.m_color = color(chp.m_clr & 7);
 
 	m_fontList.push_back(font);
+	return unsigned(m_fontList.size()-1);
 }
 
-void DosWordParser::readPAP(uint32_t fcFirst, uint32_t fcLim, unsigned cch)
+unsigned DosWordParser::readPAP(unsigned cch)
 {
 	RVNGInputStreamPtr input = getInput();
 
@@ -409,9 +418,6 @@ void DosWordParser::readPAP(uint32_t fcFirst, uint32_t fcLim, unsigned cch)
 	para.m_spacings[1] = dyaBefore / 240.0;
 	para.m_spacings[2] = dyaAfter / 240.0;
 
-	para.m_fcFirst = fcFirst;
-	para.m_fcLim = fcLim;
-
 	if (pap.m_rhc & 0xe)
 	{
 		if (pap.m_rhc & 1)
@@ -451,7 +457,7 @@ void DosWordParser::readPAP(uint32_t fcFirst, uint32_t fcLim, unsigned cch)
 			para.m_Location = MSWriteParserInternal::Paragraph::FOOTNOTE;
 			break;
 		default:
-			WPS_DEBUG_MSG(("DosWordParser::readPAP pap unknown style stc=%u %x-%x\n", pap.m_style / 2, fcFirst, fcLim));
+			WPS_DEBUG_MSG(("DosWordParser::readPAP pap unknown style stc=%u\n", pap.m_style / 2));
 			break;
 		}
 	}
@@ -516,6 +522,7 @@ void DosWordParser::readPAP(uint32_t fcFirst, uint32_t fcLim, unsigned cch)
 	// FIXME: paragraph position
 
 	m_paragraphList.push_back(para);
+	return unsigned(m_paragraphList.size()-1);
 }
 
 void DosWordParser::insertSpecial(uint8_t val, uint32_t fc, MSWriteParserInternal::Paragraph::Location location)
@@ -45,6 +45,8 @@ public:
 
 	//! checks if the document header is correct (or not)
 	bool checkHeader(WPSHeader *header, bool strict=false);
+	//! checks the header if this is not already done, then parses the document
+	void parse(librevenge::RVNGTextInterface *documentInterface);
 
 private:
 	DosWordParser(const DosWordParser &);
@@ -54,12 +56,15 @@ private:
 	WPSColor color(int clr);
 
 	virtual void readFFNTB();
-	virtual void readCHP(uint32_t fcFirst, uint32_t fcLim, unsigned cch);
-	virtual void readPAP(uint32_t fcFirst, uint32_t fcLim, unsigned cch);
+	virtual unsigned readCHP(unsigned cch);
+	virtual unsigned readPAP(unsigned cch);
 	virtual void insertSpecial(uint8_t val, uint32_t fc, MSWriteParserInternal::Paragraph::Location location);
 	virtual void insertControl(uint8_t val);
 	virtual void readSUMD();
 	virtual void readFNTB();
+
+	//! a flag to know if the header has already been checked by checkHeader(header, true)
+	bool m_headerChecked;
 };
 
 #endif /* DOSWORD_H */
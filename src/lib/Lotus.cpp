@@ -162,12 +162,25 @@ struct State
 	std::string m_footerString;
 };
 
+//! returns true if a record is not needed to create the output: the chart zones
+static bool canSkipRecord(WKSRecord const &record)
+{
+	if (record.m_type!=0)
+		return false;
+#ifdef DEBUG
+	// in debug mode, all the records are read to check their content
+	return false;
+#else
+	return record.m_id==0x11 || record.m_id==0x12;
+#endif
+}
+
 }
 
 // constructor, destructor
 LotusParser::LotusParser(RVNGInputStreamPtr &input, WPSHeaderPtr &header,
                          libwps_tools_win::Font::Type encoding) :
-	WKSParser(input, header), m_listener(), m_state(), m_styleManager(), m_graphParser(), m_spreadsheetParser()
+	WKSParser(input, header), m_listener(), m_headerChecked(false), m_state(), m_styleManager(), m_graphParser(), m_spreadsheetParser()
 
 {
 	m_state.reset(new LotusParserInternal::State(encoding));
@@ -243,7 +256,8 @@ void LotusParser::parse(librevenge::RVNGSpreadsheetInterface *documentInterface)
 		throw (libwps::ParseException());
 	}
 
-	if (!checkHeader(0L, true)) throw(libwps::ParseException());
+	// the header may have already been checked by WPSDocument
+	if (!m_headerChecked && !checkHeader(0L, true)) throw(libwps::ParseException());
 
 	bool ok=false;
 	try
@@ -262,8 +276,15 @@ void LotusParser::parse(librevenge::RVNGSpreadsheetInterface *documentInterface)
 			m_spreadsheetParser->setListener(m_listener);
 
 			m_listener->startDocument();
-			for (int i=0; i<=m_state->m_maxSheet; ++i)
-				m_spreadsheetParser->sendSpreadsheet(i);
+			if (isSelectedRangeUnknown())
+			{
+				WPS_DEBUG_MSG(("LotusParser::parse: can not find the selected range\n"));
+			}
+			else for (int i=0; i<=m_state->m_maxSheet; ++i)
+			{
+				if (isSheetSelected(i))
+					m_spreadsheetParser->sendSpreadsheet(i);
+			}
 			m_listener->endDocument();
 			m_listener.reset();
 			ok = true;
@@ -378,6 +399,8 @@ bool LotusParser::checkHeader(WPSHeader *header, bool strict)
 		header->setKind(libwps::WPS_SPREADSHEET);
 		header->setNeedEncoding(true);
 	}
+	if (strict)
+		m_headerChecked=true;
 	return true;
 }
 
@@ -390,6 +413,10 @@ bool LotusParser::readZones()
 	m_spreadsheetParser->cleanState();
 
 	input->seek(0, librevenge::RVNG_SEEK_SET);
+	// scan the record headers, then use the list to read or skip each record
+	std::vector<WKSRecord> records;
+	indexRecords(records, 0x2a);
+	size_t r=0;
 
 	bool mainDataRead=false;
 	// data, format and ?
@@ -398,7 +425,21 @@ bool LotusParser::readZones()
 		if (input->isEnd())
 			break;
 
-		while (readZone()) ;
+		for (; r<records.size(); ++r)
+		{
+			WKSRecord const &record=records[r];
+			if (record.m_pos!=input->tell())
+			{
+				if (record.m_pos<input->tell()) continue;
+				break;
+			}
+			if (LotusParserInternal::canSkipRecord(record))
+			{
+				input->seek(record.end(), librevenge::RVNG_SEEK_SET);
+				continue;
+			}
+			if (!readZone()) break;
+		}
 
 		//
 		// look for ending
@@ -453,11 +494,12 @@ bool LotusParser::readZone()
 	libwps::DebugStream f;
 	RVNGInputStreamPtr input = getInput();
 	long pos = input->tell();
-	int id = (int) libwps::readU8(input);
-	int type = (int) libwps::readU8(input);
-	long sz = (long) libwps::readU16(input);
+	libwps::BufferedReader header(input, 4);
+	int id = (int) header.readU8();
+	int type = (int) header.readU8();
+	long sz = (long) header.readU16();
 	long endPos=pos+4+sz;
-	if ((type>0x2a) || sz<0 || !checkFilePosition(endPos))
+	if (!header.isOk() || (type>0x2a) || sz<0 || !checkFilePosition(endPos))
 	{
 		input->seek(pos, librevenge::RVNG_SEEK_SET);
 		return false;
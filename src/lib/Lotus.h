@@ -123,6 +123,8 @@ protected:
 
 
 	shared_ptr<WKSContentListener> m_listener; /** the listener (if set)*/
+	//! a flag to know if the header has already been checked by checkHeader(header, true)
+	bool m_headerChecked;
 	//! the internal state
 	shared_ptr<LotusParserInternal::State> m_state;
 	//! the style manager
@@ -35,6 +35,7 @@
 #include "libwps_tools_win.h"
 
 #include "WPSCell.h"
+#include "WKSCellStore.h"
 #include "WKSContentListener.h"
 #include "WPSEntry.h"
 #include "WPSFont.h"
@@ -75,21 +76,98 @@ struct Style : public WPSCellFormat
 	{
 		return !(*this==st);
 	}
+	//! a comparison function: returns -1, 0 or 1
+	int cmp(Style const &st) const
+	{
+		if (m_fontType!=st.m_fontType) return m_fontType<st.m_fontType ? -1 : 1;
+		int diff=WPSCellFormat::compare(st);
+		if (diff) return diff<0 ? -1 : 1;
+		return getFont().cmp(st.getFont());
+	}
+	//! a comparaison structure used to store the styles in a map
+	struct Compare
+	{
+		//! comparaison function
+		bool operator()(Style const &st1, Style const &st2) const
+		{
+			return st1.cmp(st2) < 0;
+		}
+	};
 	//! font encoding type
 	libwps_tools_win::Font::Type m_fontType;
 	/** extra data */
 	std::string m_extra;
 };
 
+///////////////////////////////////////////////////////////////////
+/** the table of the styles used by the cells: each different cell
+	style is stored only once and the rows only keep its index */
+class CellStyleManager
+{
+public:
+	//! constructor
+	CellStyleManager() : m_styleIdMap(), m_stylesList(), m_defaultStyleId(-1), m_alignedStyleIdMap() {}
+	//! adds a style if needed and returns its id
+	int add(Style const &st)
+	{
+		std::map<Style,int,Style::Compare>::const_iterator it=m_styleIdMap.find(st);
+		if (it!=m_styleIdMap.end())
+			return it->second;
+		int id=int(m_stylesList.size());
+		m_stylesList.push_back(st);
+		m_styleIdMap.insert(std::map<Style,int,Style::Compare>::value_type(st,id));
+		return id;
+	}
+	//! returns the style with id or 0
+	Style const *get(int id) const
+	{
+		if (id<0 || id>=int(m_stylesList.size()))
+			return 0;
+		return &m_stylesList[size_t(id)];
+	}
+	//! returns the id of a default style, creates it if needed
+	int getDefaultStyleId(libwps_tools_win::Font::Type type)
+	{
+		if (m_defaultStyleId<0)
+			m_defaultStyleId=add(Style(type));
+		return m_defaultStyleId;
+	}
+	//! returns the id of the style id with a different horizontal alignment, creates it if needed
+	int getAlignedStyleId(int id, WPSCellFormat::HorizontalAlignment align)
+	{
+		if (id<0 || id>=int(m_stylesList.size()) || m_stylesList[size_t(id)].hAlignement()==align)
+			return id;
+		std::pair<int,int> key(id,int(align));
+		std::map<std::pair<int,int>,int>::const_iterator it=m_alignedStyleIdMap.find(key);
+		if (it!=m_alignedStyleIdMap.end())
+			return it->second;
+		Style style(m_stylesList[size_t(id)]);
+		style.setHAlignement(align);
+		int newId=add(style);
+		m_alignedStyleIdMap[key]=newId;
+		return newId;
+	}
+
+protected:
+	//! a map style to id
+	std::map<Style,int,Style::Compare> m_styleIdMap;
+	//! the list of styles
+	std::vector<Style> m_stylesList;
+	//! the default style id (or -1)
+	int m_defaultStyleId;
+	//! a map (style id, alignment) -> the style id with this alignment
+	std::map<std::pair<int,int>,int> m_alignedStyleIdMap;
+};
+
 //! a class used to store the styles of a row in LotusSpreadsheet
 struct RowStyles
 {
 	//! constructor
-	RowStyles() : m_colsToStyleMap()
+	RowStyles() : m_colsToStyleIdMap()
 	{
 	}
-	//! a map Vec2i(minCol,maxCol) to style
-	std::map<Vec2i, Style> m_colsToStyleMap;
+	//! a map Vec2i(minCol,maxCol) to style id
+	std::map<Vec2i, int> m_colsToStyleIdMap;
 };
 
 //! a list of position of a Lotus spreadsheet
@@ -113,30 +191,37 @@ struct CellsList
 	Box2i m_positions;
 };
 
-//! a cellule of a Lotus spreadsheet
-class Cell : public WPSCell
+/** a cellule of a Lotus spreadsheet
+
+	\note the cell format is not stored in the cell, but in the row styles */
+class Cell
 {
 public:
 	/// constructor
-	Cell() : m_styleId(-1), m_hAlign(WPSCellFormat::HALIGN_DEFAULT), m_content(), m_comment() { }
+	Cell() : m_position(0,0), m_styleId(-1), m_hAlign(WPSCellFormat::HALIGN_DEFAULT), m_content(), m_comment() { }
 
 	//! operator<<
 	friend std::ostream &operator<<(std::ostream &o, Cell const &cell);
 
-	//! call when a cell must be send
-	bool send(WPSListenerPtr &/*listener*/)
+	//! returns the cell position
+	Vec2i const &position() const
 	{
-		WPS_DEBUG_MSG(("LotusSpreadsheetInternal::Cell::send: must not be called\n"));
-		return false;
+		return m_position;
 	}
-
-	//! call when the content of a cell must be send
-	bool sendContent(WPSListenerPtr &/*listener*/)
+	//! sets the cell position
+	void setPosition(Vec2i const &pos)
 	{
-		WPS_DEBUG_MSG(("LotusSpreadsheetInternal::Cell::sendContent: must not be called\n"));
-		return false;
+		m_position=pos;
+	}
+	//! returns true if the two cells have no comment, the same alignment and the same constant content
+	bool isRepeatedWith(Cell const &cell) const
+	{
+		return !m_comment.valid() && !cell.m_comment.valid() && m_hAlign==cell.m_hAlign &&
+		       m_content.isSameConstant(cell.m_content);
 	}
 
+	//! the cell position
+	Vec2i m_position;
 	//! the style
 	int m_styleId;
 	//! the horizontal align (in dos file)
@@ -150,7 +235,7 @@ public:
 //! operator<<
 std::ostream &operator<<(std::ostream &o, Cell const &cell)
 {
-	o << reinterpret_cast<WPSCell const &>(cell) << cell.m_content << ",";
+	o << "C" << cell.m_position << ":" << cell.m_content << ",";
 	if (cell.m_styleId>=0) o << "style=" << cell.m_styleId << ",";
 	switch (cell.m_hAlign)
 	{
@@ -180,18 +265,16 @@ class Spreadsheet
 public:
 	//! a constructor
 	Spreadsheet() : m_name(""), m_numCols(0), m_numRows(0), m_boundsColsMap(),
-		m_widthColsInChar(), m_rowHeightMap(), m_heightDefault(16),
-		m_rowPageBreaksList(), m_positionToCellMap(), m_rowToStyleIdMap() {}
+		m_widthColsInChar(), m_rowHeights(), m_heightDefault(16),
+		m_rowPageBreaksList(), m_cells(), m_rowStyleIds() {}
 	//! return a cell corresponding to a spreadsheet, create one if needed
 	Cell &getCell(Vec2i const &pos)
 	{
-		if (m_positionToCellMap.find(pos)==m_positionToCellMap.end())
-		{
-			Cell cell;
+		bool isNew;
+		Cell &cell=m_cells.insert(pos, isNew);
+		if (isNew)
 			cell.setPosition(pos);
-			m_positionToCellMap[pos]=cell;
-		}
-		return m_positionToCellMap.find(pos)->second;
+		return cell;
 	}
 	//! set the columns size
 	void setColumnWidthInChar(int col, int w=-1)
@@ -214,54 +297,21 @@ public:
 	//! returns the row size in point
 	float getRowHeight(int row) const
 	{
-		std::map<Vec2i,int>::const_iterator rIt=m_rowHeightMap.lower_bound(Vec2i(-1,row));
-		if (rIt!=m_rowHeightMap.end() && rIt->first[0]<=row && rIt->first[1]>=row)
-			return (float) rIt->second;
-		return (float) m_heightDefault;
+		int const *height=m_rowHeights.find(row);
+		return float(height ? *height : m_heightDefault);
 	}
 	//! set the rows size
 	void setRowHeight(int row, int h)
 	{
 		if (h>=0)
-			m_rowHeightMap[Vec2i(row,row)]=h;
+			m_rowHeights.set(row, h);
 	}
 	//! try to compress the list of row height
 	void compressRowHeights()
 	{
-		std::map<Vec2i,int> oldMap=m_rowHeightMap;
-		m_rowHeightMap.clear();
-		std::map<Vec2i,int>::const_iterator rIt=oldMap.begin();
-		int actHeight=-1;
-		Vec2i actPos(0,-1);
-		while (rIt!=oldMap.end())
-		{
-			// first check for not filled row
-			if (rIt->first[0]!=actPos[1]+1)
-			{
-				if (actHeight==m_heightDefault)
-					actPos[1]=rIt->first[0]-1;
-				else
-				{
-					if (actPos[1]>=actPos[0])
-						m_rowHeightMap[actPos]=actHeight;
-					actHeight=m_heightDefault;
-					actPos=Vec2i(actPos[1]+1, rIt->first[0]-1);
-				}
-			}
-			if (rIt->second!=actHeight)
-			{
-				if (actPos[1]>=actPos[0])
-					m_rowHeightMap[actPos]=actHeight;
-				actPos[0]=rIt->first[0];
-				actHeight=rIt->second;
-			}
-			actPos[1]=rIt->first[1];
-			++rIt;
-		}
-		if (actPos[1]>=actPos[0])
-			m_rowHeightMap[actPos]=actHeight;
+		m_rowHeights.compress(m_heightDefault);
 	}
-	//! convert the m_widthColsInChar, m_rowHeightMap in a vector of of point size
+	//! convert the m_widthColsInChar in a vector of of point size
 	static std::vector<float> convertInPoint(std::vector<int> const &list,
 	                                         float defSize, float factor=1)
 	{
@@ -278,16 +328,14 @@ public:
 	//! returns the row style id corresponding to a sheetId (or -1)
 	int getRowStyleId(int row) const
 	{
-		std::map<Vec2i,size_t>::const_iterator it=m_rowToStyleIdMap.lower_bound(Vec2i(-1, row));
-		if (it!=m_rowToStyleIdMap.end() && it->first[0]<=row && row<=it->first[1])
-			return int(it->second);
-		return -1;
+		size_t const *styleId=m_rowStyleIds.find(row);
+		return styleId ? int(*styleId) : -1;
 	}
 
 	//! returns true if the spreedsheet is empty
 	bool empty() const
 	{
-		return m_positionToCellMap.empty() && m_rowToStyleIdMap.empty() && m_name.empty();
+		return m_cells.empty() && m_rowStyleIds.empty() && m_name.empty();
 	}
 	/** the sheet name */
 	librevenge::RVNGString m_name;
@@ -299,24 +347,24 @@ public:
 	std::map<int, Vec2i> m_boundsColsMap;
 	/** the column size in char */
 	std::vector<int> m_widthColsInChar;
-	/** the map Vec2i(min row, max row) to size in points */
-	std::map<Vec2i,int> m_rowHeightMap;
+	/** the row size in points */
+	WKSRowRuns<int> m_rowHeights;
 	/** the default row size in point */
 	int m_heightDefault;
 	/** the list of row page break */
 	std::vector<int> m_rowPageBreaksList;
-	/** a map cell to not empty cells */
-	std::map<Vec2i, Cell> m_positionToCellMap;
-	//! map Vec2i(min row, max row) to state row style id
-	std::map<Vec2i,size_t> m_rowToStyleIdMap;
+	/** the not empty cells */
+	WKSCellStore<Cell> m_cells;
+	//! the rows' state row style id
+	WKSRowRuns<size_t> m_rowStyleIds;
 };
 
 //! the state of LotusSpreadsheet
 struct State
 {
 	//! constructor
-	State() :  m_eof(-1), m_version(-1), m_spreadsheetList(), m_nameToCellsMap(),
-		m_rowStylesList(), m_rowSheetIdToStyleIdMap(), m_rowSheetIdToChildRowIdMap()
+	State() :  m_eof(-1), m_version(-1), m_spreadsheetList(), m_badSpreadsheet(), m_nameToCellsMap(),
+		m_cellStyleManager(), m_rowStylesList(), m_sheetIdToRowStyleIdsMap(), m_rowSheetIdToChildRowIdMap()
 	{
 		m_spreadsheetList.resize(1);
 	}
@@ -331,8 +379,8 @@ struct State
 		if (id<0||id>=int(m_spreadsheetList.size()))
 		{
 			WPS_DEBUG_MSG(("LotusSpreadsheetInternal::State::getSheet: can find spreadsheet %d\n", id));
-			static Spreadsheet empty;
-			return empty;
+			m_badSpreadsheet=Spreadsheet();
+			return m_badSpreadsheet;
 		}
 		return m_spreadsheetList[size_t(id)];
 	}
@@ -351,12 +399,16 @@ struct State
 	int m_version;
 	//! the list of spreadsheet ( first: main spreadsheet, other report spreadsheet )
 	std::vector<Spreadsheet> m_spreadsheetList;
+	//! a spreadsheet returned by getSheet when the sheet id is bad
+	Spreadsheet m_badSpreadsheet;
 	//! map name to position
 	std::map<std::string, CellsList> m_nameToCellsMap;
+	//! the cell style manager
+	CellStyleManager m_cellStyleManager;
 	//! the list of row styles
 	std::vector<RowStyles> m_rowStylesList;
-	//! map Vec2i(row, sheetId) to row style id
-	std::map<Vec2i,size_t> m_rowSheetIdToStyleIdMap;
+	//! map sheetId to the rows' style id
+	std::map<int, WKSRowRuns<size_t> > m_sheetIdToRowStyleIdsMap;
 	//! map Vec2i(row, sheetId) to child style
 	std::multimap<Vec2i,Vec2i> m_rowSheetIdToChildRowIdMap;
 };
@@ -382,14 +434,21 @@ void LotusSpreadsheet::cleanState()
 
 void LotusSpreadsheet::updateState()
 {
+	std::map<int, WKSRowRuns<size_t> > &rowStyleIdsMap=m_state->m_sheetIdToRowStyleIdsMap;
 	// update the state correspondance between row and row's styles
 	if (!m_state->m_rowSheetIdToChildRowIdMap.empty())
 	{
 		std::set<Vec2i> seens;
 		std::stack<Vec2i> toDo;
-		for (std::map<Vec2i,size_t>::const_iterator it=m_state->m_rowSheetIdToStyleIdMap.begin();
-		        it!=m_state->m_rowSheetIdToStyleIdMap.end(); ++it)
-			toDo.push(it->first);
+		for (std::multimap<Vec2i,Vec2i>::const_iterator it=m_state->m_rowSheetIdToChildRowIdMap.begin();
+		        it!=m_state->m_rowSheetIdToChildRowIdMap.end(); ++it)
+		{
+			if (!toDo.empty() && toDo.top()==it->first)
+				continue;
+			if (rowStyleIdsMap.find(it->first[1])!=rowStyleIdsMap.end() &&
+			        rowStyleIdsMap.find(it->first[1])->second.find(it->first[0]))
+				toDo.push(it->first);
+		}
 		while (!toDo.empty())
 		{
 			Vec2i pos=toDo.top();
@@ -403,50 +462,32 @@ void LotusSpreadsheet::updateState()
 			std::multimap<Vec2i,Vec2i>::const_iterator cIt=m_state->m_rowSheetIdToChildRowIdMap.lower_bound(pos);
 			if (cIt==m_state->m_rowSheetIdToChildRowIdMap.end() || cIt->first!=pos)
 				continue;
-			if (m_state->m_rowSheetIdToStyleIdMap.find(pos)==m_state->m_rowSheetIdToStyleIdMap.end())
+			size_t const *styleId=rowStyleIdsMap[pos[1]].find(pos[0]);
+			if (!styleId)
 			{
 				WPS_DEBUG_MSG(("LotusSpreadsheet::updateState: something is bad\n"));
 				continue;
 			}
-			size_t finalPos=m_state->m_rowSheetIdToStyleIdMap.find(pos)->second;
+			size_t finalPos=*styleId;
 			while (cIt!=m_state->m_rowSheetIdToChildRowIdMap.end() && cIt->first==pos)
 			{
 				Vec2i const &cPos=cIt++->second;
-				m_state->m_rowSheetIdToStyleIdMap[cPos]=finalPos;
+				rowStyleIdsMap[cPos[1]].set(cPos[0], finalPos);
 				toDo.push(cPos);
 			}
 		}
 	}
 
 	// time to update each sheet rows style map
-	for (std::map<Vec2i,size_t>::const_iterator it=m_state->m_rowSheetIdToStyleIdMap.begin();
-	        it!=m_state->m_rowSheetIdToStyleIdMap.end();)
+	for (std::map<int, WKSRowRuns<size_t> >::iterator it=rowStyleIdsMap.begin(); it!=rowStyleIdsMap.end(); ++it)
 	{
-		int sheetId=it->first[1];
-		LotusSpreadsheetInternal::Spreadsheet *sheet=0;
-		if (sheetId>=0 && sheetId<(int) m_state->m_spreadsheetList.size())
-			sheet=&m_state->m_spreadsheetList[size_t(sheetId)];
-		else
+		int sheetId=it->first;
+		if (sheetId<0 || sheetId>=(int) m_state->m_spreadsheetList.size())
 		{
 			WPS_DEBUG_MSG(("LotusSpreadsheet::updateState: can not find sheet %d\n", sheetId));
+			continue;
 		}
-		int lastStyleId=-1;
-		Vec2i rows(0,-1);
-		while (it!=m_state->m_rowSheetIdToStyleIdMap.end() && it->first[1]==sheetId)
-		{
-			if (lastStyleId!=(int) it->second || it->first[0]!=rows[1]+1)
-			{
-				if (lastStyleId>=0 && sheet)
-					sheet->m_rowToStyleIdMap[rows]=(size_t) lastStyleId;
-				lastStyleId=(int)it->second;
-				rows=Vec2i(it->first[0], it->first[0]);
-			}
-			else
-				++rows[1];
-			++it;
-		}
-		if (lastStyleId>=0 && sheet)
-			sheet->m_rowToStyleIdMap[rows]=(size_t) lastStyleId;
+		m_state->m_spreadsheetList[size_t(sheetId)].m_rowStyleIds=it->second;
 	}
 }
 
@@ -675,9 +716,9 @@ bool LotusSpreadsheet::readRowFormats()
 				break;
 			}
 			if (numCell>=1)
-				stylesList.m_colsToStyleMap.insert
-				(std::map<Vec2i,LotusSpreadsheetInternal::Style>::value_type
-				 (Vec2i(actCell,actCell+numCell-1),style));
+				stylesList.m_colsToStyleIdMap.insert
+				(std::map<Vec2i,int>::value_type
+				 (Vec2i(actCell,actCell+numCell-1),m_state->m_cellStyleManager.add(style)));
 			f << "[" << style << "]";
 			if (numCell>1)
 				f << "x" << numCell;
@@ -685,7 +726,7 @@ bool LotusSpreadsheet::readRowFormats()
 			actCell+=numCell;
 		}
 		f << "],";
-		m_state->m_rowSheetIdToStyleIdMap[Vec2i(row,sheetId)]=rowStyleId;
+		m_state->m_sheetIdToRowStyleIdsMap[sheetId].set(row, rowStyleId);
 		if (actCell>256)
 		{
 			f << "###";
@@ -1105,7 +1146,10 @@ bool LotusSpreadsheet::readCellName()
 		f << "##name=" << name << ",";
 	}
 	else
+	{
 		m_state->m_nameToCellsMap[name]=cells;
+		m_mainParser.checkSelectedRange(name, cells.m_id, cells.m_positions);
+	}
 	std::string note("");
 	int remain=int(endPos-m_input->tell());
 	for (int i=0; i<remain; ++i)
@@ -1169,6 +1213,14 @@ bool LotusSpreadsheet::readCell()
 	int sheetId=(int) libwps::readU8(m_input);
 	int col=(int) libwps::readU8(m_input);
 	if (sheetId) f << "sheet[id]=" << sheetId << ",";
+	if (!m_mainParser.isCellSelected(sheetId, Vec2i(col, row)))
+	{
+		f.str("");
+		f << "Entries(" << what << "):sheet[id]=" << sheetId << ",skipped,";
+		ascii().addPos(pos);
+		ascii().addNote(f.str().c_str());
+		return true;
+	}
 
 	LotusSpreadsheetInternal::Spreadsheet empty, *sheet=0;
 	if (sheetId<0||sheetId>=int(m_state->m_spreadsheetList.size()))
@@ -1305,12 +1357,14 @@ bool LotusSpreadsheet::readCell()
 		if (error.length()) f << error;
 		if (m_input->tell()+1>=endPos)
 			break;
+#ifdef DEBUG
 		static bool first=true;
 		if (first)
 		{
 			first=false;
 			WPS_DEBUG_MSG(("LotusSpreadsheet::readCell: find err message for double10+formula\n"));
 		}
+#endif
 		// find in one file "Formula failed to convert"
 		error="";
 		int remain=int(endPos-m_input->tell());
@@ -1440,22 +1494,22 @@ void LotusSpreadsheet::sendSpreadsheet(int sheetId)
 	   excepted the last position */
 	std::set<int> newRowSet;
 	newRowSet.insert(0);
-	std::map<Vec2i, LotusSpreadsheetInternal::Cell>::const_iterator cIt;
-	int prevRow=-1;
-	for (cIt=sheet.m_positionToCellMap.begin(); cIt!=sheet.m_positionToCellMap.end(); ++cIt)
+	// the rows before the selected window are sent empty
+	int const minRow=m_mainParser.getParseOptions().m_minRow;
+	if (minRow>0)
+		newRowSet.insert(minRow);
+	std::vector<int> const &cellRows=sheet.m_cells.rows();
+	for (size_t r=0; r<cellRows.size(); ++r)
 	{
-		if (prevRow==cIt->first[1])
-			continue;
-		prevRow=cIt->first[1];
-		newRowSet.insert(prevRow);
-		newRowSet.insert(prevRow+1);
+		newRowSet.insert(cellRows[r]);
+		newRowSet.insert(cellRows[r]+1);
 	}
 	size_t numRowStyle=m_state->m_rowStylesList.size();
-	for (std::map<Vec2i,size_t>::const_iterator rIt=sheet.m_rowToStyleIdMap.begin();
-	        rIt!=sheet.m_rowToStyleIdMap.end(); ++rIt)
+	std::vector<WKSRowRuns<size_t>::Run> const &styleRuns=sheet.m_rowStyleIds.runs();
+	for (size_t r=0; r<styleRuns.size(); ++r)
 	{
-		Vec2i rows=rIt->first;
-		size_t listId=rIt->second;
+		Vec2i const &rows=styleRuns[r].m_rows;
+		size_t listId=styleRuns[r].m_value;
 		if (listId>=numRowStyle)
 		{
 			WPS_DEBUG_MSG(("LotusSpreadsheet::sendSpreadsheet: can not find list %d\n", int(listId)));
@@ -1464,10 +1518,10 @@ void LotusSpreadsheet::sendSpreadsheet(int sheetId)
 		newRowSet.insert(rows[0]);
 		newRowSet.insert(rows[1]+1);
 	}
-	for (std::map<Vec2i,int>::const_iterator rIt=sheet.m_rowHeightMap.begin();
-	        rIt!=sheet.m_rowHeightMap.end(); ++rIt)
+	std::vector<WKSRowRuns<int>::Run> const &heightRuns=sheet.m_rowHeights.runs();
+	for (size_t r=0; r<heightRuns.size(); ++r)
 	{
-		Vec2i rows=rIt->first;
+		Vec2i const &rows=heightRuns[r].m_rows;
 		newRowSet.insert(rows[0]);
 		newRowSet.insert(rows[1]+1);
 	}
@@ -1479,10 +1533,27 @@ void LotusSpreadsheet::sendSpreadsheet(int sheetId)
 			WPS_DEBUG_MSG(("LotusSpreadsheet::sendSpreadsheet: find a negative row %d\n", row));
 			continue;
 		}
-		if (sIt==newRowSet.end())
+		if (sIt==newRowSet.end() || m_mainParser.isAfterLastSelectedRow(row))
 			break;
-		m_listener->openSheetRow(sheet.getRowHeight(row), librevenge::RVNG_POINT, false, *sIt-row);
-		sendRowContent(sheet, row);
+		float const height=sheet.getRowHeight(row);
+		int numRows=*sIt-row;
+		WKSCellStore<LotusSpreadsheetInternal::Cell>::Iterator cIt=sheet.m_cells.lowerBoundRow(row);
+		if (numRows==1 && row>=minRow && cIt!=sheet.m_cells.end() && cIt.row()==row)
+		{
+			// look for the following rows which are identical to this row
+			int const maxRows=cIt.numRepeatedRows(), styleId=sheet.getRowStyleId(row);
+			while (numRows<maxRows && sheet.getRowStyleId(row+numRows)==styleId && !m_mainParser.isAfterLastSelectedRow(row+numRows))
+			{
+				float newHeight=sheet.getRowHeight(row+numRows);
+				if (newHeight<height || newHeight>height) break;
+				++numRows;
+			}
+			while (sIt!=newRowSet.end() && *sIt<row+numRows)
+				++sIt;
+		}
+		m_listener->openSheetRow(height, librevenge::RVNG_POINT, false, numRows);
+		if (row>=minRow)
+			sendRowContent(sheet, row);
 		m_listener->closeSheetRow();
 	}
 	m_listener->closeSheet();
@@ -1507,31 +1578,27 @@ void LotusSpreadsheet::sendRowContent(LotusSpreadsheetInternal::Spreadsheet cons
 	// we need to go through the row style list and the cell list in parallel
 	bool checkStyle=false;
 	int actStyleCol=0;
-	std::map<Vec2i, LotusSpreadsheetInternal::Style>::const_iterator sIt;
-	if (styles && !styles->m_colsToStyleMap.empty())
+	std::map<Vec2i, int>::const_iterator sIt;
+	if (styles && !styles->m_colsToStyleIdMap.empty())
 	{
 		checkStyle=true;
-		sIt=styles->m_colsToStyleMap.begin();
+		sIt=styles->m_colsToStyleIdMap.begin();
 		actStyleCol=sIt->first[0];
 	}
 
-	bool checkCell=false;
-	std::map<Vec2i, LotusSpreadsheetInternal::Cell>::const_iterator cIt;
-	if (!sheet.m_positionToCellMap.empty())
-	{
-		cIt=sheet.m_positionToCellMap.lower_bound(Vec2i(-1, row));
-		checkCell=cIt!=sheet.m_positionToCellMap.end() && cIt->first[1]==row;
-	}
+	WKSCellStore<LotusSpreadsheetInternal::Cell>::Iterator cIt=sheet.m_cells.lowerBoundRow(row);
+	WKSCellStore<LotusSpreadsheetInternal::Cell>::Iterator const cEnd=sheet.m_cells.end();
+	bool checkCell=cIt!=cEnd && cIt.row()==row;
 
-	LotusSpreadsheetInternal::Style defaultStyle(m_mainParser.getDefaultFontType());
+	int defaultStyleId=m_state->m_cellStyleManager.getDefaultStyleId(m_mainParser.getDefaultFontType());
 	LotusSpreadsheetInternal::Cell emptyCell;
 	while (checkStyle || checkCell)
 	{
-		int newCol=checkCell ? cIt->first[0] : -1;
+		int newCol=checkCell ? cIt.position()[0] : -1;
 		if (checkStyle && sIt->first[1] < actStyleCol)
 		{
 			++sIt;
-			checkStyle=sIt!=styles->m_colsToStyleMap.end();
+			checkStyle=sIt!=styles->m_colsToStyleIdMap.end();
 			actStyleCol=checkStyle ? sIt->first[0] : -1;
 		}
 
@@ -1546,79 +1613,117 @@ void LotusSpreadsheet::sendRowContent(LotusSpreadsheetInternal::Spreadsheet cons
 
 		if (!checkCell)
 			break;
+		int numCells;
 		if (checkStyle && newCol==actStyleCol)
 		{
-			sendCellContent(cIt->second, sIt->second);
-			++actStyleCol;
+			// the identical cells in this style's columns
+			numCells=cIt.numRepeatedCells(sIt->first[1]);
+			sendCellContent(*cIt, sIt->second, numCells);
+			actStyleCol+=numCells;
 		}
 		else
-			sendCellContent(cIt->second, defaultStyle);
-		++cIt;
-		checkCell=cIt!=sheet.m_positionToCellMap.end() && cIt->first[1]==row;
+		{
+			// the identical cells before the next style's columns
+			numCells=cIt.numRepeatedCells(checkStyle ? actStyleCol-1 : -1);
+			sendCellContent(*cIt, defaultStyleId, numCells);
+		}
+		for (int c=0; c<numCells; ++c) ++cIt;
+		checkCell=cIt!=cEnd && cIt.row()==row;
 	}
 }
 
-void LotusSpreadsheet::sendCellContent(LotusSpreadsheetInternal::Cell const &cell,
-                                       LotusSpreadsheetInternal::Style const &style,
-                                       int numRepeated)
+void LotusSpreadsheet::sendCellContent(LotusSpreadsheetInternal::Cell const &cell, int styleId, int numRepeated)
 {
 	if (m_listener.get() == 0L)
 	{
 		WPS_DEBUG_MSG(("LotusSpreadsheet::sendCellContent: I can not find the listener\n"));
 		return;
 	}
-
-	LotusSpreadsheetInternal::Style cellStyle(style);
-	if (cell.m_hAlign!=WPSCellFormat::HALIGN_DEFAULT)
-		cellStyle.setHAlignement(cell.m_hAlign);
-
-	libwps_tools_win::Font::Type fontType = cellStyle.m_fontType;
-
-	m_listener->setFont(cellStyle.getFont());
-
-	LotusSpreadsheetInternal::Cell finalCell(cell);
-	finalCell.WPSCellFormat::operator=(cellStyle);
-	WKSContentListener::CellContent content(cell.m_content);
-	for (size_t f=0; f < content.m_formula.size(); ++f)
+	LotusSpreadsheetInternal::CellStyleManager &styleManager=m_state->m_cellStyleManager;
+	if (!styleManager.get(styleId))
 	{
-		if (content.m_formula[f].m_type!=WKSContentListener::FormulaInstruction::F_Text)
+		WPS_DEBUG_MSG(("LotusSpreadsheet::sendCellContent: I can not find the cell style\n"));
+		styleId=styleManager.getDefaultStyleId(m_mainParser.getDefaultFontType());
+	}
+	if (cell.m_hAlign!=WPSCellFormat::HALIGN_DEFAULT)
+		styleId=styleManager.getAlignedStyleId(styleId, cell.m_hAlign);
+	LotusSpreadsheetInternal::Style const *cellStyle=styleManager.get(styleId);
+	if (!cellStyle) return;
+	LotusSpreadsheetInternal::Style const &style=*cellStyle;
+	// only send the columns which are in the selected window
+	libwps::WPSParseOptions const &options=m_mainParser.getParseOptions();
+	int minCol=cell.position()[0], maxCol=minCol+numRepeated-1;
+	if (minCol<options.m_minColumn) minCol=options.m_minColumn;
+	if (options.m_maxColumn>=0 && maxCol>options.m_maxColumn) maxCol=options.m_maxColumn;
+	if (minCol>maxCol) return;
+	numRepeated=maxCol-minCol+1;
+
+	libwps_tools_win::Font::Type fontType = style.m_fontType;
+
+	m_listener->setFont(style.getFont());
+
+	Vec2i const cellPos(minCol, cell.position()[1]);
+	bool hasTextFormula=false;
+	for (size_t f=0; f < cell.m_content.m_formula.size(); ++f)
+	{
+		if (cell.m_content.m_formula[f].m_type!=WKSContentListener::FormulaInstruction::F_Text)
 			continue;
-		std::string &text=content.m_formula[f].m_content;
-		librevenge::RVNGString finalString("");
-		for (size_t c=0; c < text.length(); ++c)
+		hasTextFormula=true;
+		break;
+	}
+	if (hasTextFormula)
+	{
+		WKSContentListener::CellContent content(cell.m_content);
+		for (size_t f=0; f < content.m_formula.size(); ++f)
 		{
-			libwps::appendUnicode
-			((uint32_t)libwps_tools_win::Font::unicode((unsigned char)text[c],fontType), finalString);
+			if (content.m_formula[f].m_type!=WKSContentListener::FormulaInstruction::F_Text)
+				continue;
+			std::string &text=content.m_formula[f].m_content;
+			librevenge::RVNGString finalString("");
+			libwps_tools_win::Font::appendUnicodeString
+			((unsigned char const *)text.c_str(), (unsigned long) text.length(), fontType, finalString);
+			text=finalString.cstr();
 		}
-		text=finalString.cstr();
+		m_listener->openSheetCell(style, styleId, cellPos, content, numRepeated);
 	}
-	m_listener->openSheetCell(finalCell, content, numRepeated);
+	else
+		m_listener->openSheetCell(style, styleId, cellPos, cell.m_content, numRepeated);
 
 	if (cell.m_content.m_textEntry.valid())
 	{
 		m_input->seek(cell.m_content.m_textEntry.begin(), librevenge::RVNG_SEEK_SET);
+		unsigned long numRead;
+		unsigned char const *text=m_input->read((unsigned long) cell.m_content.m_textEntry.length(), numRead);
 		bool prevEOL=false;
-		while (!m_input->isEnd() && m_input->tell()<cell.m_content.m_textEntry.end())
+		unsigned long c=0;
+		while (text && c<numRead)
 		{
-			unsigned char c=(unsigned char) libwps::readU8(m_input);
-			if (c==0xd)
+			if (text[c]==0xd)
 			{
 				m_listener->insertEOL();
 				prevEOL=true;
+				++c;
+				continue;
 			}
-			else if (c==0xa)
+			if (text[c]==0xa)
 			{
 				if (!prevEOL)
 				{
 					WPS_DEBUG_MSG(("LotusSpreadsheet::sendCellContent: find 0xa without 0xd\n"));
 				}
 				prevEOL=false;
+				++c;
+				continue;
 			}
-			else if (c)
-			{
-				m_listener->insertUnicode((uint32_t)libwps_tools_win::Font::unicode(c,fontType));
-				prevEOL=false;
-			}
+			// convert all the characters until the next end of line
+			unsigned long first=c;
+			while (c<numRead && text[c]!=0xd && text[c]!=0xa)
+				++c;
+			librevenge::RVNGString str;
+			libwps_tools_win::Font::appendUnicodeString(text+first, c-first, fontType, str, false, true);
+			if (!str.empty())
+				m_listener->insertUnicodeString(str);
+			prevEOL=false;
 		}
 	}
 	if (cell.m_comment.valid())
@@ -1650,19 +1755,21 @@ bool LotusSpreadsheet::readCell(int sId, bool isList, WKSContentListener::Formul
 		if (i==0)
 		{
 			if (sheetId!=sId)
-				instr.m_sheetName=m_state->getSheetName(sheetId);
+				instr.m_sheetName=m_state->getSheetName(sheetId).cstr();
 			if (!isList) break;
 			lastSheetId=sheetId;
 		}
 		else if (lastSheetId!=sheetId)
 		{
 			ascii().addDelimiter(m_input->tell()-2,'#');
+#ifdef DEBUG
 			static bool isFirst=true;
 			if (isFirst)
 			{
 				WPS_DEBUG_MSG(("LotusSpreadsheet::readCell: find some dubious sheet id\n"));
 				isFirst=false;
 			}
+#endif
 		}
 	}
 	return true;
@@ -1851,7 +1958,7 @@ bool LotusSpreadsheet::readFormula(long endPos, int sheetId, bool newFormula,
 			instr.m_position[1]=cells.m_positions[1];
 			instr.m_positionRelative[0]=instr.m_positionRelative[1]=Vec2b(wh==7,wh==7);
 			if (cells.m_id != sheetId)
-				instr.m_sheetName=m_state->getSheetName(cells.m_id);
+				instr.m_sheetName=m_state->getSheetName(cells.m_id).cstr();
 			instr.m_type=cells.m_positions[0]==cells.m_positions[1] ?
 			             WKSContentListener::FormulaInstruction::F_Cell :
 			             WKSContentListener::FormulaInstruction::F_CellList;
@@ -2045,12 +2152,14 @@ bool LotusSpreadsheet::readFormula(long endPos, int sheetId, bool newFormula,
 	else
 		error = "###stack problem";
 
+#ifdef DEBUG
 	static bool first = true;
 	if (first)
 	{
 		WPS_DEBUG_MSG(("LotusSpreadsheet::readFormula: I can not read some formula\n"));
 		first = false;
 	}
+#endif
 
 	f.str("");
 	for (size_t i = 0; i < stack.size(); ++i)
@@ -82,9 +82,8 @@ protected:
 
 	 \note this function does not call openSheetRow, closeSheetRow*/
 	void sendRowContent(LotusSpreadsheetInternal::Spreadsheet const &sheet, int row);
-	//! send the cell data
-	void sendCellContent(LotusSpreadsheetInternal::Cell const &cell,
-	                     LotusSpreadsheetInternal::Style const &style, int numRepeated=1);
+	//! send the cell data using the style with id styleId
+	void sendCellContent(LotusSpreadsheetInternal::Cell const &cell, int styleId, int numRepeated=1);
 
 	//////////////////////// report //////////////////////////////
 
@@ -797,12 +797,14 @@ bool LotusStyleManager::updateFontStyle(int fontId, WPSFont &font, libwps_tools_
 		return true;
 	if (m_state->m_idFontStyleMap.find(fontId)==m_state->m_idFontStyleMap.end())
 	{
+#ifdef DEBUG
 		static bool first=true;
 		if (first)
 		{
 			WPS_DEBUG_MSG(("LotusStyleManager::updateFontStyle: the font style %d does not exist\n", fontId));
 			first=false;
 		}
+#endif
 		return false;
 	}
 	LotusStyleManagerInternal::FontStyle const &fontStyle=m_state->m_idFontStyleMap.find(fontId)->second;
@@ -901,12 +903,14 @@ bool LotusStyleManager::readCellStyle(long endPos)
 	int val=(int) libwps::readU8(m_input); // always 50?
 	if (endPos-pos==33)   // wk6...wk9
 	{
+#ifdef DEBUG
 		static bool first=true;
 		if (first)
 		{
 			first=false;
 			WPS_DEBUG_MSG(("LotusStyleManager::readCellStyle: sorry, reading cell style is not implemented\n"));
 		}
+#endif
 		f << "Entries(CellStyle):Ce" << id << ",";
 		if (val!=0x50)
 			f << "fl=" << std::hex << val << std::dec << ",";
@@ -1003,12 +1007,14 @@ bool LotusStyleManager::updateCellStyle(int cellId, WPSCellFormat &format,
 		return true;
 	if (m_state->m_idCellStyleMap.find(cellId)==m_state->m_idCellStyleMap.end())
 	{
+#ifdef DEBUG
 		static bool first=true;
 		if (first)
 		{
 			WPS_DEBUG_MSG(("LotusStyleManager::updateCellStyle: the cell style %d does not exist\n", cellId));
 			first=false;
 		}
+#endif
 		return false;
 	}
 	LotusStyleManagerInternal::CellStyle const &cellStyle=m_state->m_idCellStyleMap.find(cellId)->second;
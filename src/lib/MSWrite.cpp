@@ -34,6 +34,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <map>
 
 namespace MSWriteParserInternal
 {
@@ -263,6 +264,15 @@ struct BitmapPalette
 	uint8_t m_r, m_g, m_b;
 };
 
+//! Internal: small functor used to find the run which contains a character position
+struct RunLimitCompare
+{
+	bool operator()(uint32_t fc, Run const &run) const
+	{
+		return fc < run.m_fcLim;
+	}
+};
+
 static void appendU16(librevenge::RVNGBinaryData &b, uint16_t val)
 {
 	b.append((unsigned char)(val));
@@ -282,7 +292,7 @@ static void appendU32(librevenge::RVNGBinaryData &b, uint32_t val)
 MSWriteParser::MSWriteParser(RVNGInputStreamPtr &input, WPSHeaderPtr &header,
                              libwps_tools_win::Font::Type encoding):
 	WPSParser(input, header), m_fileLength(0), m_fcMac(0),
-	m_paragraphList(0), m_fontList(0), m_footnotes(0), m_fonts(0),
+	m_paragraphList(0), m_paragraphRuns(0), m_fontList(0), m_fontRuns(0), m_footnotes(0), m_fonts(0),
 	m_pageSpan(), m_fontType(encoding), m_listener(), m_Main(), m_metaData()
 {
 	if (!input)
@@ -521,11 +531,11 @@ int MSWriteParser::numPages()
 
 	RVNGInputStreamPtr input = getInput();
 
-	std::vector<MSWriteParserInternal::Paragraph>::iterator paps;
+	std::vector<MSWriteParserInternal::Run>::const_iterator paps;
 
-	for (paps = m_paragraphList.begin(); paps != m_paragraphList.end(); ++paps)
+	for (paps = m_paragraphRuns.begin(); paps != m_paragraphRuns.end(); ++paps)
 	{
-		if (paps->m_graphics)
+		if (m_paragraphList[paps->m_propId].m_graphics)
 			continue;
 
 		uint32_t fc = paps->m_fcFirst;
@@ -541,10 +551,13 @@ int MSWriteParser::numPages()
 	return numPage;
 }
 
-void MSWriteParser::readFOD(unsigned page, void (MSWriteParser::*parseFOD)(uint32_t fcFirst, uint32_t fcLim, unsigned size))
+void MSWriteParser::readFOD(unsigned page, unsigned(MSWriteParser::*parseFOD)(unsigned size),
+                            std::vector<MSWriteParserInternal::Run> &runs)
 {
 	RVNGInputStreamPtr input = getInput();
 	unsigned fcLim, fc = 0x80;
+	// the properties already read, indexed by (page, bfProp); the default property is stored in (0, 0xffff)
+	std::map<std::pair<unsigned, unsigned>, unsigned> propIdMap;
 
 	for (;;)
 	{
@@ -585,7 +598,17 @@ void MSWriteParser::readFOD(unsigned page, void (MSWriteParser::*parseFOD)(uint3
 				}
 			}
 
-			(this->*parseFOD)(fc, fcLim, cch);
+			std::pair<unsigned, unsigned> key = cch ? std::make_pair(page, unsigned(bfProp)) : std::make_pair(0u, 0xffffu);
+			std::map<std::pair<unsigned, unsigned>, unsigned>::const_iterator it = propIdMap.find(key);
+			unsigned propId;
+			if (it != propIdMap.end())
+				propId = it->second;
+			else
+			{
+				propId = (this->*parseFOD)(cch);
+				propIdMap[key] = propId;
+			}
+			runs.push_back(MSWriteParserInternal::Run(fc, fcLim, propId));
 
 			if (fcLim >= m_fcMac)
 				return;
@@ -596,7 +619,7 @@ void MSWriteParser::readFOD(unsigned page, void (MSWriteParser::*parseFOD)(uint3
 	}
 }
 
-void MSWriteParser::readPAP(uint32_t fcFirst, uint32_t fcLim, unsigned cch)
+unsigned MSWriteParser::readPAP(unsigned cch)
 {
 	RVNGInputStreamPtr input = getInput();
 
@@ -667,8 +690,6 @@ void MSWriteParser::readPAP(uint32_t fcFirst, uint32_t fcLim, unsigned cch)
 	uint16_t dyaLine = WPS_LE_GET_GUINT16(&pap.m_dyaLine);
 	para.m_interLine = dyaLine / 240.0;
 
-	para.m_fcFirst = fcFirst;
-	para.m_fcLim = fcLim;
 	if (pap.m_rhcPage & 0x10)
 	{
 		para.m_graphics = true;
@@ -693,9 +714,10 @@ void MSWriteParser::readPAP(uint32_t fcFirst, uint32_t fcLim, unsigned cch)
 	}
 
 	m_paragraphList.push_back(para);
+	return unsigned(m_paragraphList.size()-1);
 }
 
-void MSWriteParser::readCHP(uint32_t fcFirst, uint32_t fcLim, unsigned cch)
+unsigned MSWriteParser::readCHP(unsigned cch)
 {
 	RVNGInputStreamPtr input = getInput();
 
@@ -742,13 +764,12 @@ void MSWriteParser::readCHP(uint32_t fcFirst, uint32_t fcLim, unsigned cch)
 			font.m_attributes |= WPS_SUPERSCRIPT_BIT;
 	}
 
-	font.m_fcFirst = fcFirst;
-	font.m_fcLim = fcLim;
 	font.m_encoding = libwps_tools_win::Font::getFontType(font.m_name);
 	if (font.m_encoding == libwps_tools_win::Font::UNKNOWN)
 		font.m_encoding = m_fontType;
 
 	m_fontList.push_back(font);
+	return unsigned(m_fontList.size()-1);
 }
 
 shared_ptr<WPSContentListener> MSWriteParser::createListener(librevenge::RVNGTextInterface *interface)
@@ -764,26 +785,27 @@ shared_ptr<WPSContentListener> MSWriteParser::createListener(librevenge::RVNGTex
 
 	unsigned first = 0, i;
 
-	for (i = 0; i < m_paragraphList.size(); i++)
+	for (i = 0; i < m_paragraphRuns.size(); i++)
 	{
-		MSWriteParserInternal::Paragraph &p = m_paragraphList[i];
+		MSWriteParserInternal::Paragraph const &p = m_paragraphList[m_paragraphRuns[i].m_propId];
 
 		if (p.m_Location != location)
 		{
+			MSWriteParserInternal::Paragraph const &firstP = m_paragraphList[m_paragraphRuns[first].m_propId];
 			if (location == MSWriteParserInternal::Paragraph::HEADER)
 			{
-				headerPage1 = m_paragraphList[first].m_firstpage;
-				headerOccurrence = m_paragraphList[first].m_HeaderFooterOccurrence;
-				header.setBegin(long(m_paragraphList[first].m_fcFirst));
-				header.setEnd(long(m_paragraphList[i - 1].m_fcLim));
+				headerPage1 = firstP.m_firstpage;
+				headerOccurrence = firstP.m_HeaderFooterOccurrence;
+				header.setBegin(long(m_paragraphRuns[first].m_fcFirst));
+				header.setEnd(long(m_paragraphRuns[i - 1].m_fcLim));
 				header.setType("TEXT");
 			}
 			else if (location == MSWriteParserInternal::Paragraph::FOOTER)
 			{
-				footerPage1 = m_paragraphList[first].m_firstpage;
-				footerOccurrence = m_paragraphList[first].m_HeaderFooterOccurrence;
-				footer.setBegin(long(m_paragraphList[first].m_fcFirst));
-				footer.setEnd(long(m_paragraphList[i - 1].m_fcLim));
+				footerPage1 = firstP.m_firstpage;
+				footerOccurrence = firstP.m_HeaderFooterOccurrence;
+				footer.setBegin(long(m_paragraphRuns[first].m_fcFirst));
+				footer.setEnd(long(m_paragraphRuns[i - 1].m_fcLim));
 				footer.setType("TEXT");
 			}
 
@@ -796,11 +818,9 @@ shared_ptr<WPSContentListener> MSWriteParser::createListener(librevenge::RVNGTex
 			break;
 	}
 
-	for (; i < m_paragraphList.size(); i++)
+	for (; i < m_paragraphRuns.size(); i++)
 	{
-		MSWriteParserInternal::Paragraph &p = m_paragraphList[i];
-
-		if (p.m_Location == MSWriteParserInternal::Paragraph::FOOTNOTE)
+		if (m_paragraphList[m_paragraphRuns[i].m_propId].m_Location == MSWriteParserInternal::Paragraph::FOOTNOTE)
 			break;
 	}
 
@@ -810,8 +830,8 @@ shared_ptr<WPSContentListener> MSWriteParser::createListener(librevenge::RVNGTex
 		throw (libwps::ParseException());
 	}
 
-	m_Main.setBegin(long(m_paragraphList[first].m_fcFirst));
-	m_Main.setEnd(long(std::min(m_paragraphList[i - 1].m_fcLim, m_fcMac)));
+	m_Main.setBegin(long(m_paragraphRuns[first].m_fcFirst));
+	m_Main.setEnd(long(std::min(m_paragraphRuns[i - 1].m_fcLim, m_fcMac)));
 	m_Main.setType("TEXT");
 
 	empty.setType("TEXT");
@@ -859,17 +879,17 @@ shared_ptr<WPSContentListener> MSWriteParser::createListener(librevenge::RVNGTex
 
 	ps.setPageSpan(numPages());
 	pageList.push_back(ps);
-	return shared_ptr<WPSContentListener>
-	       (new WPSContentListener(pageList, interface));
+	shared_ptr<WPSContentListener> listener(new WPSContentListener(pageList, interface));
+	listener->setTextOnly(getParseOptions().m_textOnly);
+	return listener;
 }
 
 void MSWriteParser::readText(WPSEntry e, MSWriteParserInternal::Paragraph::Location location)
 {
 	uint32_t fc = (uint32_t) e.begin();
-	std::vector<MSWriteParserInternal::Paragraph>::iterator paps;
-	std::vector<MSWriteParserInternal::Font>::iterator chps;
-	paps = m_paragraphList.begin();
-	chps = m_fontList.begin();
+	std::vector<MSWriteParserInternal::Run>::iterator paps, chps;
+	paps = m_paragraphRuns.begin();
+	chps = m_fontRuns.begin();
 	RVNGInputStreamPtr input = getInput();
 	float lastObjectHeight = 0.0;
 
@@ -877,26 +897,33 @@ void MSWriteParser::readText(WPSEntry e, MSWriteParserInternal::Paragraph::Locat
 	{
 		bool skiptab = false;
 
-		while (fc >= paps->m_fcLim)
+		if (fc >= paps->m_fcLim)
 		{
-			if (++paps == m_paragraphList.end())
+			paps = std::upper_bound(paps, m_paragraphRuns.end(), fc, MSWriteParserInternal::RunLimitCompare());
+			if (paps == m_paragraphRuns.end())
 			{
 				WPS_DEBUG_MSG(("MSWriteParser::readText PAP not found for offset %u\n", fc));
 				throw (libwps::ParseException());
 			}
-			skiptab = paps->m_skiptab;
+			skiptab = m_paragraphList[paps->m_propId].m_skiptab;
 		}
+		MSWriteParserInternal::Paragraph const &pap = m_paragraphList[paps->m_propId];
 
-		if (paps->m_Location != location)
+		if (pap.m_Location != location)
 		{
 			// ignore e.g. headers in main body of text
 			fc = paps->m_fcLim;
 			continue;
 		}
 
-		if (paps->m_graphics)
+		if (pap.m_graphics)
 		{
-			m_listener->setParagraph(*paps);
+			if (getParseOptions().m_skipEmbeddedObjects)
+			{
+				fc = paps->m_fcLim;
+				continue;
+			}
+			m_listener->setParagraph(pap);
 
 			// The last pap can have m_fcLim of greater than m_fcMac
 			unsigned fcLim = std::min(paps->m_fcLim, m_fcMac);
@@ -911,7 +938,7 @@ void MSWriteParser::readText(WPSEntry e, MSWriteParserInternal::Paragraph::Locat
 			WPSPosition pos;
 			WPSPosition::XPos align;
 
-			switch (paps->m_justify)
+			switch (pap.m_justify)
 			{
 			case libwps::JustificationFull:
 			case libwps::JustificationFullAllLines:
@@ -965,29 +992,38 @@ void MSWriteParser::readText(WPSEntry e, MSWriteParserInternal::Paragraph::Locat
 
 		lastObjectHeight = 0.0f;
 
-		while (fc >= chps->m_fcLim)
+		if (fc >= chps->m_fcLim)
 		{
-			if (++chps == m_fontList.end())
+			chps = std::upper_bound(chps, m_fontRuns.end(), fc, MSWriteParserInternal::RunLimitCompare());
+			if (chps == m_fontRuns.end())
 			{
 				WPS_DEBUG_MSG(("MSWriteParser::readText CHP not found for offset %u\n", fc));
 				throw (libwps::ParseException());
 			}
 		}
+		MSWriteParserInternal::Font const &chp = m_fontList[chps->m_propId];
 
-		MSWriteParserInternal::Paragraph para = *paps;
-		if (paps->m_interLine>0)
-			para.setInterline((paps->m_interLine * chps->m_size)/72., librevenge::RVNG_INCH, WPSParagraph::AtLeast);
-
-		if (!para.m_headerUseMargin && (para.m_Location == MSWriteParserInternal::Paragraph::HEADER ||
-		                                para.m_Location == MSWriteParserInternal::Paragraph::FOOTER))
+		// in text only mode, the paragraph properties are ignored
+		/* the paragraph is identified by its PAP, excepted when its interline
+		   depends on the font size; then it must be rebuilt each time */
+		int const paraId=pap.m_interLine>0 ? -1 : int(paps->m_propId);
+		if (!m_listener->isTextOnly() && (paraId<0 || paraId!=m_listener->getParagraphId()))
 		{
-			// Indents in header/footer are off paper, not margins
-			para.m_margins[1] -= m_pageSpan.getMarginLeft();
-			para.m_margins[2] -= m_pageSpan.getMarginRight();
-		}
+			MSWriteParserInternal::Paragraph para = pap;
+			if (pap.m_interLine>0)
+				para.setInterline((pap.m_interLine * chp.m_size)/72., librevenge::RVNG_INCH, WPSParagraph::AtLeast);
+
+			if (!para.m_headerUseMargin && (para.m_Location == MSWriteParserInternal::Paragraph::HEADER ||
+			                                para.m_Location == MSWriteParserInternal::Paragraph::FOOTER))
+			{
+				// Indents in header/footer are off paper, not margins
+				para.m_margins[1] -= m_pageSpan.getMarginLeft();
+				para.m_margins[2] -= m_pageSpan.getMarginRight();
+			}
 
-		m_listener->setParagraph(para);
-		m_listener->setFont(*chps);
+			m_listener->setParagraph(para, paraId);
+		}
+		m_listener->setFont(chp, int(chps->m_propId));
 
 		uint32_t lim = std::min(chps->m_fcLim, paps->m_fcLim);
 		lim = std::min(lim, m_fcMac);
@@ -1005,17 +1041,17 @@ void MSWriteParser::readText(WPSEntry e, MSWriteParserInternal::Paragraph::Locat
 				throw (libwps::ParseException());
 			}
 
-			if (chps->m_special)
+			if (chp.m_special)
 			{
-				insertSpecial(p[0], fc, paps->m_Location);
+				insertSpecial(p[0], fc, pap.m_Location);
 				size = 1;
 			}
-			else if (chps->m_footnote || chps->m_annotation)
+			else if (chp.m_footnote || chp.m_annotation)
 			{
-				if (paps->m_Location == MSWriteParserInternal::Paragraph::MAIN)
+				if (pap.m_Location == MSWriteParserInternal::Paragraph::MAIN)
 				{
-					librevenge::RVNGString label = libwps_tools_win::Font::unicodeString(p, size, chps->m_encoding);
-					insertNote(chps->m_annotation, fc, label);
+					librevenge::RVNGString label = libwps_tools_win::Font::unicodeString(p, size, chp.m_encoding);
+					insertNote(chp.m_annotation, fc, label);
 				}
 			}
 			else
@@ -1027,7 +1063,7 @@ void MSWriteParser::readText(WPSEntry e, MSWriteParserInternal::Paragraph::Locat
 					fc++;
 				}
 				if (size)
-					size = insertString(p, size, chps->m_encoding);
+					size = insertString(p, size, chp.m_encoding);
 			}
 			fc += size;
 
@@ -1084,9 +1120,7 @@ unsigned MSWriteParser::insertString(const unsigned char *str, unsigned size, li
 	else
 	{
 		librevenge::RVNGString convert;
-
-		convert = libwps_tools_win::Font::unicodeString(str, len, type);
-
+		libwps_tools_win::Font::appendUnicodeString(str, len, type, convert);
 		m_listener->insertUnicodeString(convert);
 	}
 
@@ -1649,16 +1683,16 @@ void MSWriteParser::readStructures()
 
 	input->seek(MSWriteParserInternal::HEADER_W_PNPARA, librevenge::RVNG_SEEK_SET);
 	unsigned pnPara = libwps::readU16(input);
-	readFOD(pnPara, &MSWriteParser::readPAP);
+	readFOD(pnPara, &MSWriteParser::readPAP, m_paragraphRuns);
 
-	if (m_paragraphList.empty())
+	if (m_paragraphRuns.empty())
 	{
 		WPS_DEBUG_MSG(("MSWriteParser::parse: failed to read any PAP entries\n"));
 		throw (libwps::ParseException());
 	}
 
-	readFOD((m_fcMac + 127) / 128, &MSWriteParser::readCHP);
-	if (m_fontList.empty())
+	readFOD((m_fcMac + 127) / 128, &MSWriteParser::readCHP, m_fontRuns);
+	if (m_fontRuns.empty())
 	{
 		WPS_DEBUG_MSG(("MSWriteParser::parse: failed to read any CHP entries\n"));
 		throw (libwps::ParseException());
@@ -41,11 +41,10 @@ class SubDocument;
 struct Paragraph :  public WPSParagraph
 {
 	enum Location { MAIN, HEADER, FOOTER, FOOTNOTE };
-	Paragraph() : WPSParagraph(), m_fcFirst(0), m_fcLim(0),
+	Paragraph() : WPSParagraph(),
 		m_Location(MAIN), m_graphics(false), m_firstpage(false),
 		m_skiptab(false), m_headerUseMargin(false), m_interLine(0.0),
 		m_HeaderFooterOccurrence(WPSPageSpan::ALL)  { }
-	uint32_t m_fcFirst, m_fcLim;
 	Location m_Location;
 	bool m_graphics, m_firstpage, m_skiptab, m_headerUseMargin;
 	double m_interLine;
@@ -54,14 +53,23 @@ struct Paragraph :  public WPSParagraph
 
 struct Font : public WPSFont
 {
-	Font() : WPSFont(), m_fcFirst(0), m_fcLim(0), m_special(false),
+	Font() : WPSFont(), m_special(false),
 		m_footnote(false), m_annotation(false),
 		m_encoding(libwps_tools_win::Font::UNKNOWN) { }
-	uint32_t m_fcFirst, m_fcLim;
 	bool m_special, m_footnote, m_annotation;
 	libwps_tools_win::Font::Type m_encoding;
 };
 
+//! a FOD run: a range of characters and the id of its properties
+struct Run
+{
+	Run(uint32_t fcFirst=0, uint32_t fcLim=0, unsigned propId=0) :
+		m_fcFirst(fcFirst), m_fcLim(fcLim), m_propId(propId) { }
+	uint32_t m_fcFirst, m_fcLim;
+	//! the index in the paragraph or the font list
+	unsigned m_propId;
+};
+
 struct Footnote
 {
 	Footnote() : m_fcFtn(0), m_fcRef(0) { }
@@ -99,9 +107,16 @@ protected:
 	void readFIB();
 	virtual void readFFNTB();
 	void readSECT();
-	void readFOD(unsigned page, void (MSWriteParser::*parseFOD)(uint32_t fcFirst, uint32_t fcLim, unsigned size));
-	virtual void readPAP(uint32_t fcFirst, uint32_t fcLim, unsigned cch);
-	virtual void readCHP(uint32_t fcFirst, uint32_t fcLim, unsigned cch);
+	/** reads the FOD pages beginning at page and appends their runs.
+
+		The properties are decoded once per (page, bfProp) by parseFOD
+		which must return the index of the property it has added. */
+	void readFOD(unsigned page, unsigned(MSWriteParser::*parseFOD)(unsigned size),
+	             std::vector<MSWriteParserInternal::Run> &runs);
+	//! reads a PAP, adds it to the paragraph list and returns its index
+	virtual unsigned readPAP(unsigned cch);
+	//! reads a CHP, adds it to the font list and returns its index
+	virtual unsigned readCHP(unsigned cch);
 	virtual void readSUMD();
 	virtual void readFNTB();
 	void readText(WPSEntry e, MSWriteParserInternal::Paragraph::Location location);
@@ -128,8 +143,14 @@ protected:
 	uint32_t m_fileLength;
 	uint32_t m_fcMac;
 
+	//! the different paragraph properties
 	std::vector<MSWriteParserInternal::Paragraph> m_paragraphList;
+	//! the paragraph runs
+	std::vector<MSWriteParserInternal::Run> m_paragraphRuns;
+	//! the different font properties
 	std::vector<MSWriteParserInternal::Font> m_fontList;
+	//! the character runs
+	std::vector<MSWriteParserInternal::Run> m_fontRuns;
 	std::vector<MSWriteParserInternal::Footnote> m_footnotes;
 	std::vector<librevenge::RVNGString> m_fonts;
 	WPSPageSpan m_pageSpan;
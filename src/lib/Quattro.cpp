@@ -182,7 +182,7 @@ bool State::getColor(int id, WPSColor &color) const
 // constructor, destructor
 QuattroParser::QuattroParser(RVNGInputStreamPtr &input, WPSHeaderPtr &header,
                              libwps_tools_win::Font::Type encoding) :
-	WKSParser(input, header), m_listener(), m_state(), m_spreadsheetParser()
+	WKSParser(input, header), m_listener(), m_headerChecked(false), m_state(), m_spreadsheetParser()
 
 {
 	m_state.reset(new QuattroParserInternal::State(encoding));
@@ -254,7 +254,8 @@ void QuattroParser::parse(librevenge::RVNGSpreadsheetInterface *documentInterfac
 		throw (libwps::ParseException());
 	}
 
-	if (!checkHeader(0L, true)) throw(libwps::ParseException());
+	// the header may have already been checked by WPSDocument
+	if (!m_headerChecked && !checkHeader(0L, true)) throw(libwps::ParseException());
 
 	bool ok=false;
 	try
@@ -271,8 +272,15 @@ void QuattroParser::parse(librevenge::RVNGSpreadsheetInterface *documentInterfac
 			m_listener->startDocument();
 			int numSheet=m_spreadsheetParser->getNumSpreadsheets();
 			if (numSheet==0) ++numSheet;
-			for (int i=0; i<numSheet; ++i)
-				m_spreadsheetParser->sendSpreadsheet(i);
+			if (isSelectedRangeUnknown())
+			{
+				WPS_DEBUG_MSG(("QuattroParser::parse: can not find the selected range\n"));
+			}
+			else for (int i=0; i<numSheet; ++i)
+			{
+				if (isSheetSelected(i))
+					m_spreadsheetParser->sendSpreadsheet(i);
+			}
 			m_listener->endDocument();
 			m_listener.reset();
 			ok = true;
@@ -382,6 +390,8 @@ bool QuattroParser::checkHeader(WPSHeader *header, bool strict)
 		header->setKind(libwps::WPS_SPREADSHEET);
 		header->setNeedEncoding(true);
 	}
+	if (strict)
+		m_headerChecked=true;
 	return true;
 }
 
@@ -844,17 +854,25 @@ void QuattroParser::sendHeaderFooter(bool header)
 
 	std::string const &text=header ? m_state->m_headerString : m_state->m_footerString;
 	bool hasLICS=hasLICSCharacters();
-	for (size_t i=0; i < text.size(); ++i)
+	size_t i=0;
+	while (i < text.size())
 	{
 		unsigned char c=(unsigned char) text[i];
 		if (c==0xd)
 			m_listener->insertEOL();
-		else if (c==0xa)
+		if (c==0xd || c==0xa)
+		{
+			++i;
 			continue;
-		else if (!hasLICS)
-			m_listener->insertUnicode((uint32_t)libwps_tools_win::Font::unicode(c,fontType));
-		else
-			m_listener->insertUnicode((uint32_t)libwps_tools_win::Font::LICSunicode(c,fontType));
+		}
+		size_t first=i;
+		while (i < text.size() && text[i]!=char(0xd) && text[i]!=char(0xa))
+			++i;
+		librevenge::RVNGString str;
+		libwps_tools_win::Font::appendUnicodeString
+		((unsigned char const *)text.c_str()+first, (unsigned long)(i-first), fontType, str, hasLICS, true);
+		if (!str.empty())
+			m_listener->insertUnicodeString(str);
 	}
 
 }
@@ -969,6 +987,8 @@ bool QuattroParser::readFieldName()
 	if (dim[0]!=dim[2] || dim[1]!=dim[3])
 		f << "<->" << dim[2] << "x" << dim[3];
 	f << ",";
+	if (!name.empty())
+		checkSelectedRange(name, 0, Box2i(Vec2i(dim[0],dim[1]),Vec2i(dim[2],dim[3])));
 	ascii().addPos(pos);
 	ascii().addNote(f.str().c_str());
 	return true;
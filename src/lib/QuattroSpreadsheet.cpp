@@ -25,6 +25,7 @@
 #include <cmath>
 #include <sstream>
 #include <limits>
+#include <map>
 #include <stack>
 
 #include <librevenge-stream/librevenge-stream.h>
@@ -33,7 +34,9 @@
 #include "libwps_tools_win.h"
 
 #include "WPSCell.h"
+#include "WKSCellStore.h"
 #include "WKSContentListener.h"
+#include "WKSFormulaCache.h"
 #include "WPSEntry.h"
 #include "WPSFont.h"
 
@@ -62,103 +65,18 @@ struct Style : public WPSCellFormat
 	{
 		return !(*this==st);
 	}
-	//! font encoding type
-	libwps_tools_win::Font::Type m_fontType;
-	//! the file format
-	int m_fileFormat;
-	/** extra data */
-	std::string m_extra;
-};
-
-//! operator<<
-std::ostream &operator<<(std::ostream &o, Style const &style)
-{
-	o << static_cast<WPSCellFormat const &>(style) << ",";
-	if (style.m_fileFormat!=0xFF)
-		o << "format=" << std::hex << style.m_fileFormat << std::dec << ",";
-	if (style.m_extra.length())
-		o << "extra=[" << style.m_extra << "],";
-
-	return o;
-}
-
-bool Style::operator==(Style const &st) const
-{
-	if (m_fontType!=st.m_fontType || m_fileFormat!=st.m_fileFormat) return false;
-	int diff = WPSCellFormat::compare(st);
-	if (diff) return false;
-	return m_extra==st.m_extra;
-}
-
-///////////////////////////////////////////////////////////////////
-//! the style manager
-class StyleManager
-{
-public:
-	StyleManager() : m_idStyleMap() {}
-	//! add a new style and returns its id
-	void add(int id, Style const &st)
+	//! a comparison function: returns -1, 0 or 1
+	int cmp(Style const &st) const;
+	//! a comparaison structure used to store the styles in a map
+	struct Compare
 	{
-		if (m_idStyleMap.find(id)!=m_idStyleMap.end())
+		//! comparaison function
+		bool operator()(Style const &st1, Style const &st2) const
 		{
-			WPS_DEBUG_MSG(("QuattroParserInternal::StyleManager::add style %d already exists\n", id));
-			return;
+			return st1.cmp(st2) < 0;
 		}
-		m_idStyleMap.insert(std::map<int, Style>::value_type(id,st));
-	}
-	//! returns the style with id
-	bool get(int id, Style &style) const
-	{
-		if (m_idStyleMap.find(id)==m_idStyleMap.end())
-		{
-			WPS_DEBUG_MSG(("QuattroParserInternal::StyleManager::get can not find style %d\n", id));
-			return false;
-		}
-		style=m_idStyleMap.find(id)->second;
-		return true;
-	}
-	//! print a style
-	void print(int id, std::ostream &o) const
-	{
-		if (m_idStyleMap.find(id)!=m_idStyleMap.end())
-			o << ", style=" << m_idStyleMap.find(id)->second;
-		else
-		{
-			WPS_DEBUG_MSG(("QuattroParserInternal::StyleManager::print: can not find a style\n"));
-			o << ", ###style=" << id;
-		}
-	}
-
-protected:
-	//! the styles
-	std::map<int, Style> m_idStyleMap;
-};
-
-//! a cellule of a Quattro spreadsheet
-class Cell : public WPSCell
-{
-public:
-	/// constructor
-	explicit Cell(libwps_tools_win::Font::Type type) : m_fontType(type), m_fileFormat(0xFF), m_content() { }
-
-	//! operator<<
-	friend std::ostream &operator<<(std::ostream &o, Cell const &cell);
-
-	//! call when a cell must be send
-	bool send(WPSListenerPtr &/*listener*/)
-	{
-		WPS_DEBUG_MSG(("QuattroSpreadsheetInternal::Cell::send: must not be called\n"));
-		return false;
-	}
-
-	//! call when the content of a cell must be send
-	bool sendContent(WPSListenerPtr &/*listener*/)
-	{
-		WPS_DEBUG_MSG(("QuattroSpreadsheetInternal::Cell::sendContent: must not be called\n"));
-		return false;
-	}
-
-	//! update the cell format using file format
+	};
+	//! update the cell format using the file format
 	void updateFormat()
 	{
 		switch ((m_fileFormat>>4)&7)
@@ -193,12 +111,12 @@ public:
 				setDTFormat(F_DATE, "%m/%d");
 				break;
 			default:
-				WPS_DEBUG_MSG(("QuattroSpreadsheetInternal::Cell::updateFormat: unknown format %x\n", (unsigned) m_fileFormat));
+				WPS_DEBUG_MSG(("QuattroSpreadsheetInternal::Style::updateFormat: unknown format %x\n", (unsigned) m_fileFormat));
 				break;
 			}
 			break;
 		case 6:
-			WPS_DEBUG_MSG(("QuattroSpreadsheetInternal::Cell::updateFormat: unknown format %x\n", (unsigned) m_fileFormat));
+			WPS_DEBUG_MSG(("QuattroSpreadsheetInternal::Style::updateFormat: unknown format %x\n", (unsigned) m_fileFormat));
 			break;
 		case 7:
 			switch (m_fileFormat&0xF)
@@ -260,6 +178,173 @@ public:
 	libwps_tools_win::Font::Type m_fontType;
 	//! the file format
 	int m_fileFormat;
+	/** extra data */
+	std::string m_extra;
+};
+
+//! operator<<
+std::ostream &operator<<(std::ostream &o, Style const &style)
+{
+	o << static_cast<WPSCellFormat const &>(style) << ",";
+	if (style.m_fileFormat!=0xFF)
+		o << "format=" << std::hex << style.m_fileFormat << std::dec << ",";
+	if (style.m_extra.length())
+		o << "extra=[" << style.m_extra << "],";
+
+	return o;
+}
+
+bool Style::operator==(Style const &st) const
+{
+	if (m_fontType!=st.m_fontType || m_fileFormat!=st.m_fileFormat) return false;
+	int diff = WPSCellFormat::compare(st);
+	if (diff) return false;
+	return m_extra==st.m_extra;
+}
+
+int Style::cmp(Style const &st) const
+{
+	if (m_fontType!=st.m_fontType) return m_fontType<st.m_fontType ? -1 : 1;
+	if (m_fileFormat!=st.m_fileFormat) return m_fileFormat<st.m_fileFormat ? -1 : 1;
+	int diff = WPSCellFormat::compare(st);
+	if (diff) return diff < 0 ? -1 : 1;
+	diff = getFont().cmp(st.getFont());
+	if (diff) return diff;
+	diff = m_extra.compare(st.m_extra);
+	if (diff) return diff < 0 ? -1 : 1;
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////
+//! the style manager
+class StyleManager
+{
+public:
+	StyleManager() : m_idStyleMap() {}
+	//! add a new style and returns its id
+	void add(int id, Style const &st)
+	{
+		if (m_idStyleMap.find(id)!=m_idStyleMap.end())
+		{
+			WPS_DEBUG_MSG(("QuattroParserInternal::StyleManager::add style %d already exists\n", id));
+			return;
+		}
+		m_idStyleMap.insert(std::map<int, Style>::value_type(id,st));
+	}
+	//! returns the style with id
+	bool get(int id, Style &style) const
+	{
+		if (m_idStyleMap.find(id)==m_idStyleMap.end())
+		{
+			WPS_DEBUG_MSG(("QuattroParserInternal::StyleManager::get can not find style %d\n", id));
+			return false;
+		}
+		style=m_idStyleMap.find(id)->second;
+		return true;
+	}
+	//! print a style
+	void print(int id, std::ostream &o) const
+	{
+		if (m_idStyleMap.find(id)!=m_idStyleMap.end())
+			o << ", style=" << m_idStyleMap.find(id)->second;
+		else
+		{
+			WPS_DEBUG_MSG(("QuattroParserInternal::StyleManager::print: can not find a style\n"));
+			o << ", ###style=" << id;
+		}
+	}
+
+protected:
+	//! the styles
+	std::map<int, Style> m_idStyleMap;
+};
+
+///////////////////////////////////////////////////////////////////
+/** the table of the styles used by the cells: each different cell
+	style is stored only once and the cells only keep its index */
+class CellStyleManager
+{
+public:
+	//! constructor
+	CellStyleManager() : m_styleIdMap(), m_stylesList(), m_finalStylesList() {}
+	//! adds a style if needed and returns its id
+	int add(Style const &st)
+	{
+		std::map<Style,int,Style::Compare>::const_iterator it=m_styleIdMap.find(st);
+		if (it!=m_styleIdMap.end())
+			return it->second;
+		int id=int(m_stylesList.size());
+		m_stylesList.push_back(st);
+		m_styleIdMap.insert(std::map<Style,int,Style::Compare>::value_type(st,id));
+		return id;
+	}
+	//! returns the style with id or a default style
+	Style get(int id, libwps_tools_win::Font::Type defaultType) const
+	{
+		if (id<0 || id>=int(m_stylesList.size()))
+			return Style(defaultType);
+		return m_stylesList[size_t(id)];
+	}
+	//! returns the style which must be sent for a style id: ie. the style updated with its file format
+	Style const *getFinalStyle(int id)
+	{
+		if (id<0 || id>=int(m_stylesList.size()))
+		{
+			WPS_DEBUG_MSG(("QuattroSpreadsheetInternal::CellStyleManager::getFinalStyle: can not find style %d\n", id));
+			return 0;
+		}
+		if (m_finalStylesList.size()<m_stylesList.size())
+			m_finalStylesList.resize(m_stylesList.size());
+		shared_ptr<Style> &style=m_finalStylesList[size_t(id)];
+		if (!style)
+		{
+			style.reset(new Style(m_stylesList[size_t(id)]));
+			style->updateFormat();
+		}
+		return style.get();
+	}
+
+protected:
+	//! a map style to id
+	std::map<Style,int,Style::Compare> m_styleIdMap;
+	//! the list of styles
+	std::vector<Style> m_stylesList;
+	//! the list of final styles (created when needed)
+	std::vector<shared_ptr<Style> > m_finalStylesList;
+};
+
+/** a cellule of a Quattro spreadsheet
+
+	\note the cell format is stored in the cell style manager */
+class Cell
+{
+public:
+	/// constructor
+	Cell() : m_position(0,0), m_styleId(-1), m_content() { }
+
+	//! operator<<
+	friend std::ostream &operator<<(std::ostream &o, Cell const &cell);
+
+	//! returns the cell position
+	Vec2i const &position() const
+	{
+		return m_position;
+	}
+	//! sets the cell position
+	void setPosition(Vec2i const &pos)
+	{
+		m_position=pos;
+	}
+	//! returns true if the two cells have the same style and the same constant content
+	bool isRepeatedWith(Cell const &cell) const
+	{
+		return m_styleId==cell.m_styleId && m_content.isSameConstant(cell.m_content);
+	}
+
+	//! the cell position
+	Vec2i m_position;
+	//! the cell style id
+	int m_styleId;
 	//! the content
 	WKSContentListener::CellContent m_content;
 };
@@ -267,9 +352,9 @@ public:
 //! operator<<
 std::ostream &operator<<(std::ostream &o, Cell const &cell)
 {
-	o << reinterpret_cast<WPSCell const &>(cell) << cell.m_content << ",";
-	if (cell.m_fileFormat!=0xFF)
-		o << "format=" << std::hex << cell.m_fileFormat << std::dec << ",";
+	o << "C" << cell.m_position << ":" << cell.m_content << ",";
+	if (cell.m_styleId>=0)
+		o << "style=" << cell.m_styleId << ",";
 	return o;
 }
 
@@ -283,26 +368,22 @@ public:
 
 	//! a constructor
 	Spreadsheet(Type type=T_Spreadsheet, int id=0) : m_type(type), m_id(id), m_numCols(0), m_numRows(0),
-		m_widthCols(), m_rowHeightMap(), m_heightDefault(16), m_positionToCellMap(), m_lastCellPos(),
+		m_widthCols(), m_rowHeights(), m_heightDefault(16), m_cells(), m_lastCellPos(),
 		m_rowPageBreaksList() {}
 	//! return a cell corresponding to a spreadsheet, create one if needed
-	Cell &getCell(Vec2i const &pos, libwps_tools_win::Font::Type type)
+	Cell &getCell(Vec2i const &pos)
 	{
-		if (m_positionToCellMap.find(pos)==m_positionToCellMap.end())
-		{
-			Cell cell(type);
+		bool isNew;
+		Cell &cell=m_cells.insert(pos, isNew, Cell());
+		if (isNew)
 			cell.setPosition(pos);
-			m_positionToCellMap.insert(std::map<Vec2i, Cell>::value_type(pos,cell));
-		}
 		m_lastCellPos=pos;
-		return m_positionToCellMap.find(pos)->second;
+		return cell;
 	}
 	//! returns the last cell
 	Cell *getLastCell()
 	{
-		if (m_positionToCellMap.find(m_lastCellPos)==m_positionToCellMap.end())
-			return 0;
-		return &m_positionToCellMap.find(m_lastCellPos)->second;
+		return m_cells.find(m_lastCellPos);
 	}
 	//! set the columns size
 	void setColumnWidth(int col, int w=-1)
@@ -330,19 +411,20 @@ public:
 	//! returns the row size in point
 	float getRowHeight(int row) const
 	{
-		std::map<Vec2i,int>::const_iterator rIt=m_rowHeightMap.lower_bound(Vec2i(-1,row));
-		if (rIt!=m_rowHeightMap.end() && rIt->first[0]<=row && rIt->first[1]>=row)
-			return (float) rIt->second;
+		int const *height=m_rowHeights.find(row);
+		if (height)
+			return float(*height);
 		return (float) m_heightDefault;
 	}
 	//! returns the height of a row in point and updated repeated row
 	float getRowHeight(int row, int &numRepeated) const
 	{
-		std::map<Vec2i,int>::const_iterator rIt=m_rowHeightMap.lower_bound(Vec2i(-1,row));
-		if (rIt!=m_rowHeightMap.end() && rIt->first[0]<=row && rIt->first[1]>=row)
+		int lastRow;
+		int const *height=m_rowHeights.find(row, &lastRow);
+		if (height)
 		{
-			numRepeated=rIt->first[1]-row+1;
-			return (float) rIt->second;
+			numRepeated=lastRow-row+1;
+			return float(*height);
 		}
 		numRepeated=10000;
 		return (float) m_heightDefault;
@@ -351,48 +433,17 @@ public:
 	void setRowHeight(int row, int h)
 	{
 		if (h>=0)
-			m_rowHeightMap[Vec2i(row,row)]=h;
+			m_rowHeights.set(row, h);
 	}
 	//! try to compress the list of row height
 	void compressRowHeights()
 	{
-		std::map<Vec2i,int> oldMap=m_rowHeightMap;
-		m_rowHeightMap.clear();
-		std::map<Vec2i,int>::const_iterator rIt=oldMap.begin();
-		int actHeight=-1;
-		Vec2i actPos(0,-1);
-		while (rIt!=oldMap.end())
-		{
-			// first check for not filled row
-			if (rIt->first[0]!=actPos[1]+1)
-			{
-				if (actHeight==m_heightDefault)
-					actPos[1]=rIt->first[0]-1;
-				else
-				{
-					if (actPos[1]>=actPos[0])
-						m_rowHeightMap[actPos]=actHeight;
-					actHeight=m_heightDefault;
-					actPos=Vec2i(actPos[1]+1, rIt->first[0]-1);
-				}
-			}
-			if (rIt->second!=actHeight)
-			{
-				if (actPos[1]>=actPos[0])
-					m_rowHeightMap[actPos]=actHeight;
-				actPos[0]=rIt->first[0];
-				actHeight=rIt->second;
-			}
-			actPos[1]=rIt->first[1];
-			++rIt;
-		}
-		if (actPos[1]>=actPos[0])
-			m_rowHeightMap[actPos]=actHeight;
+		m_rowHeights.compress(m_heightDefault);
 	}
 	//! returns true if the spreedsheet is empty
 	bool empty() const
 	{
-		return m_positionToCellMap.empty();
+		return m_cells.empty();
 	}
 	//! the spreadsheet type
 	Type m_type;
@@ -405,12 +456,12 @@ public:
 
 	/** the column size in TWIP (?) */
 	std::vector<int> m_widthCols;
-	/** the map Vec2i(min row, max row) to size in points */
-	std::map<Vec2i,int> m_rowHeightMap;
+	/** the row size in points */
+	WKSRowRuns<int> m_rowHeights;
 	/** the default row size in point */
 	int m_heightDefault;
-	/** a map cell to not empty cells */
-	std::map<Vec2i, Cell> m_positionToCellMap;
+	/** the not empty cells, stored row by row */
+	WKSCellStore<Cell> m_cells;
 	/** the last cell position */
 	Vec2i m_lastCellPos;
 	/** the list of row page break */
@@ -422,7 +473,7 @@ public:
 struct State
 {
 	//! constructor
-	State() :  m_eof(-1), m_version(-1), m_hasLICSCharacters(-1), m_styleManager(), m_spreadsheetList(), m_spreadsheetStack()
+	State() :  m_eof(-1), m_version(-1), m_hasLICSCharacters(-1), m_styleManager(), m_cellStyleManager(), m_spreadsheetList(), m_spreadsheetStack(), m_formulaCache()
 	{
 		pushNewSheet(shared_ptr<Spreadsheet>(new Spreadsheet(Spreadsheet::T_Spreadsheet, 0)));
 	}
@@ -492,11 +543,15 @@ struct State
 	int m_hasLICSCharacters;
 	//! the style manager
 	StyleManager m_styleManager;
+	//! the cell style manager
+	CellStyleManager m_cellStyleManager;
 
 	//! the list of spreadsheet ( first: main spreadsheet, other report spreadsheet )
 	std::vector<shared_ptr<Spreadsheet> > m_spreadsheetList;
 	//! the stack of spreadsheet id
 	std::stack<shared_ptr<Spreadsheet> > m_spreadsheetStack;
+	//! the formulas already decoded
+	WKSFormulaCache m_formulaCache;
 };
 
 }
@@ -650,12 +705,14 @@ bool QuattroSpreadsheet::readColumnSize()
 	{
 		if (col >= m_state->getActualSheet().m_numCols)
 		{
+#ifdef DEBUG
 			static bool first = true;
 			if (first)
 			{
 				first = false;
 				WPS_DEBUG_MSG(("QuattroSpreadsheet::readColumnSize: I must increase the number of columns\n"));
 			}
+#endif
 			f << "#col[inc],";
 		}
 		// checkme: unit in character(?) -> TWIP
@@ -689,12 +746,14 @@ bool QuattroSpreadsheet::readHiddenColumns()
 	{
 		int val=(int) libwps::readU8(m_input);
 		if (!val) continue;
+#ifdef DEBUG
 		static bool first=true;
 		if (first)
 		{
 			WPS_DEBUG_MSG(("QuattroSpreadsheet::readHiddenColumns: find some hidden col, ignored\n"));
 			first=false;
 		}
+#endif
 		// checkme
 		for (int j=0, depl=1; j<8; ++j, depl<<=1)
 		{
@@ -909,22 +968,25 @@ bool QuattroSpreadsheet::readCellProperty()
 	int format=(int) libwps::readU8(m_input);
 	int col=(int) libwps::read16(m_input);
 	int row=(int) libwps::read16(m_input);
-	QuattroSpreadsheetInternal::Cell emptyCell(defFontType);
+	QuattroSpreadsheetInternal::Cell emptyCell;
 	QuattroSpreadsheetInternal::Cell *cell=&emptyCell;
 	if (col<0 || row<0)
 	{
 		WPS_DEBUG_MSG(("QuattroSpreadsheet::readCellProperty: the position seems bad\n"));
 		f << "###";
 	}
+	else if (!m_mainParser.isCellSelected(m_state->getActualSheet().m_id, Vec2i(col,row)))
+		f << "skipped,";
 	else
-		cell = &m_state->getActualSheet().getCell(Vec2i(col,row),defFontType);
+		cell = &m_state->getActualSheet().getCell(Vec2i(col,row));
+	QuattroSpreadsheetInternal::Style cellStyle=m_state->m_cellStyleManager.get(cell->m_styleId, defFontType);
 	f << "C" << Vec2i(col,row) << ",";
 	int flag=(int) libwps::readU8(m_input);
 	int id=(int) libwps::readU8(m_input);
 	if (id&0x80)
 	{
 		f << "Ce" << (id&0x7f) << ",";
-		QuattroSpreadsheetInternal::Style style(cell->m_fontType);
+		QuattroSpreadsheetInternal::Style style(cellStyle.m_fontType);
 		if (!m_state->m_styleManager.get((id&0x7f), style))
 		{
 			WPS_DEBUG_MSG(("QuattroSpreadsheet::readCellProperty: can not find a style\n"));
@@ -933,12 +995,12 @@ bool QuattroSpreadsheet::readCellProperty()
 		else
 		{
 			if (style.m_fileFormat==0xFF)
-				cell->m_fileFormat=style.m_fileFormat;
-			cell->m_fontType=style.m_fontType;
-			cell->setFont(style.getFont());
-			cell->setBackgroundColor(style.backgroundColor());
+				cellStyle.m_fileFormat=style.m_fileFormat;
+			cellStyle.m_fontType=style.m_fontType;
+			cellStyle.setFont(style.getFont());
+			cellStyle.setBackgroundColor(style.backgroundColor());
 			if (style.hasBorders())
-				cell->setBorders(style.borders());
+				cellStyle.setBorders(style.borders());
 		}
 	}
 	else if (id)
@@ -946,33 +1008,33 @@ bool QuattroSpreadsheet::readCellProperty()
 		if (id&0x7c)
 			f << "Fo" << (id>>2) << ",";
 		WPSFont font;
-		if (!m_mainParser.getFont(id>>2, font, cell->m_fontType))
+		if (!m_mainParser.getFont(id>>2, font, cellStyle.m_fontType))
 		{
 			WPS_DEBUG_MSG(("QuattroSpreadsheet::readCellProperty: can not find a font\n"));
 			f << "###";
 		}
 		else
-			cell->setFont(font);
+			cellStyle.setFont(font);
 		if (id&0x3)
 			f << "f0=" << (id&3) << ",";
 	}
 	if (format!=0xFF)
 	{
-		cell->m_fileFormat=format;
+		cellStyle.m_fileFormat=format;
 		f << "form=" << std::hex << format << std::dec << ",";
 	}
 	switch (flag>>6)
 	{
 	case 1:
-		cell->setHAlignement(WPSCellFormat::HALIGN_LEFT);
+		cellStyle.setHAlignement(WPSCellFormat::HALIGN_LEFT);
 		f << "left,";
 		break;
 	case 2:
-		cell->setHAlignement(WPSCellFormat::HALIGN_RIGHT);
+		cellStyle.setHAlignement(WPSCellFormat::HALIGN_RIGHT);
 		f << "right,";
 		break;
 	case 3:
-		cell->setHAlignement(WPSCellFormat::HALIGN_CENTER);
+		cellStyle.setHAlignement(WPSCellFormat::HALIGN_CENTER);
 		f << "center,";
 		break;
 	default:
@@ -1000,16 +1062,16 @@ bool QuattroSpreadsheet::readCellProperty()
 			break;
 		}
 		f << ",";
-		cell->setBorders(i==0 ? WPSBorder::TopBit : WPSBorder::LeftBit, border);
+		cellStyle.setBorders(i==0 ? WPSBorder::TopBit : WPSBorder::LeftBit, border);
 	}
 	switch ((flag>>4)&3)
 	{
 	case 1:
-		cell->setBackgroundColor(WPSColor(0x80,0x80,0x80));
+		cellStyle.setBackgroundColor(WPSColor(0x80,0x80,0x80));
 		f << "back[grey],";
 		break;
 	case 2:
-		cell->setBackgroundColor(WPSColor::black());
+		cellStyle.setBackgroundColor(WPSColor::black());
 		f << "back[black],";
 		break;
 	case 3:
@@ -1019,6 +1081,8 @@ bool QuattroSpreadsheet::readCellProperty()
 	default:
 		break;
 	}
+	if (cell!=&emptyCell)
+		cell->m_styleId=m_state->m_cellStyleManager.add(cellStyle);
 	ascii().addPos(pos);
 	ascii().addNote(f.str().c_str());
 	return true;
@@ -1338,9 +1402,17 @@ bool QuattroSpreadsheet::readCell()
 		}
 		f << "sheet[id]=" << sheetId << ",";
 	}
+	if (!m_mainParser.isCellSelected(m_state->getActualSheet().m_id, Vec2i(cellPos[0],cellPos[1])))
+	{
+		f << "skipped,";
+		ascii().addPos(pos);
+		ascii().addNote(f.str().c_str());
+		return true;
+	}
 
-	QuattroSpreadsheetInternal::Cell &cell=m_state->getActualSheet().getCell(Vec2i(cellPos[0],cellPos[1]), defFontType);
-	cell.m_fileFormat=format;
+	QuattroSpreadsheetInternal::Cell &cell=m_state->getActualSheet().getCell(Vec2i(cellPos[0],cellPos[1]));
+	QuattroSpreadsheetInternal::Style cellStyle=m_state->m_cellStyleManager.get(cell.m_styleId, defFontType);
+	cellStyle.m_fileFormat=format;
 	if (!dosFile)
 	{
 		int id=(int) libwps::readU16(m_input);
@@ -1350,17 +1422,17 @@ bool QuattroSpreadsheet::readCell()
 			if (id&0xFF) f << "-" << (id&0xFF);
 			f << ",";
 		}
-		QuattroSpreadsheetInternal::Style style(m_mainParser.getDefaultFontType());
+		QuattroSpreadsheetInternal::Style style(defFontType);
 		if (!m_state->m_styleManager.get(id, style))
 			f << "###";
 		else
 		{
-			cell.m_fileFormat=style.m_fileFormat;
-			cell.m_fontType=style.m_fontType;
-			cell.setFont(style.getFont());
-			cell.setBackgroundColor(style.backgroundColor());
+			cellStyle.m_fileFormat=style.m_fileFormat;
+			cellStyle.m_fontType=style.m_fontType;
+			cellStyle.setFont(style.getFont());
+			cellStyle.setBackgroundColor(style.backgroundColor());
 			if (style.hasBorders())
-				cell.setBorders(style.borders());
+				cellStyle.setBorders(style.borders());
 		}
 	}
 
@@ -1411,10 +1483,10 @@ bool QuattroSpreadsheet::readCell()
 		std::string s("");
 		// pascal string
 		char align=(char) libwps::readU8(m_input);
-		if (align=='\'') cell.setHAlignement(WPSCellFormat::HALIGN_DEFAULT);
-		else if (align=='\\') cell.setHAlignement(WPSCellFormat::HALIGN_LEFT);
-		else if (align=='^') cell.setHAlignement(WPSCellFormat::HALIGN_CENTER);
-		else if (align=='\"') cell.setHAlignement(WPSCellFormat::HALIGN_RIGHT);
+		if (align=='\'') cellStyle.setHAlignement(WPSCellFormat::HALIGN_DEFAULT);
+		else if (align=='\\') cellStyle.setHAlignement(WPSCellFormat::HALIGN_LEFT);
+		else if (align=='^') cellStyle.setHAlignement(WPSCellFormat::HALIGN_CENTER);
+		else if (align=='\"') cellStyle.setHAlignement(WPSCellFormat::HALIGN_RIGHT);
 		else f << "#align=" << (int) align << ",";
 
 		int sSz=(int) libwps::readU8(m_input);
@@ -1480,22 +1552,23 @@ bool QuattroSpreadsheet::readCell()
 		case WKSContentListener::CellContent::C_NONE:
 			break;
 		case WKSContentListener::CellContent::C_TEXT:
-			cell.setFormat(WPSCell::F_TEXT);
+			cellStyle.setFormat(WPSCellFormat::F_TEXT);
 			break;
 		case WKSContentListener::CellContent::C_NUMBER:
 		case WKSContentListener::CellContent::C_FORMULA:
 		case WKSContentListener::CellContent::C_UNKNOWN:
 		default:
-			cell.setFormat(WPSCell::F_NUMBER);
+			cellStyle.setFormat(WPSCellFormat::F_NUMBER);
 			break;
 		}
 
 	}
+	cell.m_styleId=m_state->m_cellStyleManager.add(cellStyle);
 	m_input->seek(pos+sz, librevenge::RVNG_SEEK_SET);
 
 	std::string extra=f.str();
 	f.str("");
-	f << "Entries(CellContent):" << cell << "," << extra;
+	f << "Entries(CellContent):" << cell << cellStyle << "," << extra;
 
 	ascii().addPos(pos);
 	ascii().addNote(f.str().c_str());
@@ -1689,12 +1762,14 @@ bool QuattroSpreadsheet::readCell
 		}
 		else if (val==0xFFFF)
 		{
+#ifdef DEBUG
 			static bool first=true;
 			if (first)   // in general associated with a nan value, so maybe be normal
 			{
 				WPS_DEBUG_MSG(("QuattroSpreadsheet::readCell: find some ffff cell\n"));
 				first=false;
 			}
+#endif
 			ok = false;
 		}
 		else
@@ -1720,7 +1795,7 @@ bool QuattroSpreadsheet::readCell
 	instr.m_position[0]=Vec2i(pos[0],pos[1]);
 	instr.m_positionRelative[0]=Vec2b(!absolute[0],!absolute[1]);
 	if (hasSheetId && pos[2]!=sheetId)
-		instr.m_sheetName=m_state->getSheetName(pos[2]);
+		instr.m_sheetName=m_state->getSheetName(pos[2]).cstr();
 	return ok;
 }
 
@@ -1793,6 +1868,23 @@ bool QuattroSpreadsheet::readFormula(long endPos, Vec2i const &position, int she
 	int sz = (int) libwps::readU16(m_input);
 	if (endPos-pos-2 != sz) return false;
 
+	/* look first if the same formula has already been decoded in this sheet.
+	   Note: in the first version, the relative positions are stored modulo 0x100, so they can not be translated */
+	std::string data;
+	if (vers>1)
+	{
+		unsigned long numRead;
+		unsigned char const *buffer=m_input->read((unsigned long) sz, numRead);
+		if (buffer && numRead==(unsigned long) sz)
+		{
+			data.assign(reinterpret_cast<char const *>(buffer), size_t(sz));
+			// readCell keeps only the 8 low bits of the columns
+			if (m_state->m_formulaCache.get(data, sheetId, position, Vec2i(255,-1), formula))
+				return true;
+		}
+		m_input->seek(pos+2, librevenge::RVNG_SEEK_SET);
+	}
+
 	std::vector<WKSContentListener::FormulaInstruction> listCellsPos;
 	size_t actCellId=0;
 	int fieldPos[2]= {0,sz};
@@ -2114,17 +2206,21 @@ bool QuattroSpreadsheet::readFormula(long endPos, Vec2i const &position, int she
 			error="##extra data";
 			ascii().addDelimiter(m_input->tell(),'#');
 		}
+		else if (!data.empty() && error.empty())
+			m_state->m_formulaCache.insert(data, sheetId, position, formula);
 		return true;
 	}
 	else
 		error = "###stack problem";
 
+#ifdef DEBUG
 	static bool first = true;
 	if (first)
 	{
 		WPS_DEBUG_MSG(("QuattroSpreadsheet::readFormula: I can not read some formula\n"));
 		first = false;
 	}
+#endif
 
 	f.str("");
 	for (size_t i = 0; i < stack.size(); ++i)
@@ -2161,37 +2257,56 @@ void QuattroSpreadsheet::sendSpreadsheet(int sId)
 	m_listener->openSheet(sheet->convertInPoint(sheet->m_widthCols,76), librevenge::RVNG_POINT,
 	                      std::vector<int>(), m_state->getSheetName(sId));
 	sheet->compressRowHeights();
-	std::map<Vec2i, QuattroSpreadsheetInternal::Cell>::const_iterator it = sheet->m_positionToCellMap.begin();
+	WKSCellStore<QuattroSpreadsheetInternal::Cell>::Iterator it = sheet->m_cells.begin();
+	WKSCellStore<QuattroSpreadsheetInternal::Cell>::Iterator const itEnd = sheet->m_cells.end();
 	int prevRow = -1;
-	while (it != sheet->m_positionToCellMap.end())
+	while (it!=itEnd)
 	{
-		int row=it->first[1];
-		QuattroSpreadsheetInternal::Cell const &cell=(it++)->second;
-		if (row>prevRow+1)
+		int row=it.row();
+		if (m_mainParser.isAfterLastSelectedRow(row))
+			break;
+		while (row > prevRow+1)
 		{
-			while (row > prevRow+1)
+			if (prevRow != -1) m_listener->closeSheetRow();
+			int numRepeat;
+			float h=sheet->getRowHeight(prevRow+1, numRepeat);
+			if (row<prevRow+1+numRepeat)
+				numRepeat=row-1-prevRow;
+			m_listener->openSheetRow(h, librevenge::RVNG_POINT, false, numRepeat);
+			prevRow+=numRepeat;
+		}
+		// look for the following rows which are identical to this row
+		int numSameHeight;
+		float h=sheet->getRowHeight(row, numSameHeight);
+		int numRows=it.numRepeatedRows();
+		if (numRows>numSameHeight) numRows=numSameHeight;
+		numRows=m_mainParser.getSameSelectionSize(Vec2i(0,row), Vec2i(1,numRows))[1];
+		if (numRows<1) numRows=1;
+		if (prevRow != -1) m_listener->closeSheetRow();
+		m_listener->openSheetRow(h, librevenge::RVNG_POINT, false, numRows);
+		prevRow=row+numRows-1;
+		// send the first row cells by runs of identical cells
+		WKSCellStore<QuattroSpreadsheetInternal::Cell>::Iterator cIt=it;
+		while (cIt!=itEnd && cIt.row()==row)
+		{
+			Vec2i const pos=cIt.position();
+			int numCells=1;
+			// the cells read before finding the selected range
+			if (m_mainParser.isCellSelected(sId, pos))
 			{
-				if (prevRow != -1) m_listener->closeSheetRow();
-				int numRepeat;
-				float h=sheet->getRowHeight(prevRow+1, numRepeat);
-				if (row<prevRow+1+numRepeat)
-					numRepeat=row-1-prevRow;
-				m_listener->openSheetRow(h, librevenge::RVNG_POINT, false, numRepeat);
-				prevRow+=numRepeat;
+				numCells=m_mainParser.getSameSelectionSize(pos, Vec2i(cIt.numRepeatedCells(),1))[0];
+				if (numCells<1) numCells=1;
+				sendCellContent(*cIt, numCells);
 			}
+			for (int c=0; c<numCells; ++c) ++cIt;
 		}
-		if (row!=prevRow)
-		{
-			if (prevRow != -1) m_listener->closeSheetRow();
-			m_listener->openSheetRow(sheet->getRowHeight(++prevRow), librevenge::RVNG_POINT);
-		}
-		sendCellContent(cell);
+		it.nextRow(numRows);
 	}
 	if (prevRow!=-1) m_listener->closeSheetRow();
 	m_listener->closeSheet();
 }
 
-void QuattroSpreadsheet::sendCellContent(QuattroSpreadsheetInternal::Cell const &cell)
+void QuattroSpreadsheet::sendCellContent(QuattroSpreadsheetInternal::Cell const &cell, int numRepeated)
 {
 	if (m_listener.get() == 0L)
 	{
@@ -2199,60 +2314,77 @@ void QuattroSpreadsheet::sendCellContent(QuattroSpreadsheetInternal::Cell const
 		return;
 	}
 
-	libwps_tools_win::Font::Type fontType = cell.m_fontType;
-	m_listener->setFont(cell.getFont());
+	QuattroSpreadsheetInternal::CellStyleManager &styleManager=m_state->m_cellStyleManager;
+	int styleId=cell.m_styleId;
+	if (styleId<0)
+		styleId=styleManager.add(QuattroSpreadsheetInternal::Style(m_mainParser.getDefaultFontType()));
+	QuattroSpreadsheetInternal::Style const *style=styleManager.getFinalStyle(styleId);
+	if (!style) return;
+	libwps_tools_win::Font::Type fontType = style->m_fontType;
+	m_listener->setFont(style->getFont());
 
-	QuattroSpreadsheetInternal::Cell finalCell(cell);
-	WKSContentListener::CellContent &content=finalCell.m_content;
 	bool hasLICS=hasLICSCharacters();
-	for (size_t f=0; f < content.m_formula.size(); ++f)
+	bool hasTextFormula=false;
+	for (size_t f=0; f < cell.m_content.m_formula.size(); ++f)
 	{
-		if (content.m_formula[f].m_type!=WKSContentListener::FormulaInstruction::F_Text)
+		if (cell.m_content.m_formula[f].m_type!=WKSContentListener::FormulaInstruction::F_Text)
 			continue;
-		std::string &text=content.m_formula[f].m_content;
-		librevenge::RVNGString finalString("");
-		for (size_t c=0; c < text.length(); ++c)
+		hasTextFormula=true;
+		break;
+	}
+	if (hasTextFormula)
+	{
+		WKSContentListener::CellContent content(cell.m_content);
+		for (size_t f=0; f < content.m_formula.size(); ++f)
 		{
-			if (!hasLICS)
-				libwps::appendUnicode
-				((uint32_t)libwps_tools_win::Font::unicode((unsigned char)text[c],fontType), finalString);
-			else
-				libwps::appendUnicode
-				((uint32_t)libwps_tools_win::Font::LICSunicode((unsigned char)text[c],fontType), finalString);
+			if (content.m_formula[f].m_type!=WKSContentListener::FormulaInstruction::F_Text)
+				continue;
+			std::string &text=content.m_formula[f].m_content;
+			librevenge::RVNGString finalString("");
+			libwps_tools_win::Font::appendUnicodeString
+			((unsigned char const *)text.c_str(), (unsigned long) text.length(), fontType, finalString, hasLICS);
+			text=finalString.cstr();
 		}
-		text=finalString.cstr();
+		m_listener->openSheetCell(*style, styleId, cell.position(), content, numRepeated);
 	}
-	finalCell.updateFormat();
-	m_listener->openSheetCell(finalCell, content);
+	else
+		m_listener->openSheetCell(*style, styleId, cell.position(), cell.m_content, numRepeated);
 
 	if (cell.m_content.m_textEntry.valid())
 	{
 		m_input->seek(cell.m_content.m_textEntry.begin(), librevenge::RVNG_SEEK_SET);
+		unsigned long numRead;
+		unsigned char const *text=m_input->read((unsigned long) cell.m_content.m_textEntry.length(), numRead);
 		bool prevEOL=false;
-		while (!m_input->isEnd() && m_input->tell()<cell.m_content.m_textEntry.end())
+		unsigned long c=0;
+		while (text && c<numRead)
 		{
-			unsigned char c=(unsigned char) libwps::readU8(m_input);
-			if (c==0xd)
+			if (text[c]==0xd)
 			{
 				m_listener->insertEOL();
 				prevEOL=true;
+				++c;
+				continue;
 			}
-			else if (c==0xa)
+			if (text[c]==0xa)
 			{
 				if (!prevEOL)
 				{
 					WPS_DEBUG_MSG(("QuattroSpreadsheet::sendCellContent: find 0xa without 0xd\n"));
 				}
 				prevEOL=false;
+				++c;
+				continue;
 			}
-			else
-			{
-				if (!hasLICS)
-					m_listener->insertUnicode((uint32_t)libwps_tools_win::Font::unicode(c,fontType));
-				else
-					m_listener->insertUnicode((uint32_t)libwps_tools_win::Font::LICSunicode(c,fontType));
-				prevEOL=false;
-			}
+			// convert all the characters until the next end of line
+			unsigned long first=c;
+			while (c<numRead && text[c]!=0xd && text[c]!=0xa)
+				++c;
+			librevenge::RVNGString str;
+			libwps_tools_win::Font::appendUnicodeString(text+first, c-first, fontType, str, hasLICS, true);
+			if (!str.empty())
+				m_listener->insertUnicodeString(str);
+			prevEOL=false;
 		}
 	}
 	m_listener->closeSheetCell();
@@ -74,7 +74,7 @@ protected:
 	void sendSpreadsheet(int sId);
 
 	//! send the cell data
-	void sendCellContent(QuattroSpreadsheetInternal::Cell const &cell);
+	void sendCellContent(QuattroSpreadsheetInternal::Cell const &cell, int numRepeated=1);
 
 	//////////////////////// open/close //////////////////////////////
 
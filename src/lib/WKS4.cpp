@@ -201,12 +201,39 @@ bool State::getColor(int id, WPSColor &color) const
 	return true;
 }
 
+//! returns true if a record is not needed to create the output: the chart and the print settings zones
+static bool canSkipRecord(WKSRecord const &record)
+{
+	if (record.m_type!=0)
+		return false;
+#ifdef DEBUG
+	// in debug mode, all the records are read to check their content
+	return false;
+#else
+	switch (record.m_id)
+	{
+	case 0x1a: // print range
+	case 0x27: // print setup
+	case 0x28: // print margin
+	case 0x2a: // print borders
+	case 0x2d: // graph setting
+	case 0x2e: // named graph setting
+	case 0x30: // formatted/unformatted print
+	case 0x41: // graph record name
+		return true;
+	default:
+		break;
+	}
+	return false;
+#endif
+}
+
 }
 
 // constructor, destructor
 WKS4Parser::WKS4Parser(RVNGInputStreamPtr &input, WPSHeaderPtr &header,
                        libwps_tools_win::Font::Type encoding) :
-	WKSParser(input, header), m_listener(), m_state(), m_spreadsheetParser()
+	WKSParser(input, header), m_listener(), m_headerChecked(false), m_state(), m_spreadsheetParser()
 
 {
 	m_state.reset(new WKS4ParserInternal::State(encoding));
@@ -283,7 +310,8 @@ void WKS4Parser::parse(librevenge::RVNGSpreadsheetInterface *documentInterface)
 		throw (libwps::ParseException());
 	}
 
-	if (!checkHeader(0L, true)) throw(libwps::ParseException());
+	// the header may have already been checked by WPSDocument
+	if (!m_headerChecked && !checkHeader(0L, true)) throw(libwps::ParseException());
 
 	bool ok=false;
 	try
@@ -291,6 +319,8 @@ void WKS4Parser::parse(librevenge::RVNGSpreadsheetInterface *documentInterface)
 		ascii().setStream(input);
 		ascii().open("MN0");
 
+		// only index the main spreadsheet's cells, they are read and sent row by row when all the other zones are read
+		m_spreadsheetParser->setIndexCellsMode(true);
 		if (checkHeader(0L) && readZones())
 			m_listener=createListener(documentInterface);
 		if (m_listener)
@@ -298,10 +328,12 @@ void WKS4Parser::parse(librevenge::RVNGSpreadsheetInterface *documentInterface)
 			m_spreadsheetParser->setListener(m_listener);
 
 			m_listener->startDocument();
-			int numSheet=m_spreadsheetParser->getNumSpreadsheets();
-			if (numSheet==0) ++numSheet;
-			for (int i=0; i<numSheet; ++i)
-				m_spreadsheetParser->sendSpreadsheet(i);
+			if (isSelectedRangeUnknown())
+			{
+				WPS_DEBUG_MSG(("WKS4Parser::parse: can not find the selected range\n"));
+			}
+			else if (isSheetSelected(0))
+				m_spreadsheetParser->sendIndexedSpreadsheet();
 			m_listener->endDocument();
 			m_listener.reset();
 			ok = true;
@@ -472,6 +504,8 @@ bool WKS4Parser::checkHeader(WPSHeader *header, bool strict)
 		header->setKind(kind);
 		header->setNeedEncoding(needEncoding);
 	}
+	if (strict)
+		m_headerChecked=true;
 	return true;
 }
 
@@ -493,7 +527,25 @@ bool WKS4Parser::readZones()
 		return false;
 	}
 
-	while (readZone()) ;
+	// scan the record headers, then use the list to read or skip each record
+	std::vector<WKSRecord> records;
+	indexRecords(records);
+	for (size_t r=0; r<records.size(); ++r)
+	{
+		WKSRecord const &record=records[r];
+		if (record.m_pos!=input->tell())
+		{
+			// a zone may read the following records
+			if (record.m_pos<input->tell()) continue;
+			break;
+		}
+		if (WKS4ParserInternal::canSkipRecord(record))
+		{
+			input->seek(record.end(), librevenge::RVNG_SEEK_SET);
+			continue;
+		}
+		if (!readZone()) break;
+	}
 
 	//
 	// look for ending
@@ -1352,17 +1404,25 @@ void WKS4Parser::sendHeaderFooter(bool header)
 
 	std::string const &text=header ? m_state->m_headerString : m_state->m_footerString;
 	bool hasLICS=hasLICSCharacters();
-	for (size_t i=0; i < text.size(); ++i)
+	size_t i=0;
+	while (i < text.size())
 	{
 		unsigned char c=(unsigned char) text[i];
 		if (c==0xd)
 			m_listener->insertEOL();
-		else if (c==0xa)
+		if (c==0xd || c==0xa)
+		{
+			++i;
 			continue;
-		else if (!hasLICS)
-			m_listener->insertUnicode((uint32_t)libwps_tools_win::Font::unicode(c,fontType));
-		else
-			m_listener->insertUnicode((uint32_t)libwps_tools_win::Font::LICSunicode(c,fontType));
+		}
+		size_t first=i;
+		while (i < text.size() && text[i]!=char(0xd) && text[i]!=char(0xa))
+			++i;
+		librevenge::RVNGString str;
+		libwps_tools_win::Font::appendUnicodeString
+		((unsigned char const *)text.c_str()+first, (unsigned long)(i-first), fontType, str, hasLICS, true);
+		if (!str.empty())
+			m_listener->insertUnicodeString(str);
 	}
 
 }
@@ -1568,6 +1628,8 @@ bool WKS4Parser::readFieldName()
 		if (dim[0]!=dim[2] || dim[1]!=dim[3])
 			f << "<->" << dim[2] << "x" << dim[3];
 		f << ",";
+		if (!name.empty())
+			checkSelectedRange(name, 0, Box2i(Vec2i(dim[0],dim[1]),Vec2i(dim[2],dim[3])));
 	}
 	else
 		f << "col=" << dim[0] << ",";
@@ -150,6 +150,8 @@ protected:
 	bool readUnknown1();
 
 	shared_ptr<WKSContentListener> m_listener; /** the listener (if set)*/
+	//! a flag to know if the header has already been checked by checkHeader(header, true)
+	bool m_headerChecked;
 	//! the internal state
 	shared_ptr<WKS4ParserInternal::State> m_state;
 	//! the spreadsheet manager
@@ -25,6 +25,7 @@
 #include <cmath>
 #include <sstream>
 #include <limits>
+#include <map>
 #include <stack>
 
 #include <librevenge-stream/librevenge-stream.h>
@@ -33,7 +34,9 @@
 #include "libwps_tools_win.h"
 
 #include "WPSCell.h"
+#include "WKSCellStore.h"
 #include "WKSContentListener.h"
+#include "WKSFormulaCache.h"
 #include "WPSEntry.h"
 #include "WPSFont.h"
 
@@ -121,7 +124,7 @@ bool Style::operator==(Style const &st) const
 class StyleManager
 {
 public:
-	StyleManager() : m_stylesList() {}
+	StyleManager() : m_stylesList(), m_defaultStyleId(-1), m_alignedStyleIdMap() {}
 	//! add a new style and returns its id
 	int add(Style const &st, bool dosFile)
 	{
@@ -133,6 +136,8 @@ public:
 			}
 		}
 		m_stylesList.push_back(st);
+		// the font used when sending a cell is the cell format's font
+		m_stylesList.back().setFont(st.m_font);
 		return int(m_stylesList.size())-1;
 	}
 	//! returns the style with id
@@ -146,6 +151,35 @@ public:
 		style=m_stylesList[size_t(id)];
 		return true;
 	}
+	//! returns the style with id or 0
+	Style const *get(int id) const
+	{
+		if (id<0|| id >= (int) m_stylesList.size())
+			return 0;
+		return &m_stylesList[size_t(id)];
+	}
+	//! returns the id of a default style, creates it if needed
+	int getDefaultStyleId(libwps_tools_win::Font::Type type)
+	{
+		if (m_defaultStyleId<0)
+			m_defaultStyleId=add(Style(type), false);
+		return m_defaultStyleId;
+	}
+	//! returns the id of the style id with a different horizontal alignment, creates it if needed
+	int getAlignedStyleId(int id, WPSCellFormat::HorizontalAlignment align)
+	{
+		if (id<0|| id >= (int) m_stylesList.size() || m_stylesList[size_t(id)].hAlignement()==align)
+			return id;
+		std::pair<int,int> key(id,int(align));
+		std::map<std::pair<int,int>,int>::const_iterator it=m_alignedStyleIdMap.find(key);
+		if (it!=m_alignedStyleIdMap.end())
+			return it->second;
+		Style style(m_stylesList[size_t(id)]);
+		style.setHAlignement(align);
+		int newId=add(style, false);
+		m_alignedStyleIdMap[key]=newId;
+		return newId;
+	}
 	//! returns the number of style
 	int size() const
 	{
@@ -167,32 +201,42 @@ public:
 protected:
 	//! the styles
 	std::vector<Style> m_stylesList;
+	//! the default style id (or -1)
+	int m_defaultStyleId;
+	//! a map (style id, alignment) -> the style id with this alignment
+	std::map<std::pair<int,int>,int> m_alignedStyleIdMap;
 };
 
-//! a cellule of a WKS4 spreadsheet
-class Cell : public WPSCell
+/** a cellule of a WKS4 spreadsheet
+
+	\note the cell format is not stored in the cell, but in the style manager */
+class Cell
 {
 public:
 	/// constructor
-	Cell() : m_styleId(-1), m_hAlign(WPSCellFormat::HALIGN_DEFAULT), m_content() { }
+	Cell() : m_position(0,0), m_styleId(-1), m_hAlign(WPSCellFormat::HALIGN_DEFAULT), m_content() { }
 
 	//! operator<<
 	friend std::ostream &operator<<(std::ostream &o, Cell const &cell);
 
-	//! call when a cell must be send
-	bool send(WPSListenerPtr &/*listener*/)
+	//! returns the cell position
+	Vec2i const &position() const
 	{
-		WPS_DEBUG_MSG(("WKS4SpreadsheetInternal::Cell::send: must not be called\n"));
-		return false;
+		return m_position;
 	}
-
-	//! call when the content of a cell must be send
-	bool sendContent(WPSListenerPtr &/*listener*/)
+	//! sets the cell position
+	void setPosition(Vec2i const &pos)
 	{
-		WPS_DEBUG_MSG(("WKS4SpreadsheetInternal::Cell::sendContent: must not be called\n"));
-		return false;
+		m_position=pos;
+	}
+	//! returns true if the two cells have the same style and the same constant content
+	bool isRepeatedWith(Cell const &cell) const
+	{
+		return m_styleId==cell.m_styleId && m_hAlign==cell.m_hAlign && m_content.isSameConstant(cell.m_content);
 	}
 
+	//! the cell position
+	Vec2i m_position;
 	//! the style
 	int m_styleId;
 	//! the horizontal align (in dos file)
@@ -204,8 +248,7 @@ public:
 //! operator<<
 std::ostream &operator<<(std::ostream &o, Cell const &cell)
 {
-	o << reinterpret_cast<WPSCell const &>(cell)
-	  << cell.m_content << ",style=" << cell.m_styleId << ",";
+	o << "C" << cell.m_position << ":" << cell.m_content << ",style=" << cell.m_styleId << ",";
 	switch (cell.m_hAlign)
 	{
 	case WPSCellFormat::HALIGN_LEFT:
@@ -237,26 +280,22 @@ public:
 
 	//! a constructor
 	Spreadsheet(Type type=T_Spreadsheet, int id=0) : m_type(type), m_id(id), m_numCols(0), m_numRows(0),
-		m_widthCols(), m_rowHeightMap(), m_heightDefault(16), m_positionToCellMap(), m_lastCellPos(),
+		m_widthCols(), m_rowHeights(), m_heightDefault(16), m_cells(), m_lastCellPos(),
 		m_rowPageBreaksList() {}
 	//! return a cell corresponding to a spreadsheet, create one if needed
 	Cell &getCell(Vec2i const &pos)
 	{
-		if (m_positionToCellMap.find(pos)==m_positionToCellMap.end())
-		{
-			Cell cell;
+		bool isNew;
+		Cell &cell=m_cells.insert(pos, isNew);
+		if (isNew)
 			cell.setPosition(pos);
-			m_positionToCellMap[pos]=cell;
-		}
 		m_lastCellPos=pos;
-		return m_positionToCellMap.find(pos)->second;
+		return cell;
 	}
 	//! returns the last cell
 	Cell *getLastCell()
 	{
-		if (m_positionToCellMap.find(m_lastCellPos)==m_positionToCellMap.end())
-			return 0;
-		return &m_positionToCellMap.find(m_lastCellPos)->second;
+		return m_cells.find(m_lastCellPos);
 	}
 	//! set the columns size
 	void setColumnWidth(int col, int w=-1)
@@ -270,9 +309,9 @@ public:
 	//! returns the row size in point
 	float getRowHeight(int row) const
 	{
-		std::map<Vec2i,int>::const_iterator rIt=m_rowHeightMap.lower_bound(Vec2i(-1,row));
-		if (rIt!=m_rowHeightMap.end() && rIt->first[0]<=row && rIt->first[1]>=row)
-			return (float) rIt->second/20.f;
+		int const *height=m_rowHeights.find(row);
+		if (height)
+			return float(*height)/20.f;
 		return (float) m_heightDefault;
 	}
 	/** returns the height of a row in point and updated repeated row
@@ -281,11 +320,12 @@ public:
 	 */
 	float getRowHeight(int row, int &numRepeated) const
 	{
-		std::map<Vec2i,int>::const_iterator rIt=m_rowHeightMap.lower_bound(Vec2i(-1,row));
-		if (rIt!=m_rowHeightMap.end() && rIt->first[0]<=row && rIt->first[1]>=row)
+		int lastRow;
+		int const *height=m_rowHeights.find(row, &lastRow);
+		if (height)
 		{
-			numRepeated=rIt->first[1]-row+1;
-			return (float) rIt->second/20.f;
+			numRepeated=lastRow-row+1;
+			return float(*height)/20.f;
 		}
 		numRepeated=10000;
 		return (float) m_heightDefault;
@@ -294,44 +334,12 @@ public:
 	void setRowHeight(int row, int h)
 	{
 		if (h>=0)
-			m_rowHeightMap[Vec2i(row,row)]=h;
+			m_rowHeights.set(row, h);
 	}
 	//! try to compress the list of row height
 	void compressRowHeights()
 	{
-		std::map<Vec2i,int> oldMap=m_rowHeightMap;
-		m_rowHeightMap.clear();
-		std::map<Vec2i,int>::const_iterator rIt=oldMap.begin();
-		int actHeight=-1;
-		Vec2i actPos(0,-1);
-		int const defHeight=m_heightDefault*20; // conversion from point to TWIP
-		while (rIt!=oldMap.end())
-		{
-			// first check for not filled row
-			if (rIt->first[0]!=actPos[1]+1)
-			{
-				if (actHeight==defHeight)
-					actPos[1]=rIt->first[0]-1;
-				else
-				{
-					if (actPos[1]>=actPos[0])
-						m_rowHeightMap[actPos]=actHeight;
-					actHeight=defHeight;
-					actPos=Vec2i(actPos[1]+1, rIt->first[0]-1);
-				}
-			}
-			if (rIt->second!=actHeight)
-			{
-				if (actPos[1]>=actPos[0])
-					m_rowHeightMap[actPos]=actHeight;
-				actPos[0]=rIt->first[0];
-				actHeight=rIt->second;
-			}
-			actPos[1]=rIt->first[1];
-			++rIt;
-		}
-		if (actPos[1]>=actPos[0])
-			m_rowHeightMap[actPos]=actHeight;
+		m_rowHeights.compress(m_heightDefault*20);
 	}
 	//! convert the m_widthCols in a vector of of point size
 	static std::vector<float> convertInPoint(std::vector<int> const &list,
@@ -350,7 +358,7 @@ public:
 	//! returns true if the spreedsheet is empty
 	bool empty() const
 	{
-		return m_positionToCellMap.empty();
+		return m_cells.empty();
 	}
 	//! the spreadsheet type
 	Type m_type;
@@ -363,12 +371,12 @@ public:
 
 	/** the column size in TWIP (?) */
 	std::vector<int> m_widthCols;
-	/** the map Vec2i(min row, max row) to size in TWIP (?) */
-	std::map<Vec2i,int> m_rowHeightMap;
+	/** the row size in TWIP (?) */
+	WKSRowRuns<int> m_rowHeights;
 	/** the default row size in point */
 	int m_heightDefault;
-	/** a map cell to not empty cells */
-	std::map<Vec2i, Cell> m_positionToCellMap;
+	/** the not empty cells, stored row by row */
+	WKSCellStore<Cell> m_cells;
 	/** the last cell position */
 	Vec2i m_lastCellPos;
 	/** the list of row page break */
@@ -376,11 +384,25 @@ public:
 
 };
 
+//! the position of a zone which defines a cell (or a cell property) of the main spreadsheet
+struct CellRecord
+{
+	//! constructor
+	CellRecord(long pos, int row) : m_pos(pos), m_row(row)
+	{
+	}
+	//! the zone position in the file
+	long m_pos;
+	//! the cell row
+	int m_row;
+};
+
 //! the state of WKS4Spreadsheet
 struct State
 {
 	//! constructor
-	State() :  m_eof(-1), m_version(-1), m_hasLICSCharacters(-1), m_styleManager(), m_spreadsheetList(), m_spreadsheetStack()
+	State() :  m_eof(-1), m_version(-1), m_hasLICSCharacters(-1), m_styleManager(), m_spreadsheetList(), m_spreadsheetStack(),
+		m_indexCells(false), m_cellRecordsList(), m_firstRepeatedRow(-1), m_formulaCache()
 	{
 		pushNewSheet(shared_ptr<Spreadsheet>(new Spreadsheet(Spreadsheet::T_Spreadsheet, 0)));
 	}
@@ -455,6 +477,16 @@ struct State
 	std::vector<shared_ptr<Spreadsheet> > m_spreadsheetList;
 	//! the stack of spreadsheet id
 	std::stack<shared_ptr<Spreadsheet> > m_spreadsheetStack;
+	/** a flag to know if we only store the position of the main spreadsheet's cells zones
+		(the cells are read later by sendIndexedSpreadsheet) */
+	bool m_indexCells;
+	//! the list of the main spreadsheet's cells zones (if m_indexCells is set)
+	std::vector<CellRecord> m_cellRecordsList;
+	/** the first row of a run of identical rows which is not sent (or -1):
+		the rows m_firstRepeatedRow... are identical to the first row of the main spreadsheet */
+	int m_firstRepeatedRow;
+	//! the formulas already decoded
+	WKSFormulaCache m_formulaCache;
 };
 
 }
@@ -499,7 +531,28 @@ bool WKS4Spreadsheet::checkFilePosition(long pos)
 
 int WKS4Spreadsheet::getNumSpreadsheets() const
 {
-	return m_state->getMaximalSheet(WKS4SpreadsheetInternal::Spreadsheet::T_Spreadsheet)+1;
+	int num=m_state->getMaximalSheet(WKS4SpreadsheetInternal::Spreadsheet::T_Spreadsheet)+1;
+	if (num==0 && !m_state->m_cellRecordsList.empty())
+		num=1;
+	return num;
+}
+
+void WKS4Spreadsheet::setIndexCellsMode(bool indexCells)
+{
+	m_state->m_indexCells=indexCells;
+}
+
+bool WKS4Spreadsheet::isCellSkipped(Vec2i const &pos) const
+{
+	return m_state->m_spreadsheetStack.size()==1 && !m_mainParser.isCellSelected(0, pos);
+}
+
+bool WKS4Spreadsheet::indexCellZone(long pos, int row)
+{
+	if (!m_state->m_indexCells || m_state->m_spreadsheetStack.size()!=1)
+		return false;
+	m_state->m_cellRecordsList.push_back(WKS4SpreadsheetInternal::CellRecord(pos, row));
+	return true;
 }
 
 ////////////////////////////////////////////////////////////
@@ -575,12 +628,14 @@ bool WKS4Spreadsheet::readColumnSize()
 	{
 		if (col >= m_state->getActualSheet().m_numCols)
 		{
+#ifdef DEBUG
 			static bool first = true;
 			if (first)
 			{
 				first = false;
 				WPS_DEBUG_MSG(("WKS4Spreadsheet::readColumnSize: I must increase the number of columns\n"));
 			}
+#endif
 			f << "#col[inc],";
 		}
 		// checkme: unit in character(?) -> TWIP
@@ -614,12 +669,14 @@ bool WKS4Spreadsheet::readHiddenColumns()
 	{
 		int val=(int) libwps::readU8(m_input);
 		if (!val) continue;
+#ifdef DEBUG
 		static bool first=true;
 		if (first)
 		{
 			WPS_DEBUG_MSG(("WKS4Spreadsheet::readHiddenColumns: find some hidden col, ignored\n"));
 			first=false;
 		}
+#endif
 		// checkme
 		for (int j=0, depl=1; j<8; ++j, depl<<=1)
 		{
@@ -772,12 +829,14 @@ bool WKS4Spreadsheet::readMsWorksStyle()
 	{
 		f << ",#fontId = " << fl[3];
 
+#ifdef DEBUG
 		static bool first = true;
 		if (first)
 		{
 			WPS_DEBUG_MSG(("WKS4Spreadsheet::readMsWorksStyle: can not find a font\n"));
 			first = false;
 		}
+#endif
 	}
 	fl[3]=0;
 
@@ -1000,6 +1059,10 @@ bool WKS4Spreadsheet::readMsWorksDOSCellProperty()
 		WPS_DEBUG_MSG(("WKS4Spreadsheet::readMsWorksDOSCellProperty: cell property is too short\n"));
 		return false;
 	}
+	// the property of the last cell: ignore it if the cell is skipped, read it when the cell will be read
+	Vec2i const &cellPos=m_state->getActualSheet().m_lastCellPos;
+	if (isCellSkipped(cellPos) || indexCellZone(pos, cellPos[1]))
+		return true;
 
 	f << "Entries(CellDosProperty):";
 	WKS4SpreadsheetInternal::Cell *cell = m_state->getActualSheet().getLastCell();
@@ -1256,6 +1319,10 @@ bool WKS4Spreadsheet::readMsWorksDOSCellExtraProperty()
 		WPS_DEBUG_MSG(("WKS4Spreadsheet::readMsWorksDOSCellExtraProperty: cell property is too short\n"));
 		return false;
 	}
+	// the property of the last cell: ignore it if the cell is skipped, read it when the cell will be read
+	Vec2i const &cellPos=m_state->getActualSheet().m_lastCellPos;
+	if (isCellSkipped(cellPos) || indexCellZone(pos, cellPos[1]))
+		return true;
 
 	f << "Entries(CellDosExtra):";
 	WKS4SpreadsheetInternal::Cell *cell = m_state->getActualSheet().getLastCell();
@@ -1352,13 +1419,17 @@ bool WKS4Spreadsheet::readCell()
 	libwps::DebugStream f;
 
 	long pos = m_input->tell();
-	long type = libwps::read16(m_input);
+	int const vers=version();
+	bool dosFile = vers < 3;
+	// the header and the cell position
+	libwps::BufferedReader header(m_input, dosFile ? 9 : 10);
+	long type = header.read16();
 	if ((type != 0x545b) && (type < 0xc || type > 0x10))
 	{
 		WPS_DEBUG_MSG(("WKS4Spreadsheet::readCell: not a cell property\n"));
 		return false;
 	}
-	long sz = libwps::readU16(m_input);
+	long sz = header.readU16();
 	long endPos = pos+4+sz;
 
 	if (sz < 5)
@@ -1366,20 +1437,23 @@ bool WKS4Spreadsheet::readCell()
 		WPS_DEBUG_MSG(("WKS4Spreadsheet::readCell: cell def is too short\n"));
 		return false;
 	}
-	int const vers=version();
-	bool dosFile = vers < 3;
 	int format = 0xFF;
 	if (dosFile)
-		format = (int) libwps::readU8(m_input);
+		format = (int) header.readU8();
 	int cellPos[2];
-	cellPos[0]=(int) libwps::readU8(m_input);
-	int sheetId=(int) libwps::readU8(m_input);
-	cellPos[1]=(int) libwps::read16(m_input);
+	cellPos[0]=(int) header.readU8();
+	int sheetId=(int) header.readU8();
+	cellPos[1]=(int) header.read16();
 	if (cellPos[1] < 0)
 	{
 		WPS_DEBUG_MSG(("WKS4Spreadsheet::readCell: cell pos is bad\n"));
 		return false;
 	}
+	if (isCellSkipped(Vec2i(cellPos[0],cellPos[1])) || indexCellZone(pos, cellPos[1]))
+	{
+		m_state->getActualSheet().m_lastCellPos=Vec2i(cellPos[0],cellPos[1]);
+		return true;
+	}
 	if (sheetId)
 	{
 		WPS_DEBUG_MSG(("WKS4Spreadsheet::readCell: find unexpected sheet id\n"));
@@ -1388,18 +1462,20 @@ bool WKS4Spreadsheet::readCell()
 
 	WKS4SpreadsheetInternal::Cell &cell=m_state->getActualSheet().getCell(Vec2i(cellPos[0],cellPos[1]));
 	if (!dosFile)
-		cell.m_styleId = (int) libwps::read16(m_input);
+		cell.m_styleId = (int) header.read16();
 
 	if (type & 0xFF00)
 	{
 		if (dosFile)
 		{
+#ifdef DEBUG
 			static bool first = true;
 			if (first)
 			{
 				first = false;
 				WPS_DEBUG_MSG(("WKS4Spreadsheet::readCell: find type=%ld in dos version\n", type));
 			}
+#endif
 			f << "###";
 		}
 		f << "win[version],";
@@ -1450,12 +1526,13 @@ bool WKS4Spreadsheet::readCell()
 		cell.m_content.m_contentType=WKSContentListener::CellContent::C_TEXT;
 		long begText=m_input->tell(), endText=begText+dataSz;
 		std::string s("");
+		libwps::BufferedReader text(m_input, dataSz>0 ? (unsigned long) dataSz : 0);
 		for (int i = 0; i < dataSz; i++)
 		{
-			char c = (char) libwps::read8(m_input);
+			char c = (char) text.read8();
 			if (c=='\0')
 			{
-				endText=m_input->tell()-1;
+				endText=begText+i;
 				if (i == dataSz-1) break;
 				WPS_DEBUG_MSG(("WKS4Spreadsheet::readCell: cell content seems bad\n"));
 				f << "###";
@@ -1746,12 +1823,14 @@ bool WKS4Spreadsheet::readCell
 		}
 		else if (val==0xFFFF)
 		{
+#ifdef DEBUG
 			static bool first=true;
 			if (first)   // in general associated with a nan value, so maybe be normal
 			{
 				WPS_DEBUG_MSG(("WKS4Spreadsheet::readCell: find some ffff cell\n"));
 				first=false;
 			}
+#endif
 			ok = false;
 		}
 		else
@@ -1846,6 +1925,22 @@ bool WKS4Spreadsheet::readFormula(long endPos, Vec2i const &position,
 	int sz = (int) libwps::readU16(m_input);
 	if (endPos-pos-2 != sz) return false;
 
+	/* look first if the same formula has already been decoded.
+	   Note: in the first version, the relative positions are stored modulo 0x100, so they can not be translated */
+	std::string data;
+	if (vers>1 && sz>0)
+	{
+		unsigned long numRead;
+		unsigned char const *buffer=m_input->read((unsigned long) sz, numRead);
+		if (buffer && numRead==(unsigned long) sz)
+		{
+			data.assign(reinterpret_cast<char const *>(buffer), size_t(sz));
+			if (m_state->m_formulaCache.get(data, 0, position, Vec2i(-1,-1), formula))
+				return true;
+		}
+		m_input->seek(pos+2, librevenge::RVNG_SEEK_SET);
+	}
+
 	std::stringstream f;
 	std::vector<std::vector<WKSContentListener::FormulaInstruction> > stack;
 	bool ok = true;
@@ -2090,17 +2185,21 @@ bool WKS4Spreadsheet::readFormula(long endPos, Vec2i const &position,
 			error="##extra data";
 			ascii().addDelimiter(m_input->tell(),'#');
 		}
+		else if (!data.empty())
+			m_state->m_formulaCache.insert(data, 0, position, formula);
 		return true;
 	}
 	else
 		error = "###stack problem";
 
+#ifdef DEBUG
 	static bool first = true;
 	if (first)
 	{
 		WPS_DEBUG_MSG(("WKS4Spreadsheet::readFormula: I can not read some formula\n"));
 		first = false;
 	}
+#endif
 
 	f.str("");
 	for (size_t i = 0; i < stack.size(); ++i)
@@ -2281,58 +2380,117 @@ bool WKS4Spreadsheet::readReportClose()
 ////////////////////////////////////////////////////////////
 // send data
 ////////////////////////////////////////////////////////////
-void WKS4Spreadsheet::sendSpreadsheet(int sId)
+void WKS4Spreadsheet::sendIndexedSpreadsheet()
 {
 	if (!m_listener)
 	{
-		WPS_DEBUG_MSG(("WKS4Spreadsheet::sendSpreadsheet: I can not find the listener\n"));
+		WPS_DEBUG_MSG(("WKS4Spreadsheet::sendIndexedSpreadsheet: I can not find the listener\n"));
 		return;
 	}
-	shared_ptr<WKS4SpreadsheetInternal::Spreadsheet> sheet =
-	    m_state->getSheet(WKS4SpreadsheetInternal::Spreadsheet::T_Spreadsheet, sId);
-	if (!sheet)
-	{
-		if (sId==0)
-		{
-			WPS_DEBUG_MSG(("WKS4Spreadsheet::sendSpreadsheet: oops can not find the actual sheet\n"));
-		}
-		sheet.reset(new WKS4SpreadsheetInternal::Spreadsheet);
+	m_state->m_indexCells=false;
+	while (m_state->m_spreadsheetStack.size()>1)
+	{
+		WPS_DEBUG_MSG(("WKS4Spreadsheet::sendIndexedSpreadsheet: find some unclosed sheet\n"));
+		m_state->m_spreadsheetStack.pop();
+	}
+	WKS4SpreadsheetInternal::Spreadsheet &sheet=m_state->getActualSheet();
+	m_listener->openSheet(sheet.convertInPoint(sheet.m_widthCols,76), librevenge::RVNG_POINT,
+	                      std::vector<int>(), m_state->getSheetName(0));
+	sheet.compressRowHeights();
+
+	std::vector<WKS4SpreadsheetInternal::CellRecord> const &records=m_state->m_cellRecordsList;
+	size_t const numRecords=records.size();
+	/* minRows[i]: the minimal row of the zones i, i+1, ...
+
+	   the rows before minRows[i+1] can not be modified once the i-th zone
+	   is read, so they can be sent (and released). When the cells are
+	   stored row by row, this is the actual row; if not, the out of order
+	   rows are kept until all their cells are read. */
+	std::vector<int> minRows(numRecords+1, -1);
+	for (size_t i=numRecords; i>0; --i)
+	{
+		int row=records[i-1].m_row;
+		minRows[i-1]=(minRows[i]<0 || row<minRows[i]) ? row : minRows[i];
+	}
+	int prevRow = -1, sentRow = -1;
+	for (size_t i=0; i<numRecords; ++i)
+	{
+		long pos=records[i].m_pos;
+		m_input->seek(pos, librevenge::RVNG_SEEK_SET);
+		int type=(int) libwps::readU16(m_input);
+		m_input->seek(pos, librevenge::RVNG_SEEK_SET);
+		if (type==0x5402)
+			readMsWorksDOSCellProperty();
+		else if (type==0x541c)
+			readMsWorksDOSCellExtraProperty();
+		else
+			readCell();
+		int const minRow=minRows[i+1];
+		if (minRow<=sentRow+1 && minRow>=0) continue;
+		sendRows(sheet, minRow, prevRow);
+		sentRow = minRow<0 ? prevRow : minRow-1;
+		// if the last rows are identical, sendRows keeps the last one to compare it with the next rows
+		sheet.m_cells.removeRowsBefore(m_state->m_firstRepeatedRow>=0 ? sentRow : sentRow+1);
 	}
+	if (prevRow!=-1) m_listener->closeSheetRow();
+	m_listener->closeSheet();
+}
 
-	m_listener->openSheet(sheet->convertInPoint(sheet->m_widthCols,76), librevenge::RVNG_POINT,
-	                      std::vector<int>(), m_state->getSheetName(sId));
-	sheet->compressRowHeights();
-	std::map<Vec2i, WKS4SpreadsheetInternal::Cell>::const_iterator it = sheet->m_positionToCellMap.begin();
-	int prevRow = -1;
-	while (it!=sheet->m_positionToCellMap.end())
-	{
-		int row=it->first[1];
-		WKS4SpreadsheetInternal::Cell const &cell=(it++)->second;
-		if (row>prevRow+1)
+void WKS4Spreadsheet::sendRows(WKS4SpreadsheetInternal::Spreadsheet const &sheet, int maxRow, int &prevRow)
+{
+	WKSCellStore<WKS4SpreadsheetInternal::Cell>::Iterator it = sheet.m_cells.begin();
+	WKSCellStore<WKS4SpreadsheetInternal::Cell>::Iterator const itEnd =
+	    maxRow<0 ? sheet.m_cells.end() : sheet.m_cells.lowerBoundRow(maxRow);
+	while (it!=itEnd)
+	{
+		int row=it.row();
+		// the beginning of a run of identical rows kept by the previous call
+		int firstRow=row;
+		if (m_state->m_firstRepeatedRow>=0)
 		{
-			while (row > prevRow+1)
-			{
-				if (prevRow != -1) m_listener->closeSheetRow();
-				int numRepeat;
-				float h=sheet->getRowHeight(prevRow+1, numRepeat);
-				if (row<prevRow+1+numRepeat)
-					numRepeat=row-1-prevRow;
-				m_listener->openSheetRow(h, librevenge::RVNG_POINT, false, numRepeat);
-				prevRow+=numRepeat;
-			}
+			if (m_state->m_firstRepeatedRow<row)
+				firstRow=m_state->m_firstRepeatedRow;
+			m_state->m_firstRepeatedRow=-1;
 		}
-		if (row!=prevRow)
+		while (firstRow > prevRow+1)
 		{
 			if (prevRow != -1) m_listener->closeSheetRow();
-			m_listener->openSheetRow(sheet->getRowHeight(++prevRow), librevenge::RVNG_POINT);
+			int numRepeat;
+			float h=sheet.getRowHeight(prevRow+1, numRepeat);
+			if (firstRow<prevRow+1+numRepeat)
+				numRepeat=firstRow-1-prevRow;
+			m_listener->openSheetRow(h, librevenge::RVNG_POINT, false, numRepeat);
+			prevRow+=numRepeat;
+		}
+		// look for the following rows which are identical to this row
+		int numSameHeight;
+		float h=sheet.getRowHeight(firstRow, numSameHeight);
+		int numRows=it.numRepeatedRows(maxRow);
+		if (firstRow+numSameHeight<row+numRows)
+			numRows=firstRow+numSameHeight-row;
+		if (numRows<1) numRows=1;
+		if (maxRow>=0 && row+numRows==maxRow && row+numRows<firstRow+numSameHeight)
+		{
+			// the next rows may be identical, wait for them
+			m_state->m_firstRepeatedRow=firstRow;
+			return;
 		}
-		sendCellContent(cell);
+		if (prevRow != -1) m_listener->closeSheetRow();
+		m_listener->openSheetRow(h, librevenge::RVNG_POINT, false, row+numRows-firstRow);
+		prevRow=row+numRows-1;
+		// send the first row cells by runs of identical cells
+		WKSCellStore<WKS4SpreadsheetInternal::Cell>::Iterator cIt=it;
+		while (cIt!=itEnd && cIt.row()==row)
+		{
+			int numCells=cIt.numRepeatedCells();
+			sendCellContent(*cIt, numCells);
+			for (int c=0; c<numCells; ++c) ++cIt;
+		}
+		it.nextRow(numRows);
 	}
-	if (prevRow!=-1) m_listener->closeSheetRow();
-	m_listener->closeSheet();
 }
 
-void WKS4Spreadsheet::sendCellContent(WKS4SpreadsheetInternal::Cell const &cell)
+void WKS4Spreadsheet::sendCellContent(WKS4SpreadsheetInternal::Cell const &cell, int numRepeated)
 {
 	if (m_listener.get() == 0L)
 	{
@@ -2340,69 +2498,83 @@ void WKS4Spreadsheet::sendCellContent(WKS4SpreadsheetInternal::Cell const &cell)
 		return;
 	}
 
-	WKS4SpreadsheetInternal::Style cellStyle(m_mainParser.getDefaultFontType());
-	if (cell.m_styleId<0 || !m_state->m_styleManager.get(cell.m_styleId,cellStyle))
+	WKS4SpreadsheetInternal::StyleManager &styleManager=m_state->m_styleManager;
+	int styleId=cell.m_styleId;
+	if (!styleManager.get(styleId))
 	{
 		WPS_DEBUG_MSG(("WKS4Spreadsheet::sendCellContent: I can not find the cell style\n"));
+		styleId=styleManager.getDefaultStyleId(m_mainParser.getDefaultFontType());
 	}
 	if (version()<=2 && cell.m_hAlign!=WPSCellFormat::HALIGN_DEFAULT)
-		cellStyle.setHAlignement(cell.m_hAlign);
+		styleId=styleManager.getAlignedStyleId(styleId, cell.m_hAlign);
+	WKS4SpreadsheetInternal::Style const *cellStyle=styleManager.get(styleId);
+	if (!cellStyle) return;
 
-	libwps_tools_win::Font::Type fontType = cellStyle.m_fontType;
-	m_listener->setFont(cellStyle.m_font);
+	libwps_tools_win::Font::Type fontType = cellStyle->m_fontType;
+	m_listener->setFont(cellStyle->m_font);
 
-	WKS4SpreadsheetInternal::Cell finalCell(cell);
-	finalCell.WPSCellFormat::operator=(cellStyle);
-	finalCell.setFont(cellStyle.m_font);
-	WKSContentListener::CellContent content(cell.m_content);
 	bool hasLICS=hasLICSCharacters();
-	for (size_t f=0; f < content.m_formula.size(); ++f)
+	bool hasTextFormula=false;
+	for (size_t f=0; f < cell.m_content.m_formula.size(); ++f)
 	{
-		if (content.m_formula[f].m_type!=WKSContentListener::FormulaInstruction::F_Text)
+		if (cell.m_content.m_formula[f].m_type!=WKSContentListener::FormulaInstruction::F_Text)
 			continue;
-		std::string &text=content.m_formula[f].m_content;
-		librevenge::RVNGString finalString("");
-		for (size_t c=0; c < text.length(); ++c)
+		hasTextFormula=true;
+		break;
+	}
+	if (hasTextFormula)
+	{
+		WKSContentListener::CellContent content(cell.m_content);
+		for (size_t f=0; f < content.m_formula.size(); ++f)
 		{
-			if (!hasLICS)
-				libwps::appendUnicode
-				((uint32_t)libwps_tools_win::Font::unicode((unsigned char)text[c],fontType), finalString);
-			else
-				libwps::appendUnicode
-				((uint32_t)libwps_tools_win::Font::LICSunicode((unsigned char)text[c],fontType), finalString);
+			if (content.m_formula[f].m_type!=WKSContentListener::FormulaInstruction::F_Text)
+				continue;
+			std::string &text=content.m_formula[f].m_content;
+			librevenge::RVNGString finalString("");
+			libwps_tools_win::Font::appendUnicodeString
+			((unsigned char const *)text.c_str(), (unsigned long) text.length(), fontType, finalString, hasLICS);
+			text=finalString.cstr();
 		}
-		text=finalString.cstr();
+		m_listener->openSheetCell(*cellStyle, styleId, cell.position(), content, numRepeated);
 	}
-	m_listener->openSheetCell(finalCell, content);
+	else
+		m_listener->openSheetCell(*cellStyle, styleId, cell.position(), cell.m_content, numRepeated);
 
 	if (cell.m_content.m_textEntry.valid())
 	{
 		m_input->seek(cell.m_content.m_textEntry.begin(), librevenge::RVNG_SEEK_SET);
+		unsigned long numRead;
+		unsigned char const *text=m_input->read((unsigned long) cell.m_content.m_textEntry.length(), numRead);
 		bool prevEOL=false;
-		while (!m_input->isEnd() && m_input->tell()<cell.m_content.m_textEntry.end())
+		unsigned long c=0;
+		while (text && c<numRead)
 		{
-			unsigned char c=(unsigned char) libwps::readU8(m_input);
-			if (c==0xd)
+			if (text[c]==0xd)
 			{
 				m_listener->insertEOL();
 				prevEOL=true;
+				++c;
+				continue;
 			}
-			else if (c==0xa)
+			if (text[c]==0xa)
 			{
 				if (!prevEOL)
 				{
 					WPS_DEBUG_MSG(("WKS4Spreadsheet::sendCellContent: find 0xa without 0xd\n"));
 				}
 				prevEOL=false;
+				++c;
+				continue;
 			}
-			else
-			{
-				if (!hasLICS)
-					m_listener->insertUnicode((uint32_t)libwps_tools_win::Font::unicode(c,fontType));
-				else
-					m_listener->insertUnicode((uint32_t)libwps_tools_win::Font::LICSunicode(c,fontType));
-				prevEOL=false;
-			}
+			// convert all the characters until the next end of line
+			unsigned long first=c;
+			while (c<numRead && text[c]!=0xd && text[c]!=0xa)
+				++c;
+			librevenge::RVNGString str;
+			libwps_tools_win::Font::appendUnicodeString(text+first, c-first, fontType, str, hasLICS, true);
+			if (!str.empty())
+				m_listener->insertUnicodeString(str);
+			prevEOL=false;
 		}
 	}
 	m_listener->closeSheetCell();
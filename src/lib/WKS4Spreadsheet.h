@@ -35,7 +35,7 @@
 namespace WKS4SpreadsheetInternal
 {
 class Cell;
-class SpreadSheet;
+class Spreadsheet;
 struct State;
 }
 
@@ -70,11 +70,22 @@ protected:
 
 	//! returns the number of spreadsheet
 	int getNumSpreadsheets() const;
-	//! send the sId'th spreadsheet
-	void sendSpreadsheet(int sId);
-
-	//! send the cell data
-	void sendCellContent(WKS4SpreadsheetInternal::Cell const &cell);
+	/** sets/unsets the index mode: if set, the main spreadsheet's cells zones
+		are not read but only stored, they must be sent by sendIndexedSpreadsheet */
+	void setIndexCellsMode(bool indexCells);
+	/** reads the indexed main spreadsheet's cells zones and sends the rows as
+		soon as they are complete, so only the rows not yet complete are kept in memory */
+	void sendIndexedSpreadsheet();
+	/** sends the rows of a sheet which are before maxRow (or all the rows
+		if maxRow<0), the identical consecutive rows and cells are sent as
+		repeated rows and cells.
+
+		\note if maxRow>=0 and the last rows are identical, they are not sent
+		(so they can be merged with the next rows) */
+	void sendRows(WKS4SpreadsheetInternal::Spreadsheet const &sheet, int maxRow, int &prevRow);
+
+	//! send the cell data, the cell being repeated numRepeated times
+	void sendCellContent(WKS4SpreadsheetInternal::Cell const &cell, int numRepeated=1);
 
 	//////////////////////// open/close //////////////////////////////
 
@@ -93,6 +104,11 @@ protected:
 	//
 	//////////////////////// spread sheet //////////////////////////////
 
+	//! returns true if the cell is in the main sheet but not in the selected window of cells
+	bool isCellSkipped(Vec2i const &pos) const;
+	/** if the index mode is set and the actual sheet is the main sheet, stores the cell zone
+		position and returns true */
+	bool indexCellZone(long pos, int row);
 	//! reads a cell content data
 	bool readCell();
 	//! reads the result of a text formula
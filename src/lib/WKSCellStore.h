@@ -0,0 +1,474 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* libwps
+ * Version: MPL 2.0 / LGPLv2.1+
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * For minor contributions see the git repository.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU Lesser General Public License Version 2.1 or later
+ * (LGPLv2.1+), in which case the provisions of the LGPLv2.1+ are
+ * applicable instead of those above.
+ *
+ * For further information visit http://libwps.sourceforge.net
+ */
+
+#ifndef WKS_CELL_STORE_H
+#define WKS_CELL_STORE_H
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "libwps_internal.h"
+
+/* the containers used by the spreadsheet parsers to store the sheet's data
+   (WKSCellStore for the cells, WKSRowRuns for the rows' attributes) */
+
+/** a row-major store of the cells of a spreadsheet.
+
+	The rows are stored in a sparse sorted index and each row keeps its
+	cells in a dense vector sorted by column, so appending cells in file
+	order (i.e. row by row) is done in O(1) without any per-cell node.
+	The iteration is done row by row, and, in each row, column by column
+	(i.e. in the same order than a std::map<Vec2i,T>).
+
+	\note a reference returned by insert or find can be invalidated by the
+	next insertion in the same row.
+
+	\note the functions which look for repeated cells or rows need
+	T::isRepeatedWith(T const &) which must return true if two cells
+	can be sent as one repeated cell
+ */
+template <class T> class WKSCellStore
+{
+	//! a row of cells
+	struct Row
+	{
+		//! constructor
+		Row() : m_columns(), m_cells()
+		{
+		}
+		//! swaps the content of two rows
+		void swap(Row &row)
+		{
+			m_columns.swap(row.m_columns);
+			m_cells.swap(row.m_cells);
+		}
+		//! the sorted list of columns
+		std::vector<int> m_columns;
+		//! the cells corresponding to m_columns
+		std::vector<T> m_cells;
+	};
+public:
+	//! constructor
+	WKSCellStore() : m_rowIds(), m_rows(), m_numCells(0), m_lastRow(0)
+	{
+	}
+	//! returns true if the store contains no cell
+	bool empty() const
+	{
+		return m_numCells==0;
+	}
+	//! returns the number of cells
+	size_t size() const
+	{
+		return m_numCells;
+	}
+	//! removes all the cells
+	void clear()
+	{
+		m_rowIds.clear();
+		m_rows.clear();
+		m_numCells=0;
+		m_lastRow=0;
+	}
+	//! returns the cell at position pos (if it exists)
+	T *find(Vec2i const &pos)
+	{
+		size_t r;
+		if (!findRow(pos[1], r)) return 0;
+		Row &row=m_rows[r];
+		size_t c;
+		if (!findColumn(row, pos[0], c)) return 0;
+		return &row.m_cells[c];
+	}
+	//! returns the cell at position pos (if it exists)
+	T const *find(Vec2i const &pos) const
+	{
+		return const_cast<WKSCellStore<T> *>(this)->find(pos);
+	}
+	/** returns the cell at position pos, creates a copy of emptyCell if needed.
+
+		\note isNew is set to true if the cell is created */
+	T &insert(Vec2i const &pos, bool &isNew, T const &emptyCell=T())
+	{
+		int const col=pos[0], rowId=pos[1];
+		size_t r;
+		if (!findRow(rowId, r))
+		{
+			// usual case: a new last row
+			if (r==m_rows.size())
+			{
+				m_rows.push_back(Row());
+				m_rowIds.push_back(rowId);
+			}
+			else
+			{
+				m_rows.push_back(Row());
+				for (size_t i=m_rows.size()-1; i>r; --i)
+					m_rows[i].swap(m_rows[i-1]);
+				m_rowIds.insert(m_rowIds.begin()+long(r), rowId);
+			}
+			m_lastRow=r;
+		}
+		Row &row=m_rows[r];
+		size_t c;
+		isNew=!findColumn(row, col, c);
+		if (!isNew) return row.m_cells[c];
+		++m_numCells;
+		if (c==row.m_columns.size())
+		{
+			row.m_columns.push_back(col);
+			row.m_cells.push_back(emptyCell);
+			return row.m_cells.back();
+		}
+		row.m_columns.insert(row.m_columns.begin()+long(c), col);
+		row.m_cells.insert(row.m_cells.begin()+long(c), emptyCell);
+		return row.m_cells[c];
+	}
+	//! removes all the rows whose id is less than row (used to release the rows already sent)
+	void removeRowsBefore(int row)
+	{
+		size_t const numRemove=size_t(std::lower_bound(m_rowIds.begin(), m_rowIds.end(), row)-m_rowIds.begin());
+		if (numRemove==0) return;
+		for (size_t r=0; r<numRemove; ++r)
+		{
+			m_numCells-=m_rows.front().m_cells.size();
+			m_rows.pop_front();
+		}
+		m_rowIds.erase(m_rowIds.begin(), m_rowIds.begin()+long(numRemove));
+		m_lastRow=0;
+	}
+
+	//! a iterator on the cells: row by row then column by column
+	class Iterator
+	{
+	public:
+		//! constructor
+		Iterator(WKSCellStore<T> const &store, size_t row=0) : m_store(&store), m_row(row), m_cell(0)
+		{
+			skipEmptyRows();
+		}
+		//! returns the actual cell position
+		Vec2i position() const
+		{
+			return Vec2i(m_store->m_rows[m_row].m_columns[m_cell], m_store->m_rowIds[m_row]);
+		}
+		//! returns the actual row
+		int row() const
+		{
+			return m_store->m_rowIds[m_row];
+		}
+		//! returns the actual cell
+		T const &operator*() const
+		{
+			return m_store->m_rows[m_row].m_cells[m_cell];
+		}
+		//! returns the actual cell
+		T const *operator->() const
+		{
+			return &m_store->m_rows[m_row].m_cells[m_cell];
+		}
+		//! go to the next cell
+		Iterator &operator++()
+		{
+			if (++m_cell>=m_store->m_rows[m_row].m_cells.size())
+			{
+				++m_row;
+				m_cell=0;
+				skipEmptyRows();
+			}
+			return *this;
+		}
+		//! go to the first cell of the row which is numRows rows after the actual row index
+		Iterator &nextRow(int numRows=1)
+		{
+			if (numRows<=0) return *this;
+			m_row+=size_t(numRows);
+			if (m_row>m_store->m_rows.size())
+				m_row=m_store->m_rows.size();
+			m_cell=0;
+			skipEmptyRows();
+			return *this;
+		}
+		/** returns the number of cells in consecutive columns, beginning with
+			the actual cell, which can be sent as one repeated cell.
+
+			\note if maxCol>=0, only the cells whose column is less or equal to maxCol are considered */
+		int numRepeatedCells(int maxCol=-1) const
+		{
+			Row const &row=m_store->m_rows[m_row];
+			T const &cell=row.m_cells[m_cell];
+			size_t c=m_cell+1;
+			while (c<row.m_cells.size() && row.m_columns[c]==row.m_columns[c-1]+1 &&
+			        (maxCol<0 || row.m_columns[c]<=maxCol) && cell.isRepeatedWith(row.m_cells[c]))
+				++c;
+			return int(c-m_cell);
+		}
+		/** returns the number of consecutive rows, beginning with the
+			actual row, which contain the same cells, ie. cells in the
+			same columns which can be sent as one repeated cell.
+
+			\note if endRow>=0, only the rows before endRow are considered */
+		int numRepeatedRows(int endRow=-1) const
+		{
+			std::deque<Row> const &rows=m_store->m_rows;
+			std::vector<int> const &rowIds=m_store->m_rowIds;
+			Row const &row=rows[m_row];
+			size_t r=m_row+1;
+			while (r<rows.size() && rowIds[r]==rowIds[r-1]+1 && (endRow<0 || rowIds[r]<endRow))
+			{
+				Row const &newRow=rows[r];
+				if (newRow.m_columns!=row.m_columns) break;
+				bool same=true;
+				for (size_t c=0; c<row.m_cells.size(); ++c)
+				{
+					if (row.m_cells[c].isRepeatedWith(newRow.m_cells[c])) continue;
+					same=false;
+					break;
+				}
+				if (!same) break;
+				++r;
+			}
+			return int(r-m_row);
+		}
+		//! operator==
+		bool operator==(Iterator const &it) const
+		{
+			return m_store==it.m_store && m_row==it.m_row && m_cell==it.m_cell;
+		}
+		//! operator!=
+		bool operator!=(Iterator const &it) const
+		{
+			return !operator==(it);
+		}
+	protected:
+		//! skips the rows which do not contain any cell
+		void skipEmptyRows()
+		{
+			while (m_row<m_store->m_rows.size() && m_store->m_rows[m_row].m_cells.empty())
+				++m_row;
+		}
+		//! the store
+		WKSCellStore<T> const *m_store;
+		//! the actual row index
+		size_t m_row;
+		//! the actual cell index in the row
+		size_t m_cell;
+	};
+	//! returns the sorted list of rows which contain some cells
+	std::vector<int> const &rows() const
+	{
+		return m_rowIds;
+	}
+	//! returns an iterator on the first cell
+	Iterator begin() const
+	{
+		return Iterator(*this);
+	}
+	//! returns an iterator after the last cell
+	Iterator end() const
+	{
+		return Iterator(*this, m_rows.size());
+	}
+	//! returns an iterator on the first cell of the first row greater or equal to row
+	Iterator lowerBoundRow(int row) const
+	{
+		return Iterator(*this, size_t(std::lower_bound(m_rowIds.begin(), m_rowIds.end(), row)-m_rowIds.begin()));
+	}
+
+protected:
+	/** looks for a row index: returns true if the row exists, if not
+		sets r to the position where the row must be inserted */
+	bool findRow(int rowId, size_t &r)
+	{
+		size_t const numRows=m_rowIds.size();
+		// first check the last accessed row and the end of the list
+		if (m_lastRow<numRows && m_rowIds[m_lastRow]==rowId)
+		{
+			r=m_lastRow;
+			return true;
+		}
+		if (numRows==0 || m_rowIds[numRows-1]<rowId)
+		{
+			r=numRows;
+			return false;
+		}
+		r=size_t(std::lower_bound(m_rowIds.begin(), m_rowIds.end(), rowId)-m_rowIds.begin());
+		if (m_rowIds[r]!=rowId) return false;
+		m_lastRow=r;
+		return true;
+	}
+	/** looks for a column in a row: returns true if the column exists, if not
+		sets c to the position where the column must be inserted */
+	static bool findColumn(Row const &row, int col, size_t &c)
+	{
+		size_t const numCols=row.m_columns.size();
+		if (numCols==0 || row.m_columns[numCols-1]<col)
+		{
+			c=numCols;
+			return false;
+		}
+		c=size_t(std::lower_bound(row.m_columns.begin(), row.m_columns.end(), col)-row.m_columns.begin());
+		return row.m_columns[c]==col;
+	}
+
+	//! the sorted list of row ids
+	std::vector<int> m_rowIds;
+	//! the rows corresponding to m_rowIds
+	std::deque<Row> m_rows;
+	//! the number of cells
+	size_t m_numCells;
+	//! the last accessed row index
+	size_t m_lastRow;
+};
+
+/** a list of row attributes (height, style, ...) stored by runs of
+	consecutive rows with the same value.
+
+	Setting the rows in increasing order is done in O(1), finding the
+	value of a row is done by a binary search.
+
+	\note V must define operator== */
+template <class V> class WKSRowRuns
+{
+public:
+	//! a run of rows with the same value
+	struct Run
+	{
+		//! constructor
+		Run(int minRow, int maxRow, V const &value) : m_rows(minRow, maxRow), m_value(value)
+		{
+		}
+		//! the first and the last row
+		Vec2i m_rows;
+		//! the value
+		V m_value;
+	};
+	//! constructor
+	WKSRowRuns() : m_runs()
+	{
+	}
+	//! returns true if no value is defined
+	bool empty() const
+	{
+		return m_runs.empty();
+	}
+	//! removes all the values
+	void clear()
+	{
+		m_runs.clear();
+	}
+	//! returns the sorted list of runs
+	std::vector<Run> const &runs() const
+	{
+		return m_runs;
+	}
+	//! sets the value of a row
+	void set(int row, V const &value)
+	{
+		set(row, row, value);
+	}
+	//! sets the value of the rows minRow...maxRow
+	void set(int minRow, int maxRow, V const &value)
+	{
+		if (minRow>maxRow) return;
+		// usual case: the rows are defined in increasing order
+		if (m_runs.empty() || m_runs.back().m_rows[1]<minRow)
+		{
+			append(Run(minRow, maxRow, value));
+			return;
+		}
+		// find the first run which ends after minRow and the first run which begins after maxRow
+		size_t first=findRun(minRow), last=first;
+		while (last<m_runs.size() && m_runs[last].m_rows[0]<=maxRow)
+			++last;
+		std::vector<Run> newRuns;
+		if (m_runs[first].m_rows[0]<minRow)
+			newRuns.push_back(Run(m_runs[first].m_rows[0], minRow-1, m_runs[first].m_value));
+		newRuns.push_back(Run(minRow, maxRow, value));
+		if (last>first && m_runs[last-1].m_rows[1]>maxRow)
+			newRuns.push_back(Run(maxRow+1, m_runs[last-1].m_rows[1], m_runs[last-1].m_value));
+		m_runs.erase(m_runs.begin()+long(first), m_runs.begin()+long(last));
+		m_runs.insert(m_runs.begin()+long(first), newRuns.begin(), newRuns.end());
+		// finally merge the modified runs with their neighbours
+		size_t const begin=first>0 ? first-1 : 0;
+		size_t end=first+newRuns.size();
+		if (end>=m_runs.size()) end=m_runs.size()-1;
+		for (size_t i=end; i>begin; --i)
+		{
+			if (m_runs[i-1].m_rows[1]+1!=m_runs[i].m_rows[0] || !(m_runs[i-1].m_value==m_runs[i].m_value))
+				continue;
+			m_runs[i-1].m_rows[1]=m_runs[i].m_rows[1];
+			m_runs.erase(m_runs.begin()+long(i));
+		}
+	}
+	/** returns the value of a row or 0 if it is not defined.
+
+		\note if lastRow is set, it is updated to the last row which has the same value */
+	V const *find(int row, int *lastRow=0) const
+	{
+		size_t r=findRun(row);
+		if (r>=m_runs.size() || m_runs[r].m_rows[0]>row)
+			return 0;
+		if (lastRow) *lastRow=m_runs[r].m_rows[1];
+		return &m_runs[r].m_value;
+	}
+	//! fills the not defined rows from 0 to the last defined row with defValue
+	void compress(V const &defValue)
+	{
+		std::vector<Run> oldRuns;
+		oldRuns.swap(m_runs);
+		int nextRow=0;
+		for (size_t i=0; i<oldRuns.size(); ++i)
+		{
+			Run const &run=oldRuns[i];
+			if (run.m_rows[0]>nextRow)
+				append(Run(nextRow, run.m_rows[0]-1, defValue));
+			append(run);
+			nextRow=run.m_rows[1]+1;
+		}
+	}
+protected:
+	//! returns the index of the first run which ends after row
+	size_t findRun(int row) const
+	{
+		size_t min=0, max=m_runs.size();
+		while (min<max)
+		{
+			size_t mid=(min+max)/2;
+			if (m_runs[mid].m_rows[1]<row)
+				min=mid+1;
+			else
+				max=mid;
+		}
+		return min;
+	}
+	//! appends a run after the last run, merges it with the last run if possible
+	void append(Run const &run)
+	{
+		if (!m_runs.empty() && m_runs.back().m_rows[1]+1==run.m_rows[0] && m_runs.back().m_value==run.m_value)
+			m_runs.back().m_rows[1]=run.m_rows[1];
+		else
+			m_runs.push_back(run);
+	}
+	//! the sorted list of runs
+	std::vector<Run> m_runs;
+};
+
+#endif
+/* vim:set shiftwidth=4 softtabstop=4 noexpandtab: */
@@ -26,6 +26,7 @@
 #include <map>
 #include <sstream>
 #include <stdio.h>
+#include <string.h>
 
 #include <librevenge/librevenge.h>
 
@@ -59,6 +60,10 @@ struct WKSDocumentParsingState
 
 	/** a map cell's format to id */
 	std::map<WPSCellFormat,int,WPSCellFormat::CompareFormat> m_numberingIdMap;
+	/** the cell format properties corresponding to a parser format id */
+	std::vector<librevenge::RVNGPropertyList> m_cellFormatPropertiesList;
+	/** a flag to know if the cell format properties of a parser format id are computed */
+	std::vector<bool> m_cellFormatPropertiesComputed;
 
 private:
 	WKSDocumentParsingState(const WKSDocumentParsingState &);
@@ -66,7 +71,7 @@ private:
 };
 
 WKSDocumentParsingState::WKSDocumentParsingState(std::vector<WPSPageSpan> const &pageList) :
-	m_pageList(pageList), m_metaData(), m_isDocumentStarted(false), m_isHeaderFooterStarted(false), m_subDocuments(), m_numberingIdMap()
+	m_pageList(pageList), m_metaData(), m_isDocumentStarted(false), m_isHeaderFooterStarted(false), m_subDocuments(), m_numberingIdMap(), m_cellFormatPropertiesList(), m_cellFormatPropertiesComputed()
 {
 }
 
@@ -478,30 +483,37 @@ void WKSContentListener::_flushText()
 {
 	if (m_ps->m_textBuffer.len() == 0) return;
 
-	// when some many ' ' follows each other, call insertSpace
-	librevenge::RVNGString tmpText;
-	int numConsecutiveSpaces = 0;
-	librevenge::RVNGString::Iter i(m_ps->m_textBuffer);
-	for (i.rewind(); i.next();)
+	/* when some many ' ' follows each other, call insertSpace: look
+	   for the runs of spaces and send the text between them as slices
+	   (0x20 can not appear inside a UTF-8 multi-bytes character) */
+	char const *text = m_ps->m_textBuffer.cstr();
+	char const *const end = text+m_ps->m_textBuffer.size();
+	char const *first = text, *ptr = text;
+	std::string slice;
+	while (ptr < end)
 	{
-		if (*(i()) == 0x20) // this test is compatible with unicode format
-			numConsecutiveSpaces++;
-		else
-			numConsecutiveSpaces = 0;
-
-		if (numConsecutiveSpaces > 1)
+		char const *space = static_cast<char const *>(memchr(ptr, ' ', size_t(end-ptr)));
+		if (!space) break;
+		ptr = space+1;
+		if (ptr >= end || *ptr != ' ')
+			continue;
+		// keep the first space in the text, send the other ones as spaces
+		slice.assign(first, size_t(ptr-first));
+		m_documentInterface->insertText(librevenge::RVNGString(slice.c_str()));
+		while (ptr < end && *ptr == ' ')
 		{
-			if (tmpText.len() > 0)
-			{
-				m_documentInterface->insertText(tmpText);
-				tmpText.clear();
-			}
 			m_documentInterface->insertSpace();
+			++ptr;
 		}
-		else
-			tmpText.append(i());
+		first = ptr;
+	}
+	if (first == text)
+		m_documentInterface->insertText(m_ps->m_textBuffer);
+	else
+	{
+		slice.assign(first, size_t(end-first));
+		m_documentInterface->insertText(librevenge::RVNGString(slice.c_str()));
 	}
-	m_documentInterface->insertText(tmpText);
 	m_ps->m_textBuffer.clear();
 }
 
@@ -975,36 +987,90 @@ void WKSContentListener::openSheetCell(WPSCell const &cell, WKSContentListener::
 
 	librevenge::RVNGPropertyList propList;
 	cell.addTo(propList);
-	if (numRepeated>1)
-		propList.insert("table:number-columns-repeated", numRepeated);
-	cell.getFont().addTo(propList);
-	if (!cell.hasBasicFormat())
+	_addCellFormatProperties(propList, cell);
+	_openSheetCell(propList, cell, content, numRepeated);
+}
+
+void WKSContentListener::openSheetCell(WPSCellFormat const &format, int formatId, Vec2i const &pos, WKSContentListener::CellContent const &content, int numRepeated)
+{
+	if (!m_ps->m_isSheetRowOpened)
+	{
+		WPS_DEBUG_MSG(("WKSContentListener::openSheetCell: called with m_isSheetRowOpened=false\n"));
+		return;
+	}
+	if (m_ps->m_isSheetCellOpened)
 	{
-		int numberingId=-1;
-		std::stringstream name;
-		if (m_ds->m_numberingIdMap.find(cell)!=m_ds->m_numberingIdMap.end())
+		WPS_DEBUG_MSG(("WKSContentListener::openSheetCell: called with m_isSheetCellOpened=true\n"));
+		closeSheetCell();
+	}
+
+	librevenge::RVNGPropertyList propList;
+	if (formatId<0)
+	{
+		format.addTo(propList);
+		_addCellFormatProperties(propList, format);
+	}
+	else
+	{
+		std::vector<librevenge::RVNGPropertyList> &formatList=m_ds->m_cellFormatPropertiesList;
+		if (formatId>=int(formatList.size()))
 		{
-			numberingId=m_ds->m_numberingIdMap.find(cell)->second;
-			name << "Numbering" << numberingId;
+			formatList.resize(size_t(formatId)+1);
+			m_ds->m_cellFormatPropertiesComputed.resize(size_t(formatId)+1, false);
 		}
-		else
+		librevenge::RVNGPropertyList &formatProperties=formatList[size_t(formatId)];
+		if (!m_ds->m_cellFormatPropertiesComputed[size_t(formatId)])
 		{
-			numberingId=(int) m_ds->m_numberingIdMap.size();
-			name << "Numbering" << numberingId;
+			format.addTo(formatProperties);
+			_addCellFormatProperties(formatProperties, format);
+			m_ds->m_cellFormatPropertiesComputed[size_t(formatId)]=true;
+		}
+		propList=formatProperties;
+	}
+	propList.insert("librevenge:column", pos[0]);
+	propList.insert("librevenge:row", pos[1]);
+	propList.insert("table:number-columns-spanned", 1);
+	propList.insert("table:number-rows-spanned", 1);
+	_openSheetCell(propList, format, content, numRepeated);
+}
 
-			librevenge::RVNGPropertyList numList;
-			if (cell.getNumberingProperties(numList))
-			{
-				numList.insert("librevenge:name", name.str().c_str());
-				m_documentInterface->defineSheetNumberingStyle(numList);
-				m_ds->m_numberingIdMap[cell]=numberingId;
-			}
-			else
-				numberingId=-1;
+void WKSContentListener::_addCellFormatProperties(librevenge::RVNGPropertyList &propList, WPSCellFormat const &cell)
+{
+	cell.getFont().addTo(propList);
+	if (cell.hasBasicFormat())
+		return;
+	int numberingId=-1;
+	std::map<WPSCellFormat,int,WPSCellFormat::CompareFormat>::const_iterator it=m_ds->m_numberingIdMap.find(cell);
+	if (it!=m_ds->m_numberingIdMap.end())
+		numberingId=it->second;
+	else
+	{
+		numberingId=(int) m_ds->m_numberingIdMap.size();
+		librevenge::RVNGPropertyList numList;
+		if (cell.getNumberingProperties(numList))
+		{
+			librevenge::RVNGString name;
+			name.sprintf("Numbering%d", numberingId);
+			numList.insert("librevenge:name", name);
+			m_documentInterface->defineSheetNumberingStyle(numList);
+			m_ds->m_numberingIdMap[cell]=numberingId;
 		}
-		if (numberingId>=0)
-			propList.insert("librevenge:numbering-name", name.str().c_str());
+		else
+			numberingId=-1;
+	}
+	if (numberingId>=0)
+	{
+		librevenge::RVNGString name;
+		name.sprintf("Numbering%d", numberingId);
+		propList.insert("librevenge:numbering-name", name);
 	}
+}
+
+void WKSContentListener::_openSheetCell(librevenge::RVNGPropertyList &propList, WPSCellFormat const &cell,
+                                        WKSContentListener::CellContent const &content, int numRepeated)
+{
+	if (numRepeated>1)
+		propList.insert("table:number-columns-repeated", numRepeated);
 	// formula
 	if (content.m_formula.size())
 	{
@@ -1223,7 +1289,7 @@ librevenge::RVNGPropertyList WKSContentListener::FormulaInstruction::getProperty
 		pList.insert("librevenge:column-absolute",!m_positionRelative[0][0]);
 		pList.insert("librevenge:row-absolute",!m_positionRelative[0][1]);
 		if (!m_sheetName.empty())
-			pList.insert("librevenge:sheet-name",m_sheetName.cstr());
+			pList.insert("librevenge:sheet-name",m_sheetName.c_str());
 		break;
 	case F_CellList:
 		pList.insert("librevenge:type","librevenge-cells");
@@ -1236,7 +1302,7 @@ librevenge::RVNGPropertyList WKSContentListener::FormulaInstruction::getProperty
 		pList.insert("librevenge:end-column-absolute",!m_positionRelative[1][0]);
 		pList.insert("librevenge:end-row-absolute",!m_positionRelative[1][1]);
 		if (!m_sheetName.empty())
-			pList.insert("librevenge:sheet-name",m_sheetName.cstr());
+			pList.insert("librevenge:sheet-name",m_sheetName.c_str());
 		break;
 	default:
 		WPS_DEBUG_MSG(("WKSContentListener::FormulaInstruction::getPropertyList: unexpected type\n"));
@@ -1258,7 +1324,7 @@ std::ostream &operator<<(std::ostream &o, WKSContentListener::FormulaInstruction
 		if (!inst.m_positionRelative[0][1]) o << "$";
 		o << inst.m_position[0][1];
 		if (!inst.m_sheetName.empty())
-			o << "[" << inst.m_sheetName.cstr() << "]";
+			o << "[" << inst.m_sheetName << "]";
 	}
 	else if (inst.m_type==WKSContentListener::FormulaInstruction::F_CellList)
 	{
@@ -1272,7 +1338,7 @@ std::ostream &operator<<(std::ostream &o, WKSContentListener::FormulaInstruction
 			if (l==0) o << ":";
 		}
 		if (!inst.m_sheetName.empty())
-			o << "[" << inst.m_sheetName.cstr() << "]";
+			o << "[" << inst.m_sheetName << "]";
 	}
 	else if (inst.m_type==WKSContentListener::FormulaInstruction::F_Text)
 		o << "\"" << inst.m_content << "\"";
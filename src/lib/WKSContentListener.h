@@ -55,7 +55,7 @@ public:
 	{
 		enum What { F_Operator, F_Function, F_Cell, F_CellList, F_Long, F_Double, F_Text };
 		//! constructor
-		FormulaInstruction() : m_type(F_Text), m_content(""), m_longValue(0), m_doubleValue(0), m_sheetName("")
+		FormulaInstruction() : m_type(F_Text), m_content(), m_longValue(0), m_doubleValue(0), m_sheetName()
 		{
 			for (int i=0; i<2; ++i)
 			{
@@ -79,8 +79,11 @@ public:
 		Vec2i m_position[2];
 		//! relative cell position ( if type==F_Cell or F_CellList )
 		Vec2b m_positionRelative[2];
-		//! the sheet name
-		librevenge::RVNGString m_sheetName;
+		/** the sheet name (empty if the cell is in the formula's sheet)
+
+			\note a std::string is used as the instructions are often created and copied
+			when the formula is decoded, while an empty librevenge::RVNGString needs an allocation */
+		std::string m_sheetName;
 	};
 	//! small class use to define a sheet cell content
 	struct CellContent
@@ -118,6 +121,15 @@ public:
 		{
 			return m_textEntry.valid();
 		}
+		//! returns true if the two contents have no formula, no text and the same value
+		bool isSameConstant(CellContent const &content) const
+		{
+			if (!m_formula.empty() || !content.m_formula.empty() || hasText() || content.hasText())
+				return false;
+			if (m_contentType!=content.m_contentType || m_valueSet!=content.m_valueSet)
+				return false;
+			return !m_valueSet || (m_value>=content.m_value && m_value<=content.m_value);
+		}
 		/** conversion beetween double days since 1900 and date */
 		static bool double2Date(double val, int &Y, int &M, int &D);
 		/** conversion beetween double: second since 0:00 and time */
@@ -207,10 +219,24 @@ public:
 		\param content the cell content
 		\param numRepeated the cell columns repeatition*/
 	void openSheetCell(WPSCell const &cell, CellContent const &content, int numRepeated=1);
+	/** low level function to define a cell which has no span.
+		\param format the cell format (font, alignement, ...)
+		\param formatId a parser identifier of the format or -1. The
+		format properties are computed only once for each identifier, so a
+		parser must never use the same identifier for two different formats
+		\param pos the cell position
+		\param content the cell content
+		\param numRepeated the cell columns repeatition*/
+	void openSheetCell(WPSCellFormat const &format, int formatId, Vec2i const &pos, CellContent const &content, int numRepeated=1);
 	/** close a cell */
 	void closeSheetCell();
 
 protected:
+	//! opens a cell: propList must already contain the cell position, its spans and its format properties
+	void _openSheetCell(librevenge::RVNGPropertyList &propList, WPSCellFormat const &format, CellContent const &content, int numRepeated);
+	//! adds the cell format properties: font, numbering, ...
+	void _addCellFormatProperties(librevenge::RVNGPropertyList &propList, WPSCellFormat const &format);
+
 	void _openPageSpan();
 	void _closePageSpan();
 
@@ -0,0 +1,108 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* libwps
+ * Version: MPL 2.0 / LGPLv2.1+
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * For minor contributions see the git repository.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU Lesser General Public License Version 2.1 or later
+ * (LGPLv2.1+), in which case the provisions of the LGPLv2.1+ are
+ * applicable instead of those above.
+ *
+ * For further information visit http://libwps.sourceforge.net
+ */
+
+#ifndef WKS_FORMULA_CACHE_H
+#define WKS_FORMULA_CACHE_H
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "libwps_internal.h"
+
+#include "WKSContentListener.h"
+
+/** a cache of the formulas already decoded by a spreadsheet parser.
+
+	The formulas are indexed by their raw data and the sheet where they
+	are found. As the relative references are stored as offsets from the
+	formula's cell, a formula copied in a row or a column keeps the same
+	data: when it is found again, the decoded instructions are copied and
+	their relative references are translated to the new cell.
+ */
+class WKSFormulaCache
+{
+public:
+	//! a decoded formula
+	typedef std::vector<WKSContentListener::FormulaInstruction> Formula;
+
+	//! constructor
+	WKSFormulaCache() : m_formulaMap()
+	{
+	}
+	/** looks for a formula decoded from the same data in the same sheet and
+		moves it in the cell pos.
+
+		\return false if there is no such formula or if a translated reference
+		is negative or greater than maxCell (maxCell[dim]<0 means no limit),
+		i.e. when the parser must decode the data to obtain the same result */
+	bool get(std::string const &data, int sheetId, Vec2i const &pos, Vec2i const &maxCell, Formula &formula) const
+	{
+		std::map<Key, Entry>::const_iterator it=m_formulaMap.find(Key(sheetId, data));
+		if (it==m_formulaMap.end())
+			return false;
+		formula=it->second.m_formula;
+		Vec2i const decal=pos-it->second.m_position;
+		if (decal==Vec2i(0,0)) return true;
+		for (size_t i=0; i<formula.size(); ++i)
+		{
+			WKSContentListener::FormulaInstruction &instr=formula[i];
+			int numCells=instr.m_type==WKSContentListener::FormulaInstruction::F_Cell ? 1 :
+			             instr.m_type==WKSContentListener::FormulaInstruction::F_CellList ? 2 : 0;
+			for (int c=0; c<numCells; ++c)
+			{
+				for (int dim=0; dim<2; ++dim)
+				{
+					if (!instr.m_positionRelative[c][dim]) continue;
+					int &val=instr.m_position[c][dim];
+					val+=decal[dim];
+					if (val<0 || (maxCell[dim]>=0 && val>maxCell[dim]))
+						return false;
+				}
+			}
+		}
+		return true;
+	}
+	//! stores a formula decoded from data in the cell pos
+	void insert(std::string const &data, int sheetId, Vec2i const &pos, Formula const &formula)
+	{
+		m_formulaMap.insert(std::map<Key, Entry>::value_type(Key(sheetId, data), Entry(pos, formula)));
+	}
+
+protected:
+	//! the key: the sheet id and the formula's data
+	typedef std::pair<int, std::string> Key;
+	//! a decoded formula and the cell where it has been decoded
+	struct Entry
+	{
+		//! constructor
+		Entry(Vec2i const &pos, Formula const &formula) : m_position(pos), m_formula(formula)
+		{
+		}
+		//! the cell where the formula has been decoded
+		Vec2i m_position;
+		//! the decoded formula
+		Formula m_formula;
+	};
+	//! the map key to decoded formula
+	std::map<Key, Entry> m_formulaMap;
+};
+
+#endif /* WKS_FORMULA_CACHE_H */
+/* vim:set shiftwidth=4 softtabstop=4 noexpandtab: */
@@ -28,7 +28,7 @@
 #include "WKSParser.h"
 
 WKSParser::WKSParser(RVNGInputStreamPtr &input, WPSHeaderPtr &header) :
-	m_input(input), m_header(header), m_version(0), m_asciiFile()
+	m_input(input), m_header(header), m_version(0), m_parseOptions(), m_asciiFile()
 {
 	if (header)
 		m_version = header->getMajorVersion();
@@ -38,6 +38,75 @@ WKSParser::~WKSParser()
 {
 }
 
+Vec2i WKSParser::getSameSelectionSize(Vec2i const &pos, Vec2i const &size) const
+{
+	Vec2i res(size);
+	if (!m_parseOptions.m_rangeName.empty())
+		return res;
+	int const minPos[2]= {m_parseOptions.m_minColumn, m_parseOptions.m_minRow};
+	int const maxPos[2]= {m_parseOptions.m_maxColumn, m_parseOptions.m_maxRow};
+	for (int i=0; i<2; ++i)
+	{
+		if (pos[i]<minPos[i] && pos[i]+res[i]>minPos[i])
+			res[i]=minPos[i]-pos[i];
+		else if (maxPos[i]>=0 && pos[i]<=maxPos[i] && pos[i]+res[i]>maxPos[i]+1)
+			res[i]=maxPos[i]+1-pos[i];
+	}
+	return res;
+}
+
+bool WKSParser::isCellSelected(int sheetId, Vec2i const &pos) const
+{
+	if (!isSheetSelected(sheetId))
+		return false;
+	if (!m_parseOptions.m_rangeName.empty())
+		return true;
+	return pos[0]>=m_parseOptions.m_minColumn && (m_parseOptions.m_maxColumn<0 || pos[0]<=m_parseOptions.m_maxColumn) &&
+	       pos[1]>=m_parseOptions.m_minRow && (m_parseOptions.m_maxRow<0 || pos[1]<=m_parseOptions.m_maxRow);
+}
+
+void WKSParser::checkSelectedRange(std::string const &name, int sheetId, Box2i const &cells)
+{
+	if (m_parseOptions.m_rangeName.empty() || name!=m_parseOptions.m_rangeName.cstr())
+		return;
+	if (!isSheetSelected(sheetId))
+	{
+		WPS_DEBUG_MSG(("WKSParser::checkSelectedRange: the range %s is not in the selected sheet\n", name.c_str()));
+		// no sheet must be sent
+		m_parseOptions.m_sheetId=-2;
+	}
+	else
+		m_parseOptions.m_sheetId=sheetId;
+	m_parseOptions.m_minColumn=cells.min()[0];
+	m_parseOptions.m_maxColumn=cells.max()[0];
+	m_parseOptions.m_minRow=cells.min()[1];
+	m_parseOptions.m_maxRow=cells.max()[1];
+	m_parseOptions.m_rangeName.clear();
+}
+
+void WKSParser::indexRecords(std::vector<WKSRecord> &records, int maxType)
+{
+	records.clear();
+	RVNGInputStreamPtr input=getInput();
+	if (!input) return;
+	long const actPos=input->tell();
+	input->seek(0, librevenge::RVNG_SEEK_END);
+	long const endPos=input->tell();
+	long pos=actPos;
+	while (pos+4<=endPos && input->seek(pos, librevenge::RVNG_SEEK_SET)==0)
+	{
+		unsigned long numRead;
+		unsigned char const *header=input->read(4, numRead);
+		if (!header || numRead!=4) break;
+		int const type=int(header[1]);
+		long const size=long(header[2])+(long(header[3])<<8);
+		if (type>maxType || pos+4+size>endPos) break;
+		records.push_back(WKSRecord(pos, int(header[0]), type, size));
+		pos+=4+size;
+	}
+	input->seek(actPos, librevenge::RVNG_SEEK_SET);
+}
+
 RVNGInputStreamPtr WKSParser::getFileInput()
 {
 	if (!m_header) return RVNGInputStreamPtr();
@@ -25,17 +25,80 @@
 
 #include <map>
 #include <string>
+#include <vector>
+
+#include <libwps/libwps.h>
 
 #include "libwps_internal.h"
 
 #include "WPSDebug.h"
 
+/** a small structure used to store the position of a record of a spreadsheet file:
+	a 4 bytes header (the record id, its type and its data size) followed by the data */
+struct WKSRecord
+{
+	//! constructor
+	WKSRecord(long pos, int id, int type, long size) : m_pos(pos), m_id(id), m_type(type), m_size(size)
+	{
+	}
+	//! returns the position of the end of the record
+	long end() const
+	{
+		return m_pos+4+m_size;
+	}
+	//! the header position
+	long m_pos;
+	//! the record id
+	int m_id;
+	//! the record type
+	int m_type;
+	//! the data size
+	long m_size;
+};
+
 class WKSParser
 {
 public:
 	WKSParser(RVNGInputStreamPtr &input, WPSHeaderPtr &header);
 	virtual ~WKSParser();
 	virtual void parse(librevenge::RVNGSpreadsheetInterface *documentInterface) = 0;
+	//! sets the parsing options (must be called before parse)
+	void setParseOptions(libwps::WPSParseOptions const &options)
+	{
+		m_parseOptions=options;
+	}
+	//! returns the parsing options
+	libwps::WPSParseOptions const &getParseOptions() const
+	{
+		return m_parseOptions;
+	}
+	/** returns true if the sheetId'th sheet must be read and sent
+
+		\note m_sheetId=-1 selects all the sheets, while -2 selects no sheet (the selected range is in a skipped sheet) */
+	bool isSheetSelected(int sheetId) const
+	{
+		return m_parseOptions.m_sheetId==-1 || m_parseOptions.m_sheetId==sheetId;
+	}
+	/** returns true if the cell in the sheetId'th sheet must be read and sent
+
+		\note if the selected range's name is not yet found, returns true for all the cells of the selected sheet */
+	bool isCellSelected(int sheetId, Vec2i const &pos) const;
+	//! returns true if the rows after row must not be sent
+	bool isAfterLastSelectedRow(int row) const
+	{
+		return m_parseOptions.m_rangeName.empty() && m_parseOptions.m_maxRow>=0 && row>m_parseOptions.m_maxRow;
+	}
+	/** returns the number of columns col...col+numCols-1 and of rows
+		row...row+numRows-1 which are all inside or all outside the
+		selected window: used to limit the repeated cells and rows */
+	Vec2i getSameSelectionSize(Vec2i const &pos, Vec2i const &size) const;
+	//! returns true if a range's name is selected but the range is not yet found
+	bool isSelectedRangeUnknown() const
+	{
+		return !m_parseOptions.m_rangeName.empty();
+	}
+	//! checks if name is the selected range's name, if yes, restricts the parsing to its cells
+	void checkSelectedRange(std::string const &name, int sheetId, Box2i const &cells);
 
 protected:
 	RVNGInputStreamPtr &getInput()
@@ -60,6 +123,12 @@ protected:
 	{
 		return m_asciiFile;
 	}
+	/** scans the record headers which begin at the actual position in one sequential pass
+		and stores them in records. The scan stops on a record whose type is greater than
+		maxType or whose data goes after the end of the input.
+
+		\note the input position is not modified */
+	void indexRecords(std::vector<WKSRecord> &records, int maxType=0xff);
 
 private:
 	explicit WKSParser(const WKSParser &);
@@ -71,6 +140,8 @@ private:
 	WPSHeaderPtr m_header;
 	// the file version
 	int m_version;
+	//! the parsing options
+	libwps::WPSParseOptions m_parseOptions;
 	//! the debug file
 	libwps::DebugFile m_asciiFile;
 };
@@ -155,7 +155,7 @@ struct State
 WPS4Parser::WPS4Parser(RVNGInputStreamPtr &input, WPSHeaderPtr &header,
                        libwps_tools_win::Font::Type encoding) :
 	WPSParser(input, header),
-	m_listener(), m_graphParser(), m_textParser(), m_state()
+	m_listener(), m_graphParser(), m_textParser(), m_headerChecked(false), m_state()
 {
 	m_state.reset(new WPS4ParserInternal::State(encoding));
 	m_graphParser.reset(new WPS4Graph(*this));
@@ -291,8 +291,9 @@ shared_ptr<WPSContentListener> WPS4Parser::createListener(librevenge::RVNGTextIn
 	pageList.push_back(page1);
 	for (int i = 1; i < numPages; i++) pageList.push_back(ps);
 	m_state->m_numPages=numPages;
-	return shared_ptr<WPSContentListener>
-	       (new WPSContentListener(pageList, interface));
+	shared_ptr<WPSContentListener> listener(new WPSContentListener(pageList, interface));
+	listener->setTextOnly(getParseOptions().m_textOnly);
+	return listener;
 }
 
 void WPS4Parser::newPage(int number)
@@ -316,6 +317,7 @@ void WPS4Parser::newPage(int number)
 ////////////////////////////////////////////////////////////
 int WPS4Parser::readObject(RVNGInputStreamPtr input, WPSEntry const &entry)
 {
+	if (getParseOptions().m_skipEmbeddedObjects) return -1;
 	long actPos = input->tell();
 	int id=m_graphParser->readObject(input, entry);
 	input->seek(actPos, librevenge::RVNG_SEEK_SET);
@@ -383,7 +385,8 @@ void WPS4Parser::parse(librevenge::RVNGTextInterface *documentInterface)
 		WPS_DEBUG_MSG(("WPS4Parser::parse: does not find main ole\n"));
 		throw (libwps::ParseException());
 	}
-	if (!checkHeader(0, true))
+	// the header may have already been checked by WPSDocument
+	if (!m_headerChecked && !checkHeader(0, true))
 		throw (libwps::ParseException());
 	try
 	{
@@ -454,15 +457,23 @@ bool WPS4Parser::createOLEStructures()
 	RVNGInputStreamPtr input=getFileInput();
 	if (!input) return false;
 
-	if (!input->isStructured()) return true;
-	WPSOLEParser oleParser("MN0");
-	if (!oleParser.parse(input)) return false;
+	if (!input->isStructured() || getParseOptions().m_skipEmbeddedObjects) return true;
+	shared_ptr<WPSOLEParser> oleParser(new WPSOLEParser("MN0"));
+	// only index the objects here, they are decoded when they are sent
+	if (!oleParser->index(input)) return false;
 
-	m_graphParser->storeObjects(oleParser.getObjects(),oleParser.getObjectsId());
+	m_graphParser->storeObjects(oleParser);
 #ifdef DEBUG
 	// there can remain some embedded Works subdocument ( WKS, ... )
 	// with name MN0 and some unknown picture ole
-	std::vector<std::string> unparsed = oleParser.getNotParse();
+	// in debug mode, decode all the objects to find the unknown ole
+	std::vector<int> const &ids = oleParser->getIndexedObjectsId();
+	for (size_t i = 0; i < ids.size(); i++)
+	{
+		WPSOLEParserObject object;
+		oleParser->readObject(ids[i], object);
+	}
+	std::vector<std::string> unparsed = oleParser->getNotParse();
 
 	size_t numUnparsed = unparsed.size();
 
@@ -535,7 +546,7 @@ bool WPS4Parser::parseEntry(std::string const &name)
 }
 
 // basic function to check if the header is ok
-bool WPS4Parser::checkHeader(WPSHeader *header, bool /*strict*/)
+bool WPS4Parser::checkHeader(WPSHeader *header, bool strict)
 {
 	RVNGInputStreamPtr input = getInput();
 	if (!input || !checkFilePosition(0x100))
@@ -555,6 +566,8 @@ bool WPS4Parser::checkHeader(WPSHeader *header, bool /*strict*/)
 			header->setNeedEncoding(true);
 		header->setMajorVersion(firstOffset<4 ? 2 : firstOffset<6 ? 3 : 4);
 	}
+	if (strict)
+		m_headerChecked=true;
 	return true;
 }
 
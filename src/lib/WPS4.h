@@ -149,6 +149,8 @@ protected:
 	shared_ptr<WPS4Graph> m_graphParser;
 	//! the text parser
 	shared_ptr<WPS4Text> m_textParser;
+	//! a flag to know if the header has already been checked by checkHeader(header, true)
+	bool m_headerChecked;
 	//! the internal state
 	shared_ptr<WPS4ParserInternal::State> m_state;
 };
@@ -46,16 +46,20 @@ namespace WPS4GraphInternal
 //! Internal: the state of a WPS4Graph
 struct State
 {
-	State() : m_version(-1), m_numPages(0), m_objects(), m_objectsId(), m_parsed() {}
+	State() : m_version(-1), m_numPages(0), m_oleParser(), m_objects(), m_objectsId(), m_toDecode(), m_parsed() {}
 	//! the version
 	int m_version;
 	//! the number page
 	int m_numPages;
 
+	//! the ole parser which has indexed the OLE objects
+	shared_ptr<WPSOLEParser> m_oleParser;
 	//! the list of objects
 	std::vector<WPSOLEParserObject> m_objects;
 	//! the list of object's ids
 	std::vector<int> m_objectsId;
+	//! list of flags to know if the objects must be decoded by the ole parser
+	std::vector<bool> m_toDecode;
 	//! list of flags to know if the data are been sent to the listener
 	std::vector<bool> m_parsed;
 };
@@ -84,28 +88,44 @@ int WPS4Graph::numPages() const
 	return m_state->m_numPages;
 }
 
-void WPS4Graph::computePositions() const
+void WPS4Graph::computePositions()
 {
 	size_t numObject = m_state->m_objects.size();
-	m_state->m_numPages = numObject ? 1 : 0;
 	m_state->m_parsed.resize(numObject, false);
+	m_state->m_numPages = 0;
+	for (size_t i = 0; i < numObject; ++i)
+	{
+		if (!decodeObject(i)) continue;
+		m_state->m_numPages = 1;
+		break;
+	}
 }
 
 // update the positions and send data to the listener
-void WPS4Graph::storeObjects(std::vector<WPSOLEParserObject> const &objects,
-                             std::vector<int> const &ids)
+void WPS4Graph::storeObjects(shared_ptr<WPSOLEParser> oleParser)
 {
-	size_t numObject = objects.size();
-	if (numObject != ids.size())
+	if (!oleParser) return;
+	m_state->m_oleParser = oleParser;
+	std::vector<int> const &ids = oleParser->getIndexedObjectsId();
+	for (size_t i = 0; i < ids.size(); i++)
 	{
-		WPS_DEBUG_MSG(("WPS4Graph::storeObjects: unconsistent arguments\n"));
-		return;
+		m_state->m_objects.push_back(WPSOLEParserObject());
+		m_state->m_objectsId.push_back(ids[i]);
+		m_state->m_toDecode.push_back(true);
 	}
-	for (size_t i = 0; i < numObject; i++)
+}
+
+bool WPS4Graph::decodeObject(size_t id)
+{
+	if (id >= m_state->m_objects.size()) return false;
+	if (id < m_state->m_toDecode.size() && m_state->m_toDecode[id])
 	{
-		m_state->m_objects.push_back(objects[i]);
-		m_state->m_objectsId.push_back(ids[i]);
+		m_state->m_toDecode[id] = false;
+		WPSOLEParserObject object;
+		if (m_state->m_oleParser && m_state->m_oleParser->readObject(m_state->m_objectsId[id], object))
+			m_state->m_objects[id] = object;
 	}
+	return m_state->m_objects[id].m_data.size() != 0;
 }
 
 // send object
@@ -116,6 +136,7 @@ void WPS4Graph::sendObject(Vec2f const &sz, int id)
 		WPS_DEBUG_MSG(("WPS4Graph::sendObject: listener is not set\n"));
 		return;
 	}
+	if (m_mainParser.getParseOptions().m_skipEmbeddedObjects) return;
 
 	size_t numObject = m_state->m_objects.size();
 	int pos = -1;
@@ -130,6 +151,11 @@ void WPS4Graph::sendObject(Vec2f const &sz, int id)
 		WPS_DEBUG_MSG(("WPS4Graph::sendObject: can not find %d object\n", id));
 		return;
 	}
+	if (!decodeObject(size_t(pos)))
+	{
+		WPS_DEBUG_MSG(("WPS4Graph::sendObject: can not decode the %d object\n", id));
+		return;
+	}
 
 	m_state->m_parsed[size_t(pos)] = true;
 	WPSPosition posi(Vec2f(),sz);
@@ -148,6 +174,7 @@ void WPS4Graph::sendObjects(int page)
 		WPS_DEBUG_MSG(("WPS4Graph::sendObjects: listener is not set\n"));
 		return;
 	}
+	if (m_mainParser.getParseOptions().m_skipEmbeddedObjects) return;
 
 	size_t numObject = m_state->m_objects.size();
 #ifdef DEBUG
@@ -155,7 +182,7 @@ void WPS4Graph::sendObjects(int page)
 #endif
 	for (size_t g = 0; g < numObject; g++)
 	{
-		if (m_state->m_parsed[g]) continue;
+		if (m_state->m_parsed[g] || !decodeObject(g)) continue;
 #ifdef DEBUG
 		if (!firstSend)
 		{
@@ -195,11 +222,11 @@ int WPS4Graph::readObject(RVNGInputStreamPtr input, WPSEntry const &entry)
 	libwps::DebugStream f;
 	int numFind = 0;
 
-	librevenge::RVNGBinaryData pict;
+	librevenge::RVNGBinaryData pict, inlinePict;
 	WPSPosition pictPos;
-	int actConfidence = -100;
+	int actConfidence = -100, inlineConfidence = -100;
 	int oleId = -1;
-	bool replace = false;
+	bool replace = false, hasOle = false;
 
 	long lastPos;
 	while (1)
@@ -228,9 +255,11 @@ int WPS4Graph::readObject(RVNGInputStreamPtr input, WPSEntry const &entry)
 				if (m_state->m_objectsId[i] != oleId) continue;
 				if (0 > actConfidence)
 				{
+					// the OLE object will be decoded when it is sent
 					actConfidence = 0;
-					pict = m_state->m_objects[i].m_data;
+					pict = librevenge::RVNGBinaryData();
 					replace = false;
+					hasOle = true;
 				}
 			}
 			ascii().addPos(lastPos);
@@ -311,6 +340,12 @@ int WPS4Graph::readObject(RVNGInputStreamPtr input, WPSEntry const &entry)
 			actConfidence = confidence;
 			pict = data;
 			replace = true;
+			hasOle = false;
+		}
+		if (confidence > inlineConfidence && data.size())
+		{
+			inlineConfidence = confidence;
+			inlinePict = data;
 		}
 		if (actPictPos.naturalSize().x() > 0 && actPictPos.naturalSize().y() > 0)
 		{
@@ -346,8 +381,20 @@ int WPS4Graph::readObject(RVNGInputStreamPtr input, WPSEntry const &entry)
 		ascii().addNote("_");
 	}
 
-	if (!pict.size())
+	if (!pict.size() && !hasOle)
 		WPS_DEBUG_MSG(("WPS4Graph::readObject: Can not find picture for object: %d\n", oleId));
+	else if (hasOle)
+	{
+		// keep the inline picture if the OLE object can not be decoded
+		for (size_t i = 0; inlinePict.size() && i < m_state->m_objectsId.size(); i++)
+		{
+			if (m_state->m_objectsId[i] != oleId || i >= m_state->m_toDecode.size() || !m_state->m_toDecode[i])
+				continue;
+			m_state->m_objects[i].m_data = inlinePict;
+			m_state->m_objects[i].m_mime = "image/pict";
+		}
+		resId = oleId;
+	}
 	else if (replace)
 	{
 		bool found = false;
@@ -361,6 +408,8 @@ int WPS4Graph::readObject(RVNGInputStreamPtr input, WPSEntry const &entry)
 			}
 			m_state->m_objects[i].m_data = pict;
 			m_state->m_objects[i].m_mime = "image/pict";
+			if (i < m_state->m_toDecode.size())
+				m_state->m_toDecode[i] = false;
 			if (pictPos.naturalSize().x() > 0 && pictPos.naturalSize().y() > 0)
 			{
 				float scale = float(1.0/pictPos.getInvUnitScale(m_state->m_objects[i].m_position.unit()));
@@ -376,6 +425,7 @@ int WPS4Graph::readObject(RVNGInputStreamPtr input, WPSEntry const &entry)
 			object.m_position=pictPos;
 			m_state->m_objects.push_back(object);
 			m_state->m_objectsId.push_back(oleId);
+			m_state->m_toDecode.push_back(false);
 		}
 		resId = oleId;
 	}
@@ -32,7 +32,7 @@
 
 #include "WPSDebug.h"
 
-struct WPSOLEParserObject;
+class WPSOLEParser;
 class WPS4Parser;
 
 namespace WPS4GraphInternal
@@ -74,8 +74,11 @@ public:
 	 * In reality, as all the pictures seemed to be given with characters positions,
 	 * it does almost nothing, ie it only updates some internal bool to know the picture which
 	 * have been sent to the listener.
+	 *
+	 * \note the indexed objects are decoded until one can be decoded, so that
+	 * the undecodable objects do not create a picture page
 	 */
-	void computePositions() const;
+	void computePositions();
 
 	//! returns the number page where we find a picture. In practice, 0/1
 	int numPages() const;
@@ -84,9 +87,10 @@ protected:
 	//! returns the file version
 	int version() const;
 
-	//! store a list of object
-	void storeObjects(std::vector<WPSOLEParserObject> const &objects,
-	                  std::vector<int> const &ids);
+	//! stores the list of objects indexed by an ole parser, they will be decoded when they are sent
+	void storeObjects(shared_ptr<WPSOLEParser> oleParser);
+	//! decodes the id-th object if needed, returns true if it has some data
+	bool decodeObject(size_t id);
 
 	/** tries to find a picture in the zone pointed by \a entry
 	 * \return the object id or -1 if find nothing
@@ -83,6 +83,32 @@ namespace WPS4TextInternal
 {
 /** a enum used to type a zone */
 enum ZoneType { Z_String=-1, Z_Header=0, Z_Footer=1, Z_Main=2, Z_Note, Z_Bookmark, Z_DLink, Z_Unknown};
+/** Internal: a table to know if a character of a text zone has no special meaning, ie. if it
+	can be converted with its neighbours in one block: the control characters, the '&' of the
+	simple strings and the not breaking space of the old files are special */
+struct PlainCharacterTable
+{
+	//! constructor
+	PlainCharacterTable(bool simpleString, bool oldVersion)
+	{
+		for (int c=0; c<256; ++c)
+			m_isPlain[c]=c>=0x20 && (c!='&' || !simpleString) && (c!=0xca || !oldVersion);
+	}
+	//! returns true if the character is plain
+	bool isPlain(uint8_t c) const
+	{
+		return m_isPlain[c];
+	}
+	//! returns the position of the first special character of data in [first,last[ or last
+	size_t findSpecial(std::vector<unsigned char> const &data, size_t first, size_t last) const
+	{
+		while (first<last && m_isPlain[data[first]])
+			++first;
+		return first;
+	}
+	//! the plain flag of each character
+	bool m_isPlain[256];
+};
 /** Internal: class to store a font name: name with encoding type */
 struct FontName
 {
@@ -588,37 +614,54 @@ bool WPS4Text::readText(WPSEntry const &zone)
 			}
 		}
 	}
-	std::vector<DataFOD>::iterator FODs_iter = m_FODList.begin();
+	size_t const numFODs = m_FODList.size();
+	size_t actFOD = numFODs;
 
 	// update the property to correspond to the text
 	int prevFId = -1, prevPId = -1;
-	if (simpleString) FODs_iter = m_FODList.end();
-	else if (FODs_iter == m_FODList.end() && mainZone)
+	if (!simpleString && numFODs == 0 && mainZone)
 	{
 		WPS_DEBUG_MSG(("WPS4Text::readText: CAN NOT FIND any FODs for main zone, REVERT to basic string!!!!!!!!!\n"));
 		simpleString = true;
 	}
-
-	for (; FODs_iter!= m_FODList.end(); ++FODs_iter)
+	WPS4TextInternal::PlainCharacterTable const plainTable(simpleString, version()<=2);
+	if (!simpleString)
 	{
-		DataFOD const &fod = *(FODs_iter);
-		if (fod.m_pos >= zone.begin()) break;
-
-		int id = (*FODs_iter).m_id;
-		if (fod.m_type == DataFOD::ATTR_TEXT) prevFId = id;
-		else if (fod.m_type == DataFOD::ATTR_PARAG) prevPId = id;
+		actFOD = findFirstFOD(zone.begin());
+		// look backward for the last font and paragraph defined before the zone
+		bool findFont = false, findParagraph = false;
+		for (size_t i = actFOD; i > 0 && (!findFont || !findParagraph);)
+		{
+			DataFOD const &fod = m_FODList[--i];
+			if (fod.m_type == DataFOD::ATTR_TEXT && !findFont)
+			{
+				prevFId = fod.m_id;
+				findFont = true;
+			}
+			else if (fod.m_type == DataFOD::ATTR_PARAG && !findParagraph)
+			{
+				prevPId = fod.m_id;
+				findParagraph = true;
+			}
+		}
 	}
 
 	WPS4TextInternal::Font defaultFont(getDefaultFont());
 	WPS4TextInternal::Font actFont(defaultFont);
 	if (prevFId != -1)
 		actFont = m_state->m_fontList[size_t(prevFId)];
-	m_listener->setFont(actFont);
+	m_listener->setFont(actFont, prevFId);
+	int actFontId = prevFId;
 
-	if (prevPId != -1)
-		m_listener->setParagraph(m_state->m_paragraphList[size_t(prevPId)]);
-	else
-		m_listener->setParagraph(WPS4TextInternal::Paragraph());
+	// in text only mode, the paragraph properties are ignored
+	bool const textOnly = m_listener->isTextOnly();
+	if (!textOnly)
+	{
+		if (prevPId != -1)
+			m_listener->setParagraph(m_state->m_paragraphList[size_t(prevPId)], prevPId);
+		else
+			m_listener->setParagraph(WPS4TextInternal::Paragraph());
+	}
 
 	if (dlink)
 	{
@@ -627,7 +670,8 @@ bool WPS4Text::readText(WPSEntry const &zone)
 	}
 	bool first = true;
 	int actPage = 1;
-	for (; simpleString || FODs_iter!= m_FODList.end(); ++FODs_iter)
+	std::vector<unsigned char> buffer;
+	for (; simpleString || actFOD < numFODs; ++actFOD)
 	{
 		long actPos;
 		long lastPos;
@@ -643,28 +687,32 @@ bool WPS4Text::readText(WPSEntry const &zone)
 		}
 		else
 		{
-			DataFOD fod = *(FODs_iter);
-			actPos = first ? zone.begin() : fod.m_pos;
+			DataFOD const &fod = m_FODList[actFOD];
+			actPos = first ? zone.begin() : m_FODList.position(actFOD);
 			if (long(actPos) >= zone.end()) break;
 			first = false;
 
-			if (++FODs_iter!= m_FODList.end())
+			if (actFOD+1 < numFODs)
 			{
-				lastPos = (*FODs_iter).m_pos;
+				lastPos = m_FODList.position(actFOD+1);
 				if (long(lastPos) >= zone.end()) lastPos = zone.end();
 			}
 			else
 				lastPos = zone.end();
-			--FODs_iter;
 			int fId = fod.m_id;
 			switch (fod.m_type)
 			{
 			case DataFOD::ATTR_TEXT:
-				if (fId >= 0)
-					actFont = m_state->m_fontList[size_t(fId)];
-				else
-					actFont = defaultFont;
-				m_listener->setFont(actFont);
+				// only copy the font if it changes, the listener ignores the fonts set with the same id
+				if (fId != actFontId)
+				{
+					actFontId = fId;
+					if (fId >= 0)
+						actFont = m_state->m_fontList[size_t(fId)];
+					else
+						actFont = defaultFont;
+				}
+				m_listener->setFont(actFont, fId);
 #if DEBUG_FP
 				f << "[";
 				if (fId >= 0) f << "C" << fId << ":" << actFont << "]";
@@ -672,8 +720,10 @@ bool WPS4Text::readText(WPSEntry const &zone)
 #endif
 				break;
 			case DataFOD::ATTR_PARAG:
+				if (textOnly)
+					break;
 				if (fId >= 0)
-					m_listener->setParagraph(m_state->m_paragraphList[size_t(fId)]);
+					m_listener->setParagraph(m_state->m_paragraphList[size_t(fId)], fId);
 				else
 					m_listener->setParagraph(WPS4TextInternal::Paragraph());
 #if DEBUG_PP
@@ -712,24 +762,48 @@ bool WPS4Text::readText(WPSEntry const &zone)
 			}
 		}
 		m_input->seek(actPos, librevenge::RVNG_SEEK_SET);
+#ifdef DEBUG_WITH_FILES
 		std::string chaine("");
-		long len = lastPos-actPos;
-		for (long i = len; i>0; i--)
+#endif
+		// read the run in one block: the sub-documents and the objects sent below can move the input
+		unsigned long numRead=0;
+		unsigned char const *data=lastPos>actPos ? m_input->read((unsigned long)(lastPos-actPos), numRead) : 0;
+		buffer.assign(data, data ? data+numRead : data);
+		size_t const numChars=buffer.size();
+		uint32_t const *unicodeTable=libwps_tools_win::Font::unicodeTable(actFont.m_type);
+		for (size_t c=0; c<numChars; ++c)
 		{
-			long pos = m_input->tell();
-			uint8_t readVal = libwps::readU8(m_input);
+			long pos = actPos+long(c);
+			uint8_t readVal = buffer[c];
+			if (unicodeTable && plainTable.isPlain(readVal))
+			{
+				// convert the following plain characters in one block
+				size_t const firstC=c;
+				c=plainTable.findSpecial(buffer, c+1, numChars)-1;
+				librevenge::RVNGString text;
+				libwps_tools_win::Font::appendUnicodeString(&buffer[firstC], (unsigned long)(c+1-firstC), actFont.m_type, text, false, true);
+				m_listener->insertUnicodeString(text);
+#ifdef DEBUG_WITH_FILES
+				chaine.append(reinterpret_cast<char const *>(&buffer[firstC]), c+1-firstC);
+#endif
+				continue;
+			}
 			if (0x00 == readVal)
 			{
-				if (i != 1)
+				if (c+1 != numChars)
 				{
 					WPS_DEBUG_MSG(("WPS4Text::readText: find some unexpected 0 character\n"));
+#ifdef DEBUG_WITH_FILES
 					// probably an error, but we can ignore id
 					chaine += '#';
+#endif
 				}
 				continue;
 			}
 
+#ifdef DEBUG_WITH_FILES
 			chaine += char(readVal);
+#endif
 			switch (readVal)
 			{
 			case 0x01: // chart ?
@@ -840,9 +914,9 @@ bool WPS4Text::readText(WPSEntry const &zone)
 			case 0x1F: // optional hyphen
 				break;
 			case '&':
-				if (simpleString && pos+2 <= lastPos)
+				if (simpleString && c+1 < numChars)
 				{
-					int nextVal = libwps::readU8(m_input);
+					int nextVal = buffer[c+1];
 					bool done = true;
 					switch (nextVal)   // check me
 					{
@@ -869,10 +943,9 @@ bool WPS4Text::readText(WPSEntry const &zone)
 					}
 					if (done)
 					{
-						i--;
+						++c;
 						break;
 					}
-					m_input->seek(-1, librevenge::RVNG_SEEK_CUR);
 				}
 			default:
 				if (version()<=2)
@@ -891,7 +964,9 @@ bool WPS4Text::readText(WPSEntry const &zone)
 
 		if (simpleString) break;
 
+#ifdef DEBUG_WITH_FILES
 		f << "='"<<chaine<<"'";
+#endif
 		ascii().addPos(actPos);
 		ascii().addNote(f.str().c_str());
 	}
@@ -1047,7 +1122,7 @@ bool WPS4Text::readStructures()
 	std::vector<DataFOD> fdps;
 	for (size_t i = 0; i < numFDP; ++i)
 		readFDP(m_state->m_FDPCs[i], fdps, (FDPParser)&WPS4Text::readFont);
-	m_FODList = mergeSortedFODLists(fdps, m_FODList);
+	mergeSortedFODList(fdps, true);
 
 
 	/* read paragraphs FODs (FOrmatting Descriptors) */
@@ -1055,7 +1130,7 @@ bool WPS4Text::readStructures()
 	numFDP = m_state->m_FDPPs.size();
 	for (size_t i = 0; i < numFDP; ++i)
 		readFDP(m_state->m_FDPPs[i], fdps, (FDPParser)&WPS4Text::readParagraph);
-	m_FODList = mergeSortedFODLists(fdps, m_FODList);
+	mergeSortedFODList(fdps, true);
 
 	/* read the object structures */
 	pos = nameMultiMap.find("EOBJ");
@@ -1338,12 +1413,14 @@ bool WPS4Text::readFontNames(WPSEntry const &entry)
 			if (val >= ' ' && val <= 'z') s.append(char(val));
 			else
 			{
+#ifdef DEBUG
 				static bool first = true;
 				if (first)
 				{
 					first = false;
 					WPS_DEBUG_MSG(("WPS4Text:readFontNames find odd caracters in font name : %d\n", (int) val));
 				}
+#endif
 				f << "##oddC=" << (unsigned int) val << ", ";
 			}
 		}
@@ -2250,7 +2327,7 @@ bool WPS4Text::objectDataParser(long bot, long /*eot*/, int id,
 		obj.m_pos.setId(id);
 
 		int objectId = mainParser().readObject(m_input, obj.m_pos);
-		if (objectId == -1)
+		if (objectId == -1 && !mainParser().getParseOptions().m_skipEmbeddedObjects)
 		{
 			WPS_DEBUG_MSG(("WPS4Text::objectDataParser: can not find the object %d\n", id));
 		}
@@ -2492,7 +2569,7 @@ bool WPS4Text::readPLC
 		plc.m_name = zone.type();
 		plc.m_type = plcType.m_type;
 		m_state->m_plcList.push_back(plc);
-		m_FODList = mergeSortedFODLists(fods, m_FODList);
+		mergeSortedFODList(fods, true);
 		return true;
 	}
 
@@ -2557,7 +2634,7 @@ bool WPS4Text::readPLC
 		pos += dataSize;
 	}
 
-	if (ok) m_FODList = mergeSortedFODLists(fods, m_FODList);
+	if (ok) mergeSortedFODList(fods, true);
 	return true;
 }
 
@@ -409,8 +409,9 @@ shared_ptr<WPSContentListener> WPS8Parser::createListener(librevenge::RVNGTextIn
 	pageList.push_back(ps);
 	for (int i = 1; i < numPages; i++) pageList.push_back(ps);
 	m_state->m_numPages=numPages;
-	return shared_ptr<WPSContentListener>
-	       (new WPSContentListener(pageList, interface));
+	shared_ptr<WPSContentListener> listener(new WPSContentListener(pageList, interface));
+	listener->setTextOnly(getParseOptions().m_textOnly);
+	return listener;
 }
 
 void WPS8Parser::newPage(int number)
@@ -681,15 +682,23 @@ bool WPS8Parser::createOLEStructures()
 	RVNGInputStreamPtr input=getFileInput();
 	if (!input) return false;
 
-	if (!input->isStructured()) return true;
-	WPSOLEParser oleParser("CONTENTS");
-	if (!oleParser.parse(input)) return false;
+	if (!input->isStructured() || getParseOptions().m_skipEmbeddedObjects) return true;
+	shared_ptr<WPSOLEParser> oleParser(new WPSOLEParser("CONTENTS"));
+	// only index the objects here, they are decoded when they are sent
+	if (!oleParser->index(input)) return false;
 
-	m_graphParser->storeObjects(oleParser.getObjects(),oleParser.getObjectsId());
+	m_graphParser->storeObjects(oleParser);
 #ifdef DEBUG
 	// there can remain some embedded Works subdocument ( WKS, ... )
 	// with name MN0 and some unknown picture ole
-	std::vector<std::string> unparsed = oleParser.getNotParse();
+	// in debug mode, decode all the objects to find the unknown ole
+	std::vector<int> const &ids = oleParser->getIndexedObjectsId();
+	for (size_t i = 0; i < ids.size(); i++)
+	{
+		WPSOLEParserObject object;
+		oleParser->readObject(ids[i], object);
+	}
+	std::vector<std::string> unparsed = oleParser->getNotParse();
 
 	size_t numUnparsed = unparsed.size();
 
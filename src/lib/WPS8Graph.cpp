@@ -49,13 +49,15 @@ namespace WPS8GraphInternal
 struct Pict
 {
 	//! constructor
-	Pict() : m_data(), m_size(), m_mime("image/pict"), m_parsed(false) {}
+	Pict() : m_data(), m_size(), m_mime("image/pict"), m_toDecode(false), m_parsed(false) {}
 	//! the content
 	librevenge::RVNGBinaryData m_data;
 	//! the size of the picture (if known)
 	Vec2f m_size;
 	//! the mime type
 	std::string m_mime;
+	//! flag to know if the data must be decoded by the ole parser
+	bool m_toDecode;
 	//! flag to know if the data was send to the listener
 	bool m_parsed;
 };
@@ -90,7 +92,7 @@ struct Border
 //! Internal: the state of a WPS8Graph
 struct State
 {
-	State() : m_version(-1), m_numPages(0), m_borderMap(), m_ibgfMap(), m_pictMap(), m_oleMap() {}
+	State() : m_version(-1), m_numPages(0), m_borderMap(), m_ibgfMap(), m_pictMap(), m_oleMap(), m_oleParser() {}
 	//! the version
 	int m_version;
 	//! the number page
@@ -103,6 +105,8 @@ struct State
 	std::map<int, Pict> m_pictMap;
 	//! a map id -> OleData
 	std::map<int, Pict> m_oleMap;
+	//! the ole parser which has indexed the OLE objects
+	shared_ptr<WPSOLEParser> m_oleParser;
 };
 }
 
@@ -136,31 +140,47 @@ int WPS8Graph::numPages() const
 ////////////////////////////////////////////////////////////
 // update the positions and send data to the listener
 ////////////////////////////////////////////////////////////
-void WPS8Graph::computePositions() const
+void WPS8Graph::computePositions()
 {
-	m_state->m_numPages = (m_state->m_pictMap.size() || m_state->m_oleMap.size()) ? 1 : 0;
+	m_state->m_numPages = m_state->m_pictMap.empty() ? 0 : 1;
+	std::map<int, WPS8GraphInternal::Pict>::iterator it = m_state->m_oleMap.begin();
+	for (; !m_state->m_numPages && it != m_state->m_oleMap.end(); ++it)
+	{
+		if (decodeObject(it->first, it->second))
+			m_state->m_numPages = 1;
+	}
 }
 
-void WPS8Graph::storeObjects(std::vector<WPSOLEParserObject> const &objects,
-                             std::vector<int> const &ids)
+void WPS8Graph::storeObjects(shared_ptr<WPSOLEParser> oleParser)
 {
-	size_t numObject = objects.size();
-	if (numObject != ids.size())
-	{
-		WPS_DEBUG_MSG(("WPS8Graph::addObjects: unconsistent arguments\n"));
-		return;
-	}
-	for (size_t i = 0; i < numObject; i++)
+	if (!oleParser) return;
+	m_state->m_oleParser = oleParser;
+	std::vector<int> const &ids = oleParser->getIndexedObjectsId();
+	for (size_t i = 0; i < ids.size(); i++)
 	{
 		WPS8GraphInternal::Pict ole;
-		ole.m_data = objects[i].m_data;
-		float scale = 1.0f/objects[i].m_position.getInvUnitScale(librevenge::RVNG_INCH);
-		ole.m_size = scale*objects[i].m_position.naturalSize();
-		ole.m_mime = objects[i].m_mime;
+		ole.m_toDecode = true;
 		m_state->m_oleMap[ids[i]] = ole;
 	}
 }
 
+bool WPS8Graph::decodeObject(int id, WPS8GraphInternal::Pict &pict)
+{
+	if (pict.m_toDecode)
+	{
+		pict.m_toDecode = false;
+		WPSOLEParserObject object;
+		if (m_state->m_oleParser && m_state->m_oleParser->readObject(id, object))
+		{
+			pict.m_data = object.m_data;
+			float scale = 1.0f/object.m_position.getInvUnitScale(librevenge::RVNG_INCH);
+			pict.m_size = scale*object.m_position.naturalSize();
+			pict.m_mime = object.m_mime;
+		}
+	}
+	return pict.m_data.size() != 0;
+}
+
 ////////////////////////////////////////////////////////////
 // find all structures which correspond to the picture
 ////////////////////////////////////////////////////////////
@@ -212,6 +232,7 @@ bool WPS8Graph::sendObject(WPSPosition const &posi, int id, bool ole)
 		WPS_DEBUG_MSG(("WPS8Graph::sendObject: listener is not set\n"));
 		return false;
 	}
+	if (m_mainParser.getParseOptions().m_skipEmbeddedObjects) return true;
 	std::map<int, WPS8GraphInternal::Pict> &map = ole ? m_state->m_oleMap : m_state->m_pictMap;
 
 	std::map<int, WPS8GraphInternal::Pict>::iterator pos = map.find(id);
@@ -222,6 +243,11 @@ bool WPS8Graph::sendObject(WPSPosition const &posi, int id, bool ole)
 	}
 	WPS8GraphInternal::Pict &pict = pos->second;
 	pict.m_parsed = true;
+	if (!decodeObject(id, pict))
+	{
+		WPS_DEBUG_MSG(("WPS8Graph::sendObject: can not decode the %dth object\n", id));
+		return false;
+	}
 
 	Vec2f size(posi.size()), naturalSize;
 	if (size.x() <= 0 || size.y()<=0)
@@ -270,6 +296,7 @@ void WPS8Graph::sendObjects(int page, int)
 		WPS_DEBUG_MSG(("WPS8Graph::sendObjects: listener is not set\n"));
 		return;
 	}
+	if (m_mainParser.getParseOptions().m_skipEmbeddedObjects) return;
 
 #ifdef DEBUG
 	bool firstSend = false;
@@ -281,8 +308,9 @@ void WPS8Graph::sendObjects(int page, int)
 
 		while (pos != map.end())
 		{
+			int id = pos->first;
 			Pict &pict = pos++->second;
-			if (pict.m_parsed) continue;
+			if (pict.m_parsed || !decodeObject(id, pict)) continue;
 
 #ifdef DEBUG
 			if (!firstSend)
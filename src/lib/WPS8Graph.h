@@ -33,11 +33,12 @@
 
 #include "WPSDebug.h"
 
-struct WPSOLEParserObject;
+class WPSOLEParser;
 class WPS8Parser;
 
 namespace WPS8GraphInternal
 {
+struct Pict;
 struct State;
 }
 
@@ -70,8 +71,9 @@ public:
 	/** computes the final position of all found figures.
 	 *
 	 * In reality, as all the pictures seemed to be given with characters positions,
-	 * it does nothing*/
-	void computePositions() const;
+	 * it only looks if there is a picture or an indexed object which can be decoded
+	 * (the objects are decoded until one can be decoded) */
+	void computePositions();
 
 	//! returns the number page where we find a picture. In practice, 0/1
 	int numPages() const;
@@ -103,9 +105,10 @@ protected:
 	 * Actually, sends the eight consecutive pictures which form a border on 3 consecutive lines*/
 	void sendBorder(int borderId);
 
-	//! adds a list of objects with given ids in the ole lists
-	void storeObjects(std::vector<WPSOLEParserObject> const &objects,
-	                  std::vector<int> const &ids);
+	//! adds the objects indexed by an ole parser in the ole lists, they will be decoded when they are sent
+	void storeObjects(shared_ptr<WPSOLEParser> oleParser);
+	//! decodes the object if needed, returns true if it has some data
+	bool decodeObject(int id, WPS8GraphInternal::Pict &pict);
 
 	//! finds all entries which correspond to some pictures, parses them and stores data
 	bool readStructures(RVNGInputStreamPtr input);
@@ -75,6 +75,12 @@ namespace WPS8TextInternal
  */
 enum PLCType { BTE=0, TCD, STRS, OBJECT, TOKEN, BMKT, Unknown};
 
+//! returns true if a character is not a special character, ie. if it can be converted by appendUTF16LE
+static bool isBasicCharacter(uint16_t c)
+{
+	return c>=0x1c && c!=0x1e && c!=0x1f && c!=0x23 && c!=0xfffc && c!=0xfffd;
+}
+
 /** Internal: class to store a field definition (BKMT) */
 struct Bookmark
 {
@@ -662,18 +668,31 @@ void WPS8Text::readText(WPSEntry const &entry)
 		std::vector<int> colSize(size_t(numColumns), w);
 		m_listener->openSection(colSize, librevenge::RVNG_POINT);
 	}
-	int lastCId=-1, lastPId=-1; /* -2: nothing, -1: send default, >= 0: readId */
-	std::vector<DataFOD>::iterator plcIt =	m_FODList.begin();
-	while (plcIt != m_FODList.end() && plcIt->m_pos < entry.begin())
-	{
-		DataFOD const &plc = *(plcIt++);
-		if (plc.m_type==DataFOD::ATTR_TEXT)
+	// in text only mode, the fonts are only read to find the fields, notes and objects and the paragraphs are ignored
+	bool const textOnly = m_listener->isTextOnly();
+	int lastCId=-1, lastPId=textOnly ? -2 : -1; /* -2: nothing, -1: send default, >= 0: readId */
+	size_t const numFODs = m_FODList.size();
+	size_t actFOD = findFirstFOD(entry.begin());
+	// look backward for the last font and paragraph defined before the zone
+	bool findFont = false, findParagraph = textOnly;
+	for (size_t i = actFOD; i > 0 && (!findFont || !findParagraph);)
+	{
+		DataFOD const &plc = m_FODList[--i];
+		if (plc.m_type==DataFOD::ATTR_TEXT && !findFont)
+		{
 			lastCId = plc.m_id;
-		else if (plc.m_type==DataFOD::ATTR_PARAG)
+			findFont = true;
+		}
+		else if (plc.m_type==DataFOD::ATTR_PARAG && !findParagraph)
+		{
 			lastPId = plc.m_id;
+			findParagraph = true;
+		}
 	}
 	int actualPage = 1;
 	WPS8TextStyle::FontData special;
+	std::vector<unsigned char> buffer;
+	std::string text;
 	input->seek(entry.begin(), librevenge::RVNG_SEEK_SET);
 	while (!input->isEnd())
 	{
@@ -683,20 +702,21 @@ void WPS8Text::readText(WPSEntry const &entry)
 		if (pos+1 >= entry.end())
 			break;
 		long finalPos = entry.end();
-		for (; plcIt != m_FODList.end(); ++plcIt)
+		for (; actFOD < numFODs; ++actFOD)
 		{
-			DataFOD const &plc = *plcIt;
-			if (plc.m_pos < pos)
+			long const fodPos = m_FODList.position(actFOD);
+			if (fodPos < pos)
 			{
 				WPS_DEBUG_MSG(("WPS8Text::readText: ### problem with pos\n"));
 				continue;
 			}
-			if (plc.m_pos > pos)
+			if (fodPos > pos)
 			{
-				if (plc.m_pos < finalPos)
-					finalPos = plc.m_pos;
+				if (fodPos < finalPos)
+					finalPos = fodPos;
 				break;
 			}
+			DataFOD const &plc = m_FODList[actFOD];
 			switch (plc.m_type)
 			{
 			case DataFOD::ATTR_TEXT:
@@ -706,11 +726,16 @@ void WPS8Text::readText(WPSEntry const &entry)
 					f << "[C_]";
 				else
 					f << "[C" << plc.m_id << "]";
-				m_styleParser->sendFont(plc.m_id, special);
+				if (textOnly)
+					m_styleParser->getFontData(plc.m_id, special);
+				else
+					m_styleParser->sendFont(plc.m_id, special);
 				break;
 			}
 			case DataFOD::ATTR_PARAG:
 			{
+				if (textOnly)
+					break;
 				lastPId = -2;
 				if (plc.m_id < 0)
 					f << "[P_]";
@@ -754,7 +779,10 @@ void WPS8Text::readText(WPSEntry const &entry)
 		}
 		if (lastCId >= -1)
 		{
-			m_styleParser->sendFont(lastCId, special);
+			if (textOnly)
+				m_styleParser->getFontData(lastCId, special);
+			else
+				m_styleParser->sendFont(lastCId, special);
 			lastCId = -2;
 		}
 		if (lastPId >= -1)
@@ -770,136 +798,175 @@ void WPS8Text::readText(WPSEntry const &entry)
 		}
 		while (!input->isEnd())
 		{
-			if (input->tell()+1 >= finalPos) break;
-
-			uint16_t readVal = libwps::readU16(input);
-			if (0x00 == readVal)
-				continue;
-			f << (char) readVal;
-
-			switch (readVal)
+			long actPos = input->tell();
+			if (actPos+1 >= finalPos) break;
+
+			/* read all the characters until the next attribute change: the
+			   data are copied because the listener can read the input */
+			unsigned long numRead;
+			unsigned char const *data = input->read((unsigned long)(finalPos-actPos), numRead);
+			if (!data || numRead < 2) break;
+			buffer.assign(data, data+numRead);
+			unsigned long const numUnits = numRead/2;
+			unsigned long u = 0;
+			while (u < numUnits)
 			{
-			case 0x9:
-				m_listener->insertTab();
-				break;
-
-			case 0x0A:
-				m_listener->insertEOL(true);
-				break;
-
-			case 0x0C:
-				if (mainZone)
-					mainParser().newPage(++actualPage);
-				else
+				uint16_t readVal = WPS_LE_GET_GUINT16(&buffer[2*u]);
+				if (WPS8TextInternal::isBasicCharacter(readVal))
 				{
-					WPS_DEBUG_MSG(("WPS8Text::readText: find page break in auxilliary zone\n"));
-					m_listener->insertEOL();
+					// convert the basic characters run, a high surrogate always consumes the next character
+					unsigned long first = u;
+					while (u < numUnits)
+					{
+						uint16_t c = WPS_LE_GET_GUINT16(&buffer[2*u]);
+						if (c >= 0xd800 && c < 0xdc00)
+							u += (u+1 < numUnits) ? 2 : 1;
+						else if (WPS8TextInternal::isBasicCharacter(c))
+							++u;
+						else
+							break;
+					}
+#ifdef DEBUG_WITH_FILES
+					for (unsigned long c = first; c < u; ++c)
+						f << (char) WPS_LE_GET_GUINT16(&buffer[2*c]);
+#endif
+					text.clear();
+					// the listener skips the undefined characters, so do the same
+					libwps::appendUTF16LE(&buffer[2*first], u-first, text, 0);
+					if (!text.empty())
+						m_listener->insertUnicodeString(librevenge::RVNGString(text.c_str()));
+					continue;
 				}
-				break;
-			case 0x0D:
-				m_listener->insertEOL();
-				break;
-
-			case 0x0E:
-				m_listener->insertBreak(WPS_COLUMN_BREAK);
-				break;
-
-			case 0x1E: // checkme: non-breaking hyphen
-				m_listener->insertUnicode(0x2011);
-				break;
-
-			case 0x1F: // non-breaking space ? ( old: optional breaking hyphen)
-				m_listener->insertUnicode(0xA0);
-				break;
+				long const unitPos = actPos+2*long(u++);
+				if (0x00 == readVal)
+					continue;
+				f << (char) readVal;
 
-			case 0x23:
-				//	TODO: fields, pictures, etc.
-				switch (special.m_type)
+				switch (readVal)
 				{
-				case WPS8TextStyle::FontData::T_None:
-					m_listener->insertCharacter('#');
+				case 0x9:
+					m_listener->insertTab();
 					break;
-				case WPS8TextStyle::FontData::T_Footnote:
-				case WPS8TextStyle::FontData::T_Endnote:
-				{
-					long fPos = input->tell()-2; // the note can be linked, so must retrieve the pos...
-					if (m_state->m_notesMap.find(fPos) == m_state->m_notesMap.end())
+
+				case 0x0A:
+					m_listener->insertEOL(true);
+					break;
+
+				case 0x0C:
+					if (mainZone)
+						mainParser().newPage(++actualPage);
+					else
 					{
-						WPS_DEBUG_MSG(("WPS8Text::readText can not find notes for position : %lx\n", (unsigned long) fPos));
-						break;
+						WPS_DEBUG_MSG(("WPS8Text::readText: find page break in auxilliary zone\n"));
+						m_listener->insertEOL();
 					}
-					WPS8TextInternal::Notes const &note = *m_state->m_notesMap[fPos];
-					if (!note.m_corr || note.m_note) break;
-					WPSEntry nEntry = note.getCorrespondanceEntry(fPos);
-					shared_ptr<WPSSubDocument> doc(new WPS8TextInternal::SubDocument(input, *this, nEntry));
-					m_listener->insertNote(special.m_type==WPS8TextStyle::FontData::T_Footnote ? WPSContentListener::FOOTNOTE : WPSContentListener::ENDNOTE, doc);
 					break;
-				}
-				case WPS8TextStyle::FontData::T_Field:
-					switch (special.m_fieldType)
+				case 0x0D:
+					m_listener->insertEOL();
+					break;
+
+				case 0x0E:
+					m_listener->insertBreak(WPS_COLUMN_BREAK);
+					break;
+
+				case 0x1E: // checkme: non-breaking hyphen
+					m_listener->insertUnicode(0x2011);
+					break;
+
+				case 0x1F: // non-breaking space ? ( old: optional breaking hyphen)
+					m_listener->insertUnicode(0xA0);
+					break;
+
+				case 0x23:
+					//	TODO: fields, pictures, etc.
+					switch (special.m_type)
 					{
-					case WPS8TextStyle::FontData::F_PageNumber:
-						m_listener->insertField(WPSField(WPSField::PageNumber));
+					case WPS8TextStyle::FontData::T_None:
+						m_listener->insertCharacter('#');
 						break;
-					case WPS8TextStyle::FontData::F_Date:
-					case WPS8TextStyle::FontData::F_Time:
+					case WPS8TextStyle::FontData::T_Footnote:
+					case WPS8TextStyle::FontData::T_Endnote:
 					{
-						std::string format = special.format();
-						if (format.length())
+						long fPos = unitPos; // the note can be linked, so must retrieve the pos...
+						if (m_state->m_notesMap.find(fPos) == m_state->m_notesMap.end())
 						{
-							WPSField field(WPSField::Date);
-							field.m_DTFormat=format;
-							m_listener->insertField(field);
+							WPS_DEBUG_MSG(("WPS8Text::readText can not find notes for position : %lx\n", (unsigned long) fPos));
+							break;
 						}
-						else
+						WPS8TextInternal::Notes const &note = *m_state->m_notesMap[fPos];
+						if (!note.m_corr || note.m_note) break;
+						WPSEntry nEntry = note.getCorrespondanceEntry(fPos);
+						shared_ptr<WPSSubDocument> doc(new WPS8TextInternal::SubDocument(input, *this, nEntry));
+						m_listener->insertNote(special.m_type==WPS8TextStyle::FontData::T_Footnote ? WPSContentListener::FOOTNOTE : WPSContentListener::ENDNOTE, doc);
+						break;
+					}
+					case WPS8TextStyle::FontData::T_Field:
+						switch (special.m_fieldType)
+						{
+						case WPS8TextStyle::FontData::F_PageNumber:
+							m_listener->insertField(WPSField(WPSField::PageNumber));
+							break;
+						case WPS8TextStyle::FontData::F_Date:
+						case WPS8TextStyle::FontData::F_Time:
 						{
-							WPS_DEBUG_MSG(("WPS8Text::readText: unknown date/time format for position : %lX\n", (unsigned long) pos));
+							std::string format = special.format();
+							if (format.length())
+							{
+								WPSField field(WPSField::Date);
+								field.m_DTFormat=format;
+								m_listener->insertField(field);
+							}
+							else
+							{
+								WPS_DEBUG_MSG(("WPS8Text::readText: unknown date/time format for position : %lX\n", (unsigned long) pos));
+							}
+							break;
 						}
+						case WPS8TextStyle::FontData::F_None:
+						default:
+							m_listener->insertUnicode(0x263B);
+							break;
+						}
+						special = WPS8TextStyle::FontData();
 						break;
-					}
-					case WPS8TextStyle::FontData::F_None:
 					default:
 						m_listener->insertUnicode(0x263B);
-						break;
 					}
-					special = WPS8TextStyle::FontData();
 					break;
-				default:
-					m_listener->insertUnicode(0x263B);
-				}
-				break;
 
-			case 0xfffc:
-			{
-				if (special.m_type != WPS8TextStyle::FontData::T_Object)
-					break;
-				long objPos = input->tell()-2;
-				if (m_state->m_objectMap.find(objPos) == m_state->m_objectMap.end())
+				case 0xfffc:
 				{
-					WPS_DEBUG_MSG(("WPSText::readText can not find EOB for position : %lX\n", (unsigned long) objPos));
+					if (special.m_type != WPS8TextStyle::FontData::T_Object)
+						break;
+					long objPos = unitPos;
+					if (m_state->m_objectMap.find(objPos) == m_state->m_objectMap.end())
+					{
+						WPS_DEBUG_MSG(("WPSText::readText can not find EOB for position : %lX\n", (unsigned long) objPos));
+						break;
+					}
+					WPS8TextInternal::Object const &obj = m_state->m_objectMap.find(objPos)->second;
+					if (obj.m_type == WPS8TextInternal::Object::Image)
+						mainParser().sendObject(obj.m_size, obj.m_id, true);
+					else if (obj.m_type == WPS8TextInternal::Object::Table)
+						mainParser().sendTable(obj.m_size, obj.m_id);
+					else
+					{
+						WPS_DEBUG_MSG(("WPSText::readText do not know how to send object in position : %lX\n", (unsigned long) objPos));
+					}
 					break;
 				}
-				WPS8TextInternal::Object const &obj = m_state->m_objectMap.find(objPos)->second;
-				if (obj.m_type == WPS8TextInternal::Object::Image)
-					mainParser().sendObject(obj.m_size, obj.m_id, true);
-				else if (obj.m_type == WPS8TextInternal::Object::Table)
-					mainParser().sendTable(obj.m_size, obj.m_id);
-				else
-				{
-					WPS_DEBUG_MSG(("WPSText::readText do not know how to send object in position : %lX\n", (unsigned long) objPos));
-				}
-				break;
-			}
-			default:
-				if (readVal < 28)
-				{
-					// do not add unprintable control which can create invalid odt file
-					WPS_DEBUG_MSG(("WPS8Text::readText(find unprintable character: ignored)\n"));
+				default:
+					if (readVal < 28)
+					{
+						// do not add unprintable control which can create invalid odt file
+						WPS_DEBUG_MSG(("WPS8Text::readText(find unprintable character: ignored)\n"));
+						break;
+					}
+					m_listener->insertUnicode(readVal);
 					break;
 				}
-				m_listener->insertUnicode((uint32_t)readUTF16LE(input, finalPos, readVal));
-				break;
 			}
+			input->seek(actPos+2*long(u), librevenge::RVNG_SEEK_SET);
 		}
 		ascii().addPos(pos);
 		ascii().addNote(f.str().c_str());
@@ -1067,55 +1134,25 @@ bool WPS8Text::readStructures()
 ////////////////////////////////////////////////////////////
 // basic strings functions:
 ////////////////////////////////////////////////////////////
-/* Read an UTF16 character in LE byte ordering, convert it. Courtesy of glib2 */
-long WPS8Text::readUTF16LE(RVNGInputStreamPtr input, long endPos, uint16_t firstC)
-{
-	if (firstC >= 0xdc00 && firstC < 0xe000)
-	{
-		WPS_DEBUG_MSG(("WPS8Text::readUTF16LE: error: character = %i (0x%X)\n", firstC, (unsigned) firstC));
-		return 0xfffd;
-	}
-	if (firstC >= 0xd800 && firstC < 0xdc00)
-	{
-		firstC = uint16_t(firstC - 0xd800);
-		if (input->tell() == endPos)
-		{
-			WPS_DEBUG_MSG(("WPS8Text::readUTF16LE: error: find high surrogate without low\n"));
-			return 0xfffd;
-		}
-		uint16_t lowVal = libwps::readU16(input);
-		if (lowVal >= 0xdc00 && lowVal < 0xe000)
-		{
-			lowVal = uint16_t(lowVal - 0xdc00);
-			return firstC* 0x400 + lowVal + 0x10000;
-		}
-		else
-		{
-			WPS_DEBUG_MSG(("WPS8Text::readUTF16LE: error: surrogate character = %i (0x%X)\n", firstC, (unsigned) firstC));
-			return 0xfffd;
-		}
-	}
-	/** CHECKME: for Symbol font, we must probably convert 0xF0xx and 0x00xx in a 0x03yy symbol :-~ */
-	if (firstC>=28) return firstC;
-	WPS_DEBUG_MSG(("WPS8Text::readUTF16LE: error: character = %i (0x%X)\n", firstC, (unsigned) firstC));
-	return 0xfffd;
-}
-
 bool WPS8Text::readString(RVNGInputStreamPtr input, long page_size,
                           librevenge::RVNGString &res)
 {
 	res = "";
 	long page_offset = input->tell();
-	long endString = page_offset + page_size;
-
-	while (input->tell() < endString-1 && !input->isEnd())
-	{
-		uint16_t val = libwps::readU16(input);
-		if (!val) break;
-
-		long unicode = readUTF16LE(input, endString, val);
-		if (unicode != 0xfffd) libwps::appendUnicode(val, res);
-	}
+	if (page_size < 2) return true;
+
+	unsigned long numRead;
+	unsigned char const *data = input->read((unsigned long) page_size, numRead);
+	if (!data) return true;
+	// the string ends with the first 0 character
+	unsigned long numUnits = numRead/2, len = 0;
+	while (len < numUnits && WPS_LE_GET_GUINT16(data+2*len))
+		++len;
+	std::string text;
+	libwps::appendUTF16LE(data, len, text, 0);
+	res = text.c_str();
+	if (len < numUnits)
+		input->seek(page_offset+2*long(len+1), librevenge::RVNG_SEEK_SET);
 	return true;
 }
 
@@ -1569,7 +1606,7 @@ bool WPS8Text::bmktEndDataParser(long endPage, std::vector<long> const &textPtrs
 	}
 
 	if (fods.size())
-		m_FODList = mergeSortedFODLists(m_FODList, fods);
+		mergeSortedFODList(fods, false);
 
 	return true;
 
@@ -1624,12 +1661,14 @@ bool WPS8Text::objectDataParser(long bot, long /*eot*/, int /*id*/,
 		else if (val[0] == 3) obj.m_type = Object::Table;
 		else
 		{
+#ifdef DEBUG
 			static bool first = true;
 			if (first)
 			{
 				first = false;
 				WPS_DEBUG_MSG(("WPS8Text::objectDataParser: unknown type: %ld\n", val[0]));
 			}
+#endif
 			obj.m_type = int(-1 - val[0]);
 		}
 	}
@@ -1900,7 +1939,7 @@ bool WPS8Text::tokenEndDataParser(long endPage, std::vector<long> const &textPtr
 	}
 
 	if (fods.size())
-		m_FODList = mergeSortedFODLists(m_FODList, fods);
+		mergeSortedFODList(fods, false);
 
 	return true;
 }
@@ -2190,7 +2229,7 @@ bool WPS8Text::readPLC
 		else plcType.m_contentType = WPS8PLCInternal::PLC::T_UNKNOWN;
 	}
 	if (fods.size())
-		m_FODList = mergeSortedFODLists(m_FODList, fods);
+		mergeSortedFODList(fods, false);
 
 	ascii().addPos(page_offset);
 	ascii().addNote(f.str().c_str());
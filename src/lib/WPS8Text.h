@@ -120,8 +120,6 @@ protected:
 	//! reads a string
 	bool readString(RVNGInputStreamPtr input, long page_size,
 	                librevenge::RVNGString &res);
-	//! reads a utf16 character, \return 0xfffd if an error
-	long readUTF16LE(RVNGInputStreamPtr input, long endPos, uint16_t firstC);
 
 	/** \brief the footnote ( FTN or EDN )
 	 *
@@ -185,7 +185,7 @@ bool WPS8TextStyle::readStructures()
 		                             : (WPS8Text::FDPParser) &WPS8Text::readFont;
 		for (size_t i = 0; i < numZones; i++)
 			m_mainParser.readFDP(zones[i], fdps, parser);
-		m_mainParser.m_FODList = m_mainParser.mergeSortedFODLists(m_mainParser.m_FODList, fdps);
+		m_mainParser.mergeSortedFODList(fdps, false);
 	}
 	// read SGP zone
 	pos = nameTable.lower_bound("SGP ");
@@ -619,7 +619,18 @@ void WPS8TextStyle::sendFont(int fId, WPS8TextStyle::FontData &data)
 	    fId < 0 ? m_state->m_defaultFont : m_state->m_fontList[size_t(fId)];
 	data = font.special();
 	if (m_listener)
-		m_listener->setFont(font);
+		m_listener->setFont(font, fId);
+}
+
+void WPS8TextStyle::getFontData(int fId, WPS8TextStyle::FontData &data) const
+{
+	if (fId >= int(m_state->m_fontList.size()))
+	{
+		data = WPS8TextStyle::FontData();
+		WPS_DEBUG_MSG(("WPS8TextStyle::getFontData: can not find font id %d\n", fId));
+		return;
+	}
+	data = (fId < 0 ? m_state->m_defaultFont : m_state->m_fontList[size_t(fId)]).special();
 }
 
 ////////////////////////////////////////////////////////////
@@ -1049,7 +1060,7 @@ void WPS8TextStyle::sendParagraph(int pId)
 	if (!m_listener) return;
 	WPSParagraph const &para=
 	    pId < 0 ? m_state->m_defaultParagraph : m_state->m_paragraphList[size_t(pId)];
-	m_listener->setParagraph(para);
+	m_listener->setParagraph(para, pId);
 }
 
 ////////////////////////////////////////////////////////////
@@ -62,6 +62,8 @@ protected:
 	bool readFont(long endPos, int &id, std::string &mess);
 
 	void sendFont(int fId, FontData &data);
+	//! only retrieves the field, note or object data of a font (used in text only mode)
+	void getFontData(int fId, FontData &data) const;
 
 	//! the paragraph
 	bool readParagraph(long endPos, int &id, std::string &mess);
@@ -25,6 +25,7 @@
 #include <iomanip>
 #include <sstream>
 #include <stdio.h>
+#include <string.h>
 
 #include <librevenge/librevenge.h>
 
@@ -57,6 +58,7 @@ struct WPSDocumentParsingState
 	int m_newListId; // a new free id
 
 	bool m_isDocumentStarted, m_isHeaderFooterStarted;
+	bool m_isTextOnly; /** a flag to know if we only send the characters */
 	std::vector<WPSSubDocumentPtr> m_subDocuments; /** list of document actually open */
 
 private:
@@ -68,7 +70,7 @@ WPSDocumentParsingState::WPSDocumentParsingState(std::vector<WPSPageSpan> const
 	m_pageList(pageList),
 	m_metaData(),
 	m_footNoteNumber(0), m_endNoteNumber(0), m_newListId(0),
-	m_isDocumentStarted(false), m_isHeaderFooterStarted(false), m_subDocuments()
+	m_isDocumentStarted(false), m_isHeaderFooterStarted(false), m_isTextOnly(false), m_subDocuments()
 {
 }
 
@@ -87,7 +89,11 @@ struct WPSContentParsingState
 	int m_numDeferredTabs;
 
 	WPSFont m_font;
+	//! the parser's id of the actual font or -1
+	int m_fontId;
 	WPSParagraph m_paragraph;
+	//! the parser's id of the actual paragraph or -1
+	int m_paragraphId;
 	shared_ptr<WPSList> m_list;
 
 	bool m_isParagraphColumnBreak;
@@ -144,7 +150,7 @@ private:
 WPSContentParsingState::WPSContentParsingState() :
 	m_textBuffer(""), m_numDeferredTabs(0),
 
-	m_font(), m_paragraph(), m_list(),
+	m_font(), m_fontId(-1), m_paragraph(), m_paragraphId(-1), m_list(),
 	m_isParagraphColumnBreak(false), m_isParagraphPageBreak(false),
 
 	m_isPageSpanOpened(false), m_isSectionOpened(false), m_isFrameOpened(false),
@@ -249,7 +255,10 @@ void WPSContentListener::insertEOL(bool soft)
 	// sub/superscript must not survive a new line
 	static const uint32_t s_subsuperBits = WPS_SUBSCRIPT_BIT | WPS_SUPERSCRIPT_BIT;
 	if (m_ps->m_font.m_attributes & s_subsuperBits)
+	{
 		m_ps->m_font.m_attributes &= ~s_subsuperBits;
+		m_ps->m_fontId=-1;
+	}
 }
 
 void WPSContentListener::insertTab()
@@ -330,8 +339,16 @@ void WPSContentListener::_insertBreakIfNecessary(librevenge::RVNGPropertyList &p
 ///////////////////
 // font/character format
 ///////////////////
+void WPSContentListener::setFont(const WPSFont &font, int fontId)
+{
+	if (fontId>=0 && fontId==m_ps->m_fontId) return;
+	setFont(font);
+	m_ps->m_fontId=fontId;
+}
+
 void WPSContentListener::setFont(const WPSFont &font)
 {
+	m_ps->m_fontId=-1;
 	WPSFont newFont(font);
 	if (font.m_size<=0)
 		newFont.m_size=m_ps->m_font.m_size;
@@ -340,7 +357,9 @@ void WPSContentListener::setFont(const WPSFont &font)
 	if (font.m_languageId <= 0)
 		newFont.m_languageId=m_ps->m_font.m_languageId;
 	if (m_ps->m_font==newFont) return;
-	_closeSpan();
+	// in text only mode, the span's properties are empty: no need to close it
+	if (!m_ds->m_isTextOnly)
+		_closeSpan();
 	m_ps->m_font=newFont;
 }
 
@@ -362,10 +381,23 @@ WPSParagraph const &WPSContentListener::getParagraph() const
 	return m_ps->m_paragraph;
 }
 
+int WPSContentListener::getParagraphId() const
+{
+	return m_ps->m_paragraphId;
+}
+
+void WPSContentListener::setParagraph(const WPSParagraph &para, int paragraphId)
+{
+	if (paragraphId>=0 && paragraphId==m_ps->m_paragraphId) return;
+	setParagraph(para);
+	m_ps->m_paragraphId=paragraphId;
+}
+
 void WPSContentListener::setParagraph(const WPSParagraph &para)
 {
+	m_ps->m_paragraphId=-1;
 	// check if we need to update the list
-	if (para.m_listLevelIndex >= 1)
+	if (para.m_listLevelIndex >= 1 && !m_ds->m_isTextOnly)
 	{
 		WPSList::Level level = para.m_listLevel;
 		level.m_labelWidth = (para.m_margins[1]-level.m_labelIndent);
@@ -384,6 +416,8 @@ void WPSContentListener::setParagraph(const WPSParagraph &para)
 			theList->set(para.m_listLevelIndex, level);
 	}
 	m_ps->m_paragraph=para;
+	if (m_ds->m_isTextOnly)
+		m_ps->m_paragraph.m_listLevelIndex=0;
 }
 
 ///////////////////
@@ -522,6 +556,21 @@ void WPSContentListener::setMetaData(const librevenge::RVNGPropertyList &list)
 	}
 }
 
+void WPSContentListener::setTextOnly(bool textOnly)
+{
+	if (m_ds->m_isDocumentStarted)
+	{
+		WPS_DEBUG_MSG(("WPSContentListener::setTextOnly: the document is already started\n"));
+		return;
+	}
+	m_ds->m_isTextOnly=textOnly;
+}
+
+bool WPSContentListener::isTextOnly() const
+{
+	return m_ds->m_isTextOnly;
+}
+
 void WPSContentListener::startDocument()
 {
 	if (m_ds->m_isDocumentStarted)
@@ -554,7 +603,11 @@ void WPSContentListener::endDocument()
 	if (m_ps->m_isParagraphOpened)
 		_closeParagraph();
 
-	m_ps->m_paragraph.m_listLevelIndex = 0;
+	if (m_ps->m_paragraph.m_listLevelIndex)
+	{
+		m_ps->m_paragraph.m_listLevelIndex = 0;
+		m_ps->m_paragraphId = -1;
+	}
 	_changeList(); // flush the list exterior
 
 	// close the document nice and tight
@@ -595,8 +648,11 @@ void WPSContentListener::_openPageSpan()
 	WPSPageSpan &currentPage = *it;
 
 	librevenge::RVNGPropertyList propList;
-	currentPage.getPageProperty(propList);
-	propList.insert("librevenge:is-last-page-span", ((m_ps->m_currentPage + 1 == m_ds->m_pageList.size()) ? true : false));
+	if (!m_ds->m_isTextOnly)
+	{
+		currentPage.getPageProperty(propList);
+		propList.insert("librevenge:is-last-page-span", ((m_ps->m_currentPage + 1 == m_ds->m_pageList.size()) ? true : false));
+	}
 
 	if (!m_ps->m_isPageSpanOpened)
 		m_documentInterface->openPageSpan(propList);
@@ -615,7 +671,8 @@ void WPSContentListener::_openPageSpan()
 	_updatePageSpanDependent(true);
 
 	// we insert the header footer
-	currentPage.sendHeaderFooters(this, m_documentInterface);
+	if (!m_ds->m_isTextOnly)
+		currentPage.sendHeaderFooters(this, m_documentInterface);
 
 	// first paragraph in span (necessary for resetting page number)
 	m_ps->m_firstParagraphInPageSpan = true;
@@ -656,6 +713,13 @@ void WPSContentListener::_openSection()
 	m_ps->m_numColumns = int(m_ps->m_textColumns.size());
 
 	librevenge::RVNGPropertyList propList;
+	if (m_ds->m_isTextOnly)
+	{
+		m_documentInterface->openSection(propList);
+		m_ps->m_sectionAttributesChanged = false;
+		m_ps->m_isSectionOpened = true;
+		return;
+	}
 	propList.insert("fo:margin-left", 0.);
 	propList.insert("fo:margin-right", 0.);
 	if (m_ps->m_numColumns > 1)
@@ -719,7 +783,8 @@ void WPSContentListener::_openParagraph()
 	}
 
 	librevenge::RVNGPropertyList propList;
-	_appendParagraphProperties(propList);
+	if (!m_ds->m_isTextOnly)
+		_appendParagraphProperties(propList);
 
 	if (!m_ps->m_isParagraphOpened)
 		m_documentInterface->openParagraph(propList);
@@ -745,7 +810,11 @@ void WPSContentListener::_closeParagraph()
 	}
 
 	m_ps->m_isParagraphOpened = false;
-	m_ps->m_paragraph.m_listLevelIndex = 0;
+	if (m_ps->m_paragraph.m_listLevelIndex)
+	{
+		m_ps->m_paragraph.m_listLevelIndex = 0;
+		m_ps->m_paragraphId = -1;
+	}
 
 	if (!m_ps->m_isTableOpened && m_ps->m_isPageSpanBreakDeferred && !m_ps->m_inSubDocument)
 		_closePageSpan();
@@ -835,7 +904,11 @@ void WPSContentListener::_closeListElement()
 	}
 
 	m_ps->m_isListElementOpened = m_ps->m_isParagraphOpened = false;
-	m_ps->m_paragraph.m_listLevelIndex = 0;
+	if (m_ps->m_paragraph.m_listLevelIndex)
+	{
+		m_ps->m_paragraph.m_listLevelIndex = 0;
+		m_ps->m_paragraphId = -1;
+	}
 
 	if (!m_ps->m_isTableOpened && m_ps->m_isPageSpanBreakDeferred && !m_ps->m_inSubDocument)
 		_closePageSpan();
@@ -900,6 +973,8 @@ void WPSContentListener::_changeList()
 	for (size_t i=actualListLevel+1; i<= (size_t)m_ps->m_paragraph.m_listLevelIndex; i++)
 	{
 		librevenge::RVNGPropertyList propList;
+		if (m_ps->m_list->getId() <= 0)
+			m_ps->m_list->setId(++m_ds->m_newListId);
 		m_ps->m_list->addLevelTo(int(i), propList);
 		if (m_ps->m_list->isNumeric(int(i)))
 		{
@@ -935,7 +1010,8 @@ void WPSContentListener::_openSpan()
 	}
 
 	librevenge::RVNGPropertyList propList;
-	m_ps->m_font.addTo(propList);
+	if (!m_ds->m_isTextOnly)
+		m_ps->m_font.addTo(propList);
 
 	m_documentInterface->openSpan(propList);
 
@@ -982,30 +1058,37 @@ void WPSContentListener::_flushText()
 {
 	if (m_ps->m_textBuffer.len() == 0) return;
 
-	// when some many ' ' follows each other, call insertSpace
-	librevenge::RVNGString tmpText;
-	int numConsecutiveSpaces = 0;
-	librevenge::RVNGString::Iter i(m_ps->m_textBuffer);
-	for (i.rewind(); i.next();)
-	{
-		if (*(i()) == 0x20) // this test is compatible with unicode format
-			numConsecutiveSpaces++;
-		else
-			numConsecutiveSpaces = 0;
-
-		if (numConsecutiveSpaces > 1)
+	/* when some many ' ' follows each other, call insertSpace: look
+	   for the runs of spaces and send the text between them as slices
+	   (0x20 can not appear inside a UTF-8 multi-bytes character) */
+	char const *text = m_ps->m_textBuffer.cstr();
+	char const *const end = text+m_ps->m_textBuffer.size();
+	char const *first = text, *ptr = text;
+	std::string slice;
+	while (ptr < end)
+	{
+		char const *space = static_cast<char const *>(memchr(ptr, ' ', size_t(end-ptr)));
+		if (!space) break;
+		ptr = space+1;
+		if (ptr >= end || *ptr != ' ')
+			continue;
+		// keep the first space in the text, send the other ones as spaces
+		slice.assign(first, size_t(ptr-first));
+		m_documentInterface->insertText(librevenge::RVNGString(slice.c_str()));
+		while (ptr < end && *ptr == ' ')
 		{
-			if (tmpText.len() > 0)
-			{
-				m_documentInterface->insertText(tmpText);
-				tmpText.clear();
-			}
 			m_documentInterface->insertSpace();
+			++ptr;
 		}
-		else
-			tmpText.append(i());
+		first = ptr;
+	}
+	if (first == text)
+		m_documentInterface->insertText(m_ps->m_textBuffer);
+	else
+	{
+		slice.assign(first, size_t(end-first));
+		m_documentInterface->insertText(librevenge::RVNGString(slice.c_str()));
 	}
-	m_documentInterface->insertText(tmpText);
 	m_ps->m_textBuffer.clear();
 }
 
@@ -1124,7 +1207,7 @@ void WPSContentListener::insertPicture
 (WPSPosition const &pos, const librevenge::RVNGBinaryData &binaryData, std::string type,
  librevenge::RVNGPropertyList frameExtras)
 {
-	if (!_openFrame(pos, frameExtras)) return;
+	if (m_ds->m_isTextOnly || !_openFrame(pos, frameExtras)) return;
 
 	librevenge::RVNGPropertyList propList;
 	propList.insert("librevenge:mime-type", type.c_str());
@@ -1137,7 +1220,7 @@ void WPSContentListener::insertPicture
 void WPSContentListener::insertObject(WPSPosition const &pos, const WPSEmbeddedObject &obj,
                                       librevenge::RVNGPropertyList frameExtras)
 {
-	if (!_openFrame(pos, frameExtras)) return;
+	if (m_ds->m_isTextOnly || !_openFrame(pos, frameExtras)) return;
 
 	librevenge::RVNGPropertyList propList;
 	if (obj.addTo(propList))
@@ -1530,7 +1613,11 @@ void WPSContentListener::_endSubDocument()
 	if (m_ps->m_isParagraphOpened)
 		_closeParagraph();
 
-	m_ps->m_paragraph.m_listLevelIndex = 0;
+	if (m_ps->m_paragraph.m_listLevelIndex)
+	{
+		m_ps->m_paragraph.m_listLevelIndex = 0;
+		m_ps->m_paragraphId = -1;
+	}
 	_changeList(); // flush the list exterior
 }
 
@@ -1673,7 +1760,11 @@ void WPSContentListener::closeTableCell()
 	}
 
 	_closeParagraph();
-	m_ps->m_paragraph.m_listLevelIndex = 0;
+	if (m_ps->m_paragraph.m_listLevelIndex)
+	{
+		m_ps->m_paragraph.m_listLevelIndex = 0;
+		m_ps->m_paragraphId = -1;
+	}
 	_changeList(); // flush the list exterior
 
 	m_ps->m_isTableCellOpened = false;
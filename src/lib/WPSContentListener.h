@@ -49,6 +49,12 @@ public:
 
 	void setDocumentLanguage(int lcid);
 	void setMetaData(const librevenge::RVNGPropertyList &list);
+	/** sets the text only mode (must be called before startDocument): only the
+		characters are sent, the properties are empty, the lists, the headers/footers
+		and the pictures are not sent */
+	void setTextOnly(bool textOnly);
+	//! returns true if only the characters are sent
+	bool isTextOnly() const;
 
 	void startDocument();
 	void endDocument();
@@ -73,6 +79,9 @@ public:
 	// ------ text format -----------
 	//! set the actual font
 	void setFont(const WPSFont &font);
+	/** set the actual font knowing its id in the parser's font list: does nothing
+		if the actual font was set with the same id (a negative id is ignored) */
+	void setFont(const WPSFont &font, int fontId);
 	//! returns the actual font
 	WPSFont const &getFont() const;
 
@@ -81,6 +90,11 @@ public:
 	bool isParagraphOpened() const;
 	//! sets the actual paragraph
 	void setParagraph(const WPSParagraph &para);
+	/** sets the actual paragraph knowing its id in the parser's paragraph list: does
+		nothing if the actual paragraph was set with the same id (a negative id is ignored) */
+	void setParagraph(const WPSParagraph &para, int paragraphId);
+	//! returns the id of the actual paragraph or -1 if it was not set with an id
+	int getParagraphId() const;
 	//! returns the actual paragraph
 	WPSParagraph const &getParagraph() const;
 
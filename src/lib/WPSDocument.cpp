@@ -35,7 +35,9 @@
 #include "WPS8.h"
 #include "MSWrite.h"
 #include "WPSHeader.h"
+#include "WPSMappedFileStream.h"
 #include "WPSParser.h"
+#include "WPSPlainTextGenerator.h"
 
 using namespace libwps;
 
@@ -55,6 +57,116 @@ the full 100%.
 
  \warning When compiled with -DDEBUG_WITH__FILES, code is added to store the results of the parsing in different files: one file by Ole parts and some files to store the read pictures. These files are created in the current repository, therefore it is recommended to launch the tests in an empty repository...*/
 
+namespace WPSDocumentInternal
+{
+/** creates the parser which corresponds to a text document's header.
+
+	If check is set, the parser also verifies the header and an empty parser is returned if the header is bad.
+ */
+static shared_ptr<WPSParser> createTextParser(WPSHeaderPtr &header, char const *encoding, bool check)
+{
+	shared_ptr<WPSParser> res;
+	if (!header || header->getKind() != WPS_TEXT)
+		return res;
+	if (header->getCreator() == WPS_MSWRITE)
+		res.reset(new MSWriteParser(header->getInput(), header, libwps_tools_win::Font::getTypeForString(encoding)));
+	else if (header->getCreator() == WPS_DOSWORD)
+	{
+		shared_ptr<DosWordParser> parser(new DosWordParser(header->getInput(), header,
+		                                                   libwps_tools_win::Font::getTypeForString(encoding)));
+		if (!check || parser->checkHeader(header.get(), true))
+			res=parser;
+	}
+	else if (header->getMajorVersion()<=4)
+	{
+		shared_ptr<WPS4Parser> parser(new WPS4Parser(header->getInput(), header,
+		                                             libwps_tools_win::Font::getTypeForString(encoding)));
+		if (!check || parser->checkHeader(header.get(), true))
+			res=parser;
+	}
+	/* A word document: as WPS8Parser does not have a checkHeader
+	   function, only rely on the version: the format detection only
+	   accepts the versions 5, 7 and 8, the parsing also tries the version 6
+	 */
+	else if (header->getMajorVersion()==5 || header->getMajorVersion()==7 || header->getMajorVersion()==8 ||
+	         (!check && header->getMajorVersion()==6))
+		res.reset(new WPS8Parser(header->getInput(), header));
+	else
+	{
+		WPS_DEBUG_MSG(("WPSDocumentInternal::createTextParser: find unknown version number\n"));
+	}
+	return res;
+}
+
+/** creates the parser which corresponds to a spreadsheet or a database's header.
+
+	If check is set, the parser also verifies the header and an empty parser is returned if the header is bad.
+ */
+static shared_ptr<WKSParser> createSpreadsheetParser(WPSHeaderPtr &header, char const *encoding, bool check)
+{
+	shared_ptr<WKSParser> res;
+	if (!header || (header->getKind() != WPS_SPREADSHEET && header->getKind() != WPS_DATABASE))
+		return res;
+	if (header->getKind() == WPS_SPREADSHEET && header->getCreator() == WPS_LOTUS &&
+	        header->getMajorVersion()>=100)
+	{
+		shared_ptr<LotusParser> parser(new LotusParser(header->getInput(), header,
+		                                               libwps_tools_win::Font::getTypeForString(encoding)));
+		if (!check || parser->checkHeader(header.get(), true))
+			res=parser;
+	}
+	else if (header->getKind() == WPS_SPREADSHEET && header->getCreator() == WPS_QUATTRO_PRO &&
+	         header->getMajorVersion()<=2)
+	{
+		shared_ptr<QuattroParser> parser(new QuattroParser(header->getInput(), header,
+		                                                   libwps_tools_win::Font::getTypeForString(encoding)));
+		if (!check || parser->checkHeader(header.get(), true))
+			res=parser;
+	}
+	// the format detection lets WKS4Parser::checkHeader accept or reject the other versions, the parsing only accepts the versions 1 to 4
+	else if (check || (header->getMajorVersion()>=1 && header->getMajorVersion()<=4))
+	{
+		shared_ptr<WKS4Parser> parser(new WKS4Parser(header->getInput(), header,
+		                                             libwps_tools_win::Font::getTypeForString(encoding)));
+		if (!check || parser->checkHeader(header.get(), true))
+			res=parser;
+	}
+	else
+	{
+		WPS_DEBUG_MSG(("WPSDocumentInternal::createSpreadsheetParser: find unknown version number\n"));
+	}
+	return res;
+}
+
+/** updates the creator and the version found by WPSHeader::constructHeader
+	with the signature bytes which are only decoded by the parsers' checkHeader */
+static void sniffFlatFileVersion(RVNGInputStreamPtr &input, WPSKind kind, WPSCreator &creator, int &version)
+{
+	if (!input || input->isStructured() || input->seek(0, librevenge::RVNG_SEEK_SET)!=0)
+		return;
+	unsigned long numRead;
+	unsigned char const *data=input->read(6, numRead);
+	if (!data || numRead!=6)
+		return;
+	int const val=int(data[4])+(int(data[5])<<8);
+	if (kind==WPS_TEXT && creator==WPS_MSWORKS && data[1]==0xFE)
+		// see WPS4Parser::checkHeader
+		version=data[0]<4 ? 2 : data[0]<6 ? 3 : 4;
+	else if (kind==WPS_SPREADSHEET && creator==WPS_MSWORKS && data[0]==0 && data[1]==0 && data[2]==2)
+	{
+		// see WKS4Parser::checkHeader
+		version=1;
+		if (val==0x405)
+			creator=WPS_SYMPHONY;
+		else if (val==0x406)
+			creator=WPS_LOTUS;
+	}
+	else if (kind==WPS_SPREADSHEET && creator==WPS_LOTUS && val>=0x1000 && val<=0x1005)
+		// see LotusParser::checkHeader
+		version=100+(val-0x1000)+1;
+}
+}
+
 WPSLIB WPSConfidence WPSDocument::isFileFormatSupported(librevenge::RVNGInputStream *ip, WPSKind &kind, WPSCreator &creator, bool &needEncoding)
 {
 	WPS_DEBUG_MSG(("WPSDocument::isFileFormatSupported()\n"));
@@ -74,92 +186,128 @@ WPSLIB WPSConfidence WPSDocument::isFileFormatSupported(librevenge::RVNGInputStr
 		creator = header->getCreator();
 		kind = header->getKind();
 
-		WPSConfidence confidence = WPS_CONFIDENCE_NONE;
-		if (kind==WPS_TEXT && creator==WPS_MSWRITE)
-		{
-			needEncoding=true;
-			return WPS_CONFIDENCE_EXCELLENT;
-		}
-		else if (kind==WPS_TEXT && creator==WPS_DOSWORD)
-		{
-			// create a DosWordParser to check the header validity
-			DosWordParser parser(header->getInput(), header);
-			if (!parser.checkHeader(header.get(), true))
-				return WPS_CONFIDENCE_NONE;
-			needEncoding=header->getNeedEncoding();
-			return WPS_CONFIDENCE_EXCELLENT;
-		}
-		else if (kind==WPS_TEXT && header->getMajorVersion()<=4)
-		{
-			// create a WPS4Parser to check the header validity
-			WPS4Parser parser(header->getInput(), header);
-			if (!parser.checkHeader(header.get(), true))
-				return WPS_CONFIDENCE_NONE;
-			needEncoding=header->getNeedEncoding();
-			return WPS_CONFIDENCE_EXCELLENT;
-		}
-		else if (kind==WPS_SPREADSHEET && creator==WPS_LOTUS && header->getMajorVersion()>=100)
-		{
-			// create a Lotus to check the header validity
-			LotusParser parser(header->getInput(), header);
-			if (!parser.checkHeader(header.get(), true))
-				return WPS_CONFIDENCE_NONE;
-			needEncoding=header->getNeedEncoding();
-			return WPS_CONFIDENCE_EXCELLENT;
-		}
-		else if (kind==WPS_SPREADSHEET && creator==WPS_QUATTRO_PRO && header->getMajorVersion()<=2)
-		{
-			// create a Quattro to check the header validity
-			QuattroParser parser(header->getInput(), header);
-			if (!parser.checkHeader(header.get(), true))
-				return WPS_CONFIDENCE_NONE;
-			needEncoding=header->getNeedEncoding();
-			return WPS_CONFIDENCE_EXCELLENT;
-		}
-		else if (kind==WPS_SPREADSHEET || kind==WPS_DATABASE)
+		bool ok=kind==WPS_TEXT ? bool(WPSDocumentInternal::createTextParser(header, "", true)) :
+		        bool(WPSDocumentInternal::createSpreadsheetParser(header, "", true));
+		if (!ok)
+			return WPS_CONFIDENCE_NONE;
+		needEncoding=creator==WPS_MSWRITE || header->getNeedEncoding();
+		return WPS_CONFIDENCE_EXCELLENT;
+	}
+	catch (libwps::FileException)
+	{
+		WPS_DEBUG_MSG(("File exception trapped\n"));
+	}
+	catch (libwps::ParseException)
+	{
+		WPS_DEBUG_MSG(("Parse exception trapped\n"));
+	}
+	catch (...)
+	{
+		//fixme: too generic
+		WPS_DEBUG_MSG(("Unknown Exception trapped\n"));
+	}
+
+	return WPS_CONFIDENCE_NONE;
+}
+
+WPSLIB WPSConfidence WPSDocument::sniffFileFormat(librevenge::RVNGInputStream *ip, WPSKind &kind, WPSCreator &creator, int &version)
+{
+	if (!ip)
+		return WPS_CONFIDENCE_NONE;
+
+	shared_ptr<librevenge::RVNGInputStream > input(ip, WPS_shared_ptr_noop_deleter<librevenge::RVNGInputStream>());
+	try
+	{
+		WPSHeaderPtr header(WPSHeader::constructHeader(input));
+		if (!header)
+			return WPS_CONFIDENCE_NONE;
+		kind = header->getKind();
+		creator = header->getCreator();
+		version = int(header->getMajorVersion());
+		WPSDocumentInternal::sniffFlatFileVersion(input, kind, creator, version);
+		return WPS_CONFIDENCE_EXCELLENT;
+	}
+	catch (...)
+	{
+		WPS_DEBUG_MSG(("WPSDocument::sniffFileFormat: exception trapped\n"));
+	}
+	return WPS_CONFIDENCE_NONE;
+}
+
+WPSLIB WPSResult WPSDocument::detectAndParse(librevenge::RVNGInputStream *ip, librevenge::RVNGTextInterface *textInterface,
+        librevenge::RVNGSpreadsheetInterface *spreadsheetInterface, WPSConfidence &confidence,
+        WPSKind &kind, WPSCreator &creator, WPSParseOptions const &options,
+        char const * /*password*/, char const *encoding)
+{
+	confidence=WPS_CONFIDENCE_NONE;
+	if (!ip)
+		return WPS_UNKNOWN_ERROR;
+
+	kind=WPS_TEXT;
+	WPSResult error = WPS_OK;
+	WPSHeaderPtr header;
+	shared_ptr<librevenge::RVNGInputStream > input(ip, WPS_shared_ptr_noop_deleter<librevenge::RVNGInputStream>());
+	try
+	{
+		header.reset(WPSHeader::constructHeader(input));
+
+		if (!header)
+			return WPS_UNKNOWN_ERROR;
+		creator = header->getCreator();
+		kind = header->getKind();
+
+		// the header and the parser which checks it are kept to parse the document
+		if (kind==WPS_TEXT)
 		{
-			// create a WKS4Parser to check the header validity
-			WKS4Parser parser(header->getInput(), header);
-			if (!parser.checkHeader(header.get(), true))
-				return WPS_CONFIDENCE_NONE;
-			needEncoding=header->getNeedEncoding();
-			return WPS_CONFIDENCE_EXCELLENT;
+			shared_ptr<WPSParser> parser=WPSDocumentInternal::createTextParser(header, encoding, true);
+			if (!parser)
+				return WPS_UNKNOWN_ERROR;
+			confidence=WPS_CONFIDENCE_EXCELLENT;
+			if (!textInterface)
+				return WPS_UNKNOWN_ERROR;
+			parser->setParseOptions(options);
+			parser->parse(textInterface);
 		}
-
-		/* A word document: as WPS8Parser does not have a checkHeader
-		   function, only rely on the version
-		 */
-		switch (header->getMajorVersion())
+		else
 		{
-		case 8:
-		case 7:
-		case 5:
-			confidence = WPS_CONFIDENCE_EXCELLENT;
-			break;
-		default:
-			break;
+			shared_ptr<WKSParser> parser=WPSDocumentInternal::createSpreadsheetParser(header, encoding, true);
+			if (!parser)
+				return WPS_UNKNOWN_ERROR;
+			confidence=WPS_CONFIDENCE_EXCELLENT;
+			if (!spreadsheetInterface)
+				return WPS_UNKNOWN_ERROR;
+			parser->setParseOptions(options);
+			parser->parse(spreadsheetInterface);
 		}
-		return confidence;
 	}
 	catch (libwps::FileException)
 	{
 		WPS_DEBUG_MSG(("File exception trapped\n"));
+		error = WPS_FILE_ACCESS_ERROR;
 	}
 	catch (libwps::ParseException)
 	{
 		WPS_DEBUG_MSG(("Parse exception trapped\n"));
+		error = WPS_PARSE_ERROR;
 	}
 	catch (...)
 	{
 		//fixme: too generic
-		WPS_DEBUG_MSG(("Unknown Exception trapped\n"));
+		WPS_DEBUG_MSG(("Unknown exception trapped\n"));
+		error = WPS_UNKNOWN_ERROR;
 	}
 
-	return WPS_CONFIDENCE_NONE;
+	return error;
+}
+
+WPSLIB WPSResult WPSDocument::parse(librevenge::RVNGInputStream *ip, librevenge::RVNGTextInterface *documentInterface,
+                                    char const *password, char const *encoding)
+{
+	return parse(ip, documentInterface, WPSParseOptions(), password, encoding);
 }
 
 WPSLIB WPSResult WPSDocument::parse(librevenge::RVNGInputStream *ip, librevenge::RVNGTextInterface *documentInterface,
-                                    char const * /*password*/, char const *encoding)
+                                    WPSParseOptions const &options, char const * /*password*/, char const *encoding)
 {
 	if (!ip || !documentInterface)
 		return WPS_UNKNOWN_ERROR;
@@ -167,7 +315,6 @@ WPSLIB WPSResult WPSDocument::parse(librevenge::RVNGInputStream *ip, librevenge:
 	WPSResult error = WPS_OK;
 
 	WPSHeaderPtr header;
-	shared_ptr<WPSParser> parser;
 	shared_ptr<librevenge::RVNGInputStream > input(ip, WPS_shared_ptr_noop_deleter<librevenge::RVNGInputStream>());
 	try
 	{
@@ -176,47 +323,10 @@ WPSLIB WPSResult WPSDocument::parse(librevenge::RVNGInputStream *ip, librevenge:
 		if (!header || header->getKind() != WPS_TEXT)
 			return WPS_UNKNOWN_ERROR;
 
-		if (header->getCreator() == WPS_MSWRITE)
-		{
-			parser.reset(new MSWriteParser(header->getInput(), header,
-			                               libwps_tools_win::Font::getTypeForString(encoding)));
-			if (!parser) return WPS_UNKNOWN_ERROR;
-			parser->parse(documentInterface);
-		}
-		else if (header->getCreator() == WPS_DOSWORD)
-		{
-			parser.reset(new DosWordParser(header->getInput(), header,
-			                               libwps_tools_win::Font::getTypeForString(encoding)));
-			if (!parser) return WPS_UNKNOWN_ERROR;
-			parser->parse(documentInterface);
-		}
-		else switch (header->getMajorVersion())
-			{
-			case 8:
-			case 7:
-			case 6:
-			case 5:
-			{
-				parser.reset(new WPS8Parser(header->getInput(), header));
-				if (!parser) return WPS_UNKNOWN_ERROR;
-				parser->parse(documentInterface);
-				break;
-			}
-
-			case 4:
-			case 3:
-			case 2:
-			case 1:
-			{
-				parser.reset(new WPS4Parser(header->getInput(), header,
-				                            libwps_tools_win::Font::getTypeForString(encoding)));
-				if (!parser) return WPS_UNKNOWN_ERROR;
-				parser->parse(documentInterface);
-				break;
-			}
-			default:
-				break;
-			}
+		shared_ptr<WPSParser> parser=WPSDocumentInternal::createTextParser(header, encoding, false);
+		if (!parser) return WPS_UNKNOWN_ERROR;
+		parser->setParseOptions(options);
+		parser->parse(documentInterface);
 	}
 	catch (libwps::FileException)
 	{
@@ -238,8 +348,23 @@ WPSLIB WPSResult WPSDocument::parse(librevenge::RVNGInputStream *ip, librevenge:
 	return error;
 }
 
+WPSLIB WPSResult WPSDocument::parseText(librevenge::RVNGInputStream *ip, librevenge::RVNGString &text,
+                                        char const *password, char const *encoding)
+{
+	WPSParseOptions options;
+	options.m_skipEmbeddedObjects=options.m_textOnly=true;
+	WPSPlainTextGenerator generator(text);
+	return parse(ip, &generator, options, password, encoding);
+}
+
 WPSLIB WPSResult WPSDocument::parse(librevenge::RVNGInputStream *ip, librevenge::RVNGSpreadsheetInterface *documentInterface,
-                                    char const * /*password*/, char const *encoding)
+                                    char const *password, char const *encoding)
+{
+	return parse(ip, documentInterface, WPSParseOptions(), password, encoding);
+}
+
+WPSLIB WPSResult WPSDocument::parse(librevenge::RVNGInputStream *ip, librevenge::RVNGSpreadsheetInterface *documentInterface,
+                                    WPSParseOptions const &options, char const * /*password*/, char const *encoding)
 {
 	if (!ip || !documentInterface)
 		return WPS_UNKNOWN_ERROR;
@@ -256,43 +381,10 @@ WPSLIB WPSResult WPSDocument::parse(librevenge::RVNGInputStream *ip, librevenge:
 		if (!header || (header->getKind() != WPS_SPREADSHEET && header->getKind() != WPS_DATABASE))
 			return WPS_UNKNOWN_ERROR;
 
-		if (header->getKind() == WPS_SPREADSHEET && header->getCreator() == WPS_LOTUS &&
-		        header->getMajorVersion()>=100)
-		{
-			parser.reset(new LotusParser(header->getInput(), header,
-			                             libwps_tools_win::Font::getTypeForString(encoding)));
-			if (!parser) return WPS_UNKNOWN_ERROR;
-			parser->parse(documentInterface);
-		}
-		else if (header->getKind() == WPS_SPREADSHEET && header->getCreator() == WPS_QUATTRO_PRO &&
-		         header->getMajorVersion()<=2)
-		{
-			parser.reset(new QuattroParser(header->getInput(), header,
-			                               libwps_tools_win::Font::getTypeForString(encoding)));
-			if (!parser) return WPS_UNKNOWN_ERROR;
-			parser->parse(documentInterface);
-		}
-		else
-		{
-			switch (header->getMajorVersion())
-			{
-			case 4:
-			case 3:
-			case 2:
-			case 1:
-			{
-				parser.reset(new WKS4Parser(header->getInput(), header,
-				                            libwps_tools_win::Font::getTypeForString(encoding)));
-				if (!parser) return WPS_UNKNOWN_ERROR;
-				parser->parse(documentInterface);
-				break;
-			}
-			default:
-				WPS_DEBUG_MSG(("WPSDocument::parse: find unknown version number\n"));
-				error=WPS_UNKNOWN_ERROR;
-				break;
-			}
-		}
+		parser=WPSDocumentInternal::createSpreadsheetParser(header, encoding, false);
+		if (!parser) return WPS_UNKNOWN_ERROR;
+		parser->setParseOptions(options);
+		parser->parse(documentInterface);
 	}
 	catch (libwps::FileException)
 	{
@@ -313,4 +405,93 @@ WPSLIB WPSResult WPSDocument::parse(librevenge::RVNGInputStream *ip, librevenge:
 
 	return error;
 }
+
+WPSLIB WPSConfidence WPSDocument::isFileFormatSupported(char const *fileName, WPSKind &kind, WPSCreator &creator, bool &needEncoding)
+{
+	if (!fileName)
+		return WPS_CONFIDENCE_NONE;
+	WPSMappedFileStream input(fileName);
+	if (!input.isOk())
+		return WPS_CONFIDENCE_NONE;
+	return isFileFormatSupported(&input, kind, creator, needEncoding);
+}
+
+WPSLIB WPSConfidence WPSDocument::sniffFileFormat(char const *fileName, WPSKind &kind, WPSCreator &creator, int &version)
+{
+	if (!fileName)
+		return WPS_CONFIDENCE_NONE;
+	WPSMappedFileStream input(fileName);
+	if (!input.isOk())
+		return WPS_CONFIDENCE_NONE;
+	return sniffFileFormat(&input, kind, creator, version);
+}
+
+WPSLIB WPSResult WPSDocument::detectAndParse(char const *fileName, librevenge::RVNGTextInterface *textInterface,
+        librevenge::RVNGSpreadsheetInterface *spreadsheetInterface, WPSConfidence &confidence,
+        WPSKind &kind, WPSCreator &creator, WPSParseOptions const &options,
+        char const *password, char const *encoding)
+{
+	confidence=WPS_CONFIDENCE_NONE;
+	if (!fileName)
+		return WPS_UNKNOWN_ERROR;
+	WPSMappedFileStream input(fileName);
+	if (!input.isOk())
+		return WPS_FILE_ACCESS_ERROR;
+	return detectAndParse(&input, textInterface, spreadsheetInterface, confidence, kind, creator, options, password, encoding);
+}
+
+WPSLIB WPSResult WPSDocument::parse(char const *fileName, librevenge::RVNGTextInterface *documentInterface,
+                                    char const *password, char const *encoding)
+{
+	if (!fileName || !documentInterface)
+		return WPS_UNKNOWN_ERROR;
+	WPSMappedFileStream input(fileName);
+	if (!input.isOk())
+		return WPS_FILE_ACCESS_ERROR;
+	return parse(&input, documentInterface, password, encoding);
+}
+
+WPSLIB WPSResult WPSDocument::parse(char const *fileName, librevenge::RVNGTextInterface *documentInterface,
+                                    WPSParseOptions const &options, char const *password, char const *encoding)
+{
+	if (!fileName || !documentInterface)
+		return WPS_UNKNOWN_ERROR;
+	WPSMappedFileStream input(fileName);
+	if (!input.isOk())
+		return WPS_FILE_ACCESS_ERROR;
+	return parse(&input, documentInterface, options, password, encoding);
+}
+
+WPSLIB WPSResult WPSDocument::parseText(char const *fileName, librevenge::RVNGString &text,
+                                        char const *password, char const *encoding)
+{
+	if (!fileName)
+		return WPS_UNKNOWN_ERROR;
+	WPSMappedFileStream input(fileName);
+	if (!input.isOk())
+		return WPS_FILE_ACCESS_ERROR;
+	return parseText(&input, text, password, encoding);
+}
+
+WPSLIB WPSResult WPSDocument::parse(char const *fileName, librevenge::RVNGSpreadsheetInterface *documentInterface,
+                                    char const *password, char const *encoding)
+{
+	if (!fileName || !documentInterface)
+		return WPS_UNKNOWN_ERROR;
+	WPSMappedFileStream input(fileName);
+	if (!input.isOk())
+		return WPS_FILE_ACCESS_ERROR;
+	return parse(&input, documentInterface, password, encoding);
+}
+
+WPSLIB WPSResult WPSDocument::parse(char const *fileName, librevenge::RVNGSpreadsheetInterface *documentInterface,
+                                    WPSParseOptions const &options, char const *password, char const *encoding)
+{
+	if (!fileName || !documentInterface)
+		return WPS_UNKNOWN_ERROR;
+	WPSMappedFileStream input(fileName);
+	if (!input.isOk())
+		return WPS_FILE_ACCESS_ERROR;
+	return parse(&input, documentInterface, options, password, encoding);
+}
 /* vim:set shiftwidth=4 softtabstop=4 noexpandtab: */
@@ -0,0 +1,137 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* libwps
+ * Version: MPL 2.0 / LGPLv2.1+
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * For minor contributions see the git repository.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU Lesser General Public License Version 2.1 or later
+ * (LGPLv2.1+), in which case the provisions of the LGPLv2.1+ are
+ * applicable instead of those above.
+ *
+ * For further information visit http://libwps.sourceforge.net
+ */
+
+#ifndef WPS_FOD_INDEX_H
+#define WPS_FOD_INDEX_H
+
+#include <algorithm>
+#include <vector>
+
+//! structure which retrieves data information which correspond to a text position
+struct WPSFOD
+{
+	/** different type which can be associated to a text position
+	 *
+	 * ATTR_TEXT: all text attributes (font, size, ...)
+	 * ATTR_PARAG: all paragraph attributes (margin, tabs, ...)
+	 * ATTR_PLC: other attribute (note, fields ... )
+	 */
+	enum Type { ATTR_TEXT, ATTR_PARAG, ATTR_PLC, ATTR_UNKN };
+
+	//! the constructor
+	WPSFOD() : m_type(ATTR_UNKN), m_pos(-1), m_defPos(0), m_id(-1) {}
+
+	//! the type of the attribute
+	Type m_type;
+	//! the offset position of the text modified by this attribute
+	long m_pos;
+	//! the offset position of the definition of the attribute in the file
+	long m_defPos;
+	//! an identificator (which must be unique by category)
+	int m_id;
+};
+
+/** the list of attributes of a text, sorted by text position.
+
+	The text positions are also stored in a separated array, so that the
+	searches and the loops which look for the next attribute change only
+	read contiguous positions. */
+class WPSFODIndex
+{
+public:
+	//! constructor
+	WPSFODIndex() : m_FODs(), m_positions()
+	{
+	}
+	//! returns the number of attributes
+	size_t size() const
+	{
+		return m_FODs.size();
+	}
+	//! returns true if there is no attribute
+	bool empty() const
+	{
+		return m_FODs.empty();
+	}
+	//! returns the attribute i
+	WPSFOD const &operator[](size_t i) const
+	{
+		return m_FODs[i];
+	}
+	//! returns the text position of the attribute i
+	long position(size_t i) const
+	{
+		return m_positions[i];
+	}
+	//! returns the index of the first attribute whose position is greater or equal to pos
+	size_t findFirst(long pos) const
+	{
+		return size_t(std::lower_bound(m_positions.begin(), m_positions.end(), pos)-m_positions.begin());
+	}
+	/** merges a sorted list of attribute (by text position).
+
+	    The attributes whose position is not in [minPos, maxPos] are ignored.
+	    If before is set, the new attributes are placed before the existing
+	    attributes with the same position; otherwise, after them. */
+	void merge(std::vector<WPSFOD> const &lst, long minPos, long maxPos, bool before)
+	{
+		size_t const numOld = m_FODs.size();
+		m_FODs.reserve(numOld+lst.size());
+		for (size_t i = 0; i < lst.size(); ++i)
+		{
+			WPSFOD const &fod = lst[i];
+			if (fod.m_pos < minPos || fod.m_pos > maxPos)
+				continue;
+			m_FODs.push_back(fod);
+		}
+		size_t const numNew = m_FODs.size()-numOld;
+		if (numNew == 0) return;
+		if (numOld)
+		{
+			// the merge is stable, so the first sequence must contain the attributes which must be sent first
+			std::vector<WPSFOD>::iterator mid = m_FODs.begin()+long(numOld);
+			if (before)
+			{
+				std::rotate(m_FODs.begin(), mid, m_FODs.end());
+				mid = m_FODs.begin()+long(numNew);
+			}
+			std::inplace_merge(m_FODs.begin(), mid, m_FODs.end(), PosLess());
+		}
+		m_positions.resize(m_FODs.size());
+		for (size_t i = 0; i < m_FODs.size(); ++i)
+			m_positions[i] = m_FODs[i].m_pos;
+	}
+
+protected:
+	//! small functor used to sort the attributes by text position
+	struct PosLess
+	{
+		//! compares the position of two attributes
+		bool operator()(WPSFOD const &fod1, WPSFOD const &fod2) const
+		{
+			return fod1.m_pos < fod2.m_pos;
+		}
+	};
+	//! the attributes
+	std::vector<WPSFOD> m_FODs;
+	//! the text position of each attribute
+	std::vector<long> m_positions;
+};
+
+#endif /* WPS_FOD_INDEX_H */
+/* vim:set shiftwidth=4 softtabstop=4 noexpandtab: */
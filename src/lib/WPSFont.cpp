@@ -23,6 +23,8 @@
  * For further information visit http://libwps.sourceforge.net
  */
 
+#include <string.h>
+
 #include <librevenge/librevenge.h>
 
 #include "libwps_internal.h"
@@ -78,6 +80,23 @@ bool WPSFont::operator==(WPSFont const &ft) const
 	return true;
 }
 
+int WPSFont::cmp(WPSFont const &ft) const
+{
+	if (m_size < ft.m_size) return -1;
+	if (m_size > ft.m_size) return 1;
+	if (m_attributes != ft.m_attributes) return m_attributes < ft.m_attributes ? -1 : 1;
+	if (m_color < ft.m_color) return -1;
+	if (m_color > ft.m_color) return 1;
+	if (m_spacing < ft.m_spacing) return -1;
+	if (m_spacing > ft.m_spacing) return 1;
+	if (m_languageId != ft.m_languageId) return m_languageId < ft.m_languageId ? -1 : 1;
+	int diff = strcmp(m_name.cstr(), ft.m_name.cstr());
+	if (diff) return diff < 0 ? -1 : 1;
+	diff = m_extra.compare(ft.m_extra);
+	if (diff) return diff < 0 ? -1 : 1;
+	return 0;
+}
+
 void WPSFont::addTo(librevenge::RVNGPropertyList &propList) const
 {
 	double fontSizeChange = 1.0;
@@ -67,6 +67,8 @@ public:
 	{
 		return !operator==(ft);
 	}
+	//! a comparison function: returns -1, 0 or 1
+	int cmp(WPSFont const &ft) const;
 
 	//! font name
 	librevenge::RVNGString m_name;
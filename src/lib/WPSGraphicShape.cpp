@@ -386,12 +386,14 @@ WPSGraphicShape::Command WPSGraphicShape::addTo(Vec2f const &orig, bool asSurfac
 		float angl1=m_arcAngles[1];
 		if (rad[1]<0)
 		{
+#ifdef DEBUG
 			static bool first=true;
 			if (first)
 			{
 				WPS_DEBUG_MSG(("WPSGraphicShape::addTo: oops radiusY for arc is negative, inverse it\n"));
 				first=false;
 			}
+#endif
 			rad[1]=-rad[1];
 		}
 		while (angl1<angl0)
@@ -546,12 +548,14 @@ std::vector<WPSGraphicShape::PathData> WPSGraphicShape::getPath() const
 		float angl1=m_arcAngles[1];
 		if (rad[1]<0)
 		{
+#ifdef DEBUG
 			static bool first=true;
 			if (first)
 			{
 				WPS_DEBUG_MSG(("WPSGraphicShape::getPath: oops radiusY for arc is negative, inverse it\n"));
 				first=false;
 			}
+#endif
 			rad[1]=-rad[1];
 		}
 		while (angl1<angl0)
@@ -167,12 +167,14 @@ void WPSGraphicStyle::addTo(librevenge::RVNGPropertyList &list, bool only1D) con
 			float sz=m_lineDashWidth[c++];
 			if (nDots2 && (sz<size2||sz>size2))
 			{
+#ifdef DEBUG
 				static bool first=true;
 				if (first)
 				{
 					WPS_DEBUG_MSG(("WPSGraphicStyle::addTo: can set all dash\n"));
 					first = false;
 				}
+#endif
 				break;
 			}
 			if (nDots2)
@@ -165,8 +165,7 @@ void WPSList::addLevelTo(int level, librevenge::RVNGPropertyList &propList) cons
 	if (m_id==-1)
 	{
 		WPS_DEBUG_MSG(("WPSList::addLevelTo: the list id is not set\n"));
-		static int falseId = 1000;
-		m_id = falseId++;
+		m_id = 1000;
 	}
 	propList.insert("librevenge:list-id", m_id);
 	propList.insert("librevenge:level", level);
@@ -0,0 +1,187 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* libwps
+ * Version: MPL 2.0 / LGPLv2.1+
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * For minor contributions see the git repository.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU Lesser General Public License Version 2.1 or later
+ * (LGPLv2.1+), in which case the provisions of the LGPLv2.1+ are
+ * applicable instead of those above.
+ *
+ * For further information visit http://libwps.sourceforge.net
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+#include "libwps_internal.h"
+
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define WPS_USE_MMAP 1
+#endif
+
+#include "WPSMappedFileStream.h"
+
+WPSMappedFileStream::WPSMappedFileStream(char const *fileName) :
+	librevenge::RVNGInputStream(), m_fileName(fileName ? fileName : ""), m_data(0), m_size(0), m_offset(0),
+	m_isEmpty(false), m_isMapped(false), m_buffer(), m_oleChecked(false), m_oleStream()
+{
+	if (m_fileName.empty()) return;
+#ifdef WPS_USE_MMAP
+	int fd=open(m_fileName.c_str(), O_RDONLY);
+	if (fd<0)
+	{
+		WPS_DEBUG_MSG(("WPSMappedFileStream::WPSMappedFileStream: can not open %s\n", m_fileName.c_str()));
+		return;
+	}
+	struct stat status;
+	if (fstat(fd, &status)==0 && S_ISREG(status.st_mode))
+	{
+		if (status.st_size==0)
+			m_isEmpty=true;
+		else
+		{
+			void *ptr=mmap(0, size_t(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			if (ptr!=MAP_FAILED)
+			{
+				m_data=static_cast<unsigned char const *>(ptr);
+				m_size=(unsigned long) status.st_size;
+				m_isMapped=true;
+			}
+		}
+	}
+	close(fd);
+	if (m_data || m_isEmpty) return;
+#endif
+	// no mmap: read the file in memory
+	FILE *file=fopen(m_fileName.c_str(), "rb");
+	if (!file)
+	{
+		WPS_DEBUG_MSG(("WPSMappedFileStream::WPSMappedFileStream: can not open %s\n", m_fileName.c_str()));
+		return;
+	}
+	unsigned char buffer[4096];
+	size_t numRead;
+	while ((numRead=fread(buffer, 1, sizeof(buffer), file))>0)
+		m_buffer.insert(m_buffer.end(), buffer, buffer+numRead);
+	fclose(file);
+	if (m_buffer.empty())
+		m_isEmpty=true;
+	else
+	{
+		m_data=&m_buffer[0];
+		m_size=(unsigned long) m_buffer.size();
+	}
+}
+
+WPSMappedFileStream::~WPSMappedFileStream()
+{
+#ifdef WPS_USE_MMAP
+	if (m_isMapped && m_data)
+		munmap(const_cast<unsigned char *>(m_data), size_t(m_size));
+#endif
+}
+
+const unsigned char *WPSMappedFileStream::read(unsigned long numBytes, unsigned long &numBytesRead)
+{
+	numBytesRead=0;
+	if (!numBytes || !m_data || m_offset>=m_size)
+		return 0;
+	numBytesRead=m_size-m_offset;
+	if (numBytes<numBytesRead) numBytesRead=numBytes;
+	unsigned char const *res=m_data+m_offset;
+	m_offset+=numBytesRead;
+	return res;
+}
+
+int WPSMappedFileStream::seek(long offset, librevenge::RVNG_SEEK_TYPE seekType)
+{
+	long newOffset=offset;
+	if (seekType==librevenge::RVNG_SEEK_CUR)
+		newOffset+=long(m_offset);
+	else if (seekType==librevenge::RVNG_SEEK_END)
+		newOffset+=long(m_size);
+	// as RVNGFileStream, we go to the nearest valid position
+	if (newOffset<0)
+	{
+		m_offset=0;
+		return 1;
+	}
+	if ((unsigned long) newOffset>m_size)
+	{
+		m_offset=m_size;
+		return 1;
+	}
+	m_offset=(unsigned long) newOffset;
+	return 0;
+}
+
+long WPSMappedFileStream::tell()
+{
+	return long(m_offset);
+}
+
+bool WPSMappedFileStream::isEnd()
+{
+	return m_offset>=m_size;
+}
+
+librevenge::RVNGInputStream *WPSMappedFileStream::getOLEStream()
+{
+	if (!m_oleChecked)
+	{
+		m_oleChecked=true;
+		static unsigned char const oleSignature[]= { 0xd0, 0xcf, 0x11, 0xe0, 0xa1, 0xb1, 0x1a, 0xe1 };
+		if (m_data && m_size>=512 && memcmp(m_data, oleSignature, sizeof(oleSignature))==0)
+			m_oleStream.reset(new librevenge::RVNGFileStream(m_fileName.c_str()));
+	}
+	return m_oleStream.get();
+}
+
+bool WPSMappedFileStream::isStructured()
+{
+	librevenge::RVNGInputStream *ole=getOLEStream();
+	return ole && ole->isStructured();
+}
+
+unsigned WPSMappedFileStream::subStreamCount()
+{
+	librevenge::RVNGInputStream *ole=getOLEStream();
+	return ole ? ole->subStreamCount() : 0;
+}
+
+const char *WPSMappedFileStream::subStreamName(unsigned id)
+{
+	librevenge::RVNGInputStream *ole=getOLEStream();
+	return ole ? ole->subStreamName(id) : 0;
+}
+
+bool WPSMappedFileStream::existsSubStream(const char *name)
+{
+	librevenge::RVNGInputStream *ole=getOLEStream();
+	return ole && ole->existsSubStream(name);
+}
+
+librevenge::RVNGInputStream *WPSMappedFileStream::getSubStreamByName(const char *name)
+{
+	librevenge::RVNGInputStream *ole=getOLEStream();
+	return ole ? ole->getSubStreamByName(name) : 0;
+}
+
+librevenge::RVNGInputStream *WPSMappedFileStream::getSubStreamById(unsigned id)
+{
+	librevenge::RVNGInputStream *ole=getOLEStream();
+	return ole ? ole->getSubStreamById(id) : 0;
+}
+/* vim:set shiftwidth=4 softtabstop=4 noexpandtab: */
@@ -0,0 +1,97 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* libwps
+ * Version: MPL 2.0 / LGPLv2.1+
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * For minor contributions see the git repository.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU Lesser General Public License Version 2.1 or later
+ * (LGPLv2.1+), in which case the provisions of the LGPLv2.1+ are
+ * applicable instead of those above.
+ *
+ * For further information visit http://libwps.sourceforge.net
+ */
+
+#ifndef WPS_MAPPED_FILE_STREAM_H
+#define WPS_MAPPED_FILE_STREAM_H
+
+#include <vector>
+
+#include "libwps_internal.h"
+
+/** an input stream which maps a local file in memory, so that read returns
+	pointers directly in the file's data without any copy.
+
+	\note if the system does not support mmap, the file is read in memory.
+	\note the OLE structure (isStructured, getSubStreamByName, ...) is
+	delegated to a librevenge::RVNGFileStream which is only created when needed.
+ */
+class WPSMappedFileStream : public librevenge::RVNGInputStream
+{
+public:
+	//! constructor
+	explicit WPSMappedFileStream(char const *fileName);
+	//! destructor
+	~WPSMappedFileStream();
+	//! returns true if the file has been opened
+	bool isOk() const
+	{
+		return m_data!=0 || m_isEmpty;
+	}
+
+	//! returns true if the file is an OLE file
+	bool isStructured();
+	//! returns the number of sub streams
+	unsigned subStreamCount();
+	//! returns the name of the id-th sub stream
+	const char *subStreamName(unsigned id);
+	//! returns true if a sub stream exists
+	bool existsSubStream(const char *name);
+	//! returns a new stream corresponding to a sub stream
+	librevenge::RVNGInputStream *getSubStreamByName(const char *name);
+	//! returns a new stream corresponding to the id-th sub stream
+	librevenge::RVNGInputStream *getSubStreamById(unsigned id);
+
+	//! returns a pointer to the next numBytes of the file ( no copy )
+	const unsigned char *read(unsigned long numBytes, unsigned long &numBytesRead);
+	//! changes the actual position
+	int seek(long offset, librevenge::RVNG_SEEK_TYPE seekType);
+	//! returns the actual position
+	long tell();
+	//! returns true if we are at the end of the file
+	bool isEnd();
+
+protected:
+	//! returns the OLE stream or 0 if the file is not an OLE file
+	librevenge::RVNGInputStream *getOLEStream();
+
+	//! the file name
+	std::string m_fileName;
+	//! a pointer to the file data
+	unsigned char const *m_data;
+	//! the file size
+	unsigned long m_size;
+	//! the actual position
+	unsigned long m_offset;
+	//! a flag to know if the file is empty
+	bool m_isEmpty;
+	//! a flag to know if the data are mapped
+	bool m_isMapped;
+	//! the file content when mmap is not available
+	std::vector<unsigned char> m_buffer;
+	//! a flag to know if we have checked for an OLE file
+	bool m_oleChecked;
+	//! the stream used to retrieve the OLE structure
+	shared_ptr<librevenge::RVNGInputStream> m_oleStream;
+
+private:
+	WPSMappedFileStream(WPSMappedFileStream const &orig);
+	WPSMappedFileStream &operator=(WPSMappedFileStream const &orig);
+};
+
+#endif
+/* vim:set shiftwidth=4 softtabstop=4 noexpandtab: */
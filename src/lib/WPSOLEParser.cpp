@@ -225,11 +225,24 @@ struct OleDef
 	int m_id /**main id*/, m_subId /**subsversion id */ ;
 	std::string m_dir/**the directory*/, m_name/**the base name*/;
 };
+
+/** Internal: the list of OLEs of a file grouped by object id */
+struct Index
+{
+	//! constructor
+	Index() : m_input(), m_idToOleMap(), m_idsList() { }
+	//! the file input
+	RVNGInputStreamPtr m_input;
+	//! a multimap object id to OLE definition
+	std::multimap<int, OleDef> m_idToOleMap;
+	//! the list of object ids (in the file order)
+	std::vector<int> m_idsList;
+};
 }
 
 // constructor/destructor
 WPSOLEParser::WPSOLEParser(const std::string &mainName)
-	: m_avoidOLE(mainName), m_unknownOLEs(), m_objects(), m_objectsId(), m_compObjIdName()
+	: m_avoidOLE(mainName), m_unknownOLEs(), m_objects(), m_objectsId(), m_compObjIdName(), m_index()
 {
 }
 
@@ -239,22 +252,39 @@ WPSOLEParser::~WPSOLEParser()
 
 // parsing
 bool WPSOLEParser::parse(RVNGInputStreamPtr file)
+{
+	m_objects.resize(0);
+	m_objectsId.resize(0);
+	if (!index(file)) return false;
+
+	std::vector<int> const &listIds=getIndexedObjectsId();
+	for (size_t i = 0; i < listIds.size(); i++)
+	{
+		WPSOLEParserObject object;
+		if (!readObject(listIds[i], object)) continue;
+		m_objects.push_back(object);
+		m_objectsId.push_back(listIds[i]);
+	}
+	return true;
+}
+
+bool WPSOLEParser::index(RVNGInputStreamPtr file)
 {
 	if (!m_compObjIdName)
 		m_compObjIdName.reset(new WPSOLEParserInternal::CompObj);
 
 	m_unknownOLEs.resize(0);
-	m_objects.resize(0);
-	m_objectsId.resize(0);
+	m_index.reset(new WPSOLEParserInternal::Index);
 
 	if (!file || !file->isStructured()) return false;
+	m_index->m_input=file;
 
 	unsigned numSubStreams = file->subStreamCount();
 	//
 	// we begin by grouping the Ole by their potential main id
 	//
-	std::multimap<int, WPSOLEParserInternal::OleDef> listsById;
-	std::vector<int> listIds;
+	std::multimap<int, WPSOLEParserInternal::OleDef> &listsById=m_index->m_idToOleMap;
+	std::vector<int> &listIds=m_index->m_idsList;
 	for (unsigned i = 0; i < numSubStreams; ++i)
 	{
 		char const *nm=file->subStreamName(i);
@@ -314,133 +344,141 @@ bool WPSOLEParser::parse(RVNGInputStreamPtr file)
 		listsById.insert(std::multimap<int, WPSOLEParserInternal::OleDef>::value_type(data.m_id, data));
 	}
 
-	for (size_t i = 0; i < listIds.size(); i++)
+	return true;
+}
+
+std::vector<int> WPSOLEParser::getIndexedObjectsId() const
+{
+	if (!m_index) return std::vector<int>();
+	return m_index->m_idsList;
+}
+
+bool WPSOLEParser::readObject(int id, WPSOLEParserObject &object)
+{
+	if (!m_index || !m_index->m_input)
 	{
-		int id = listIds[i];
+		WPS_DEBUG_MSG(("WPSOLEParser::readObject: the OLEs are not indexed\n"));
+		return false;
+	}
+	std::multimap<int, WPSOLEParserInternal::OleDef>::iterator pos =
+	    m_index->m_idToOleMap.lower_bound(id);
 
-		std::multimap<int, WPSOLEParserInternal::OleDef>::iterator pos =
-		    listsById.lower_bound(id);
+	// try to find a representation for each id
+	// FIXME: maybe we must also find some for each subid
+	WPSOLEParserObject &pict=object;
+	pict=WPSOLEParserObject();
+	int confidence = -1000;
+	WPSPosition potentialSize;
 
-		// try to find a representation for each id
-		// FIXME: maybe we must also find some for each subid
-		WPSOLEParserObject pict;
-		int confidence = -1000;
-		WPSPosition potentialSize;
+	while (pos != m_index->m_idToOleMap.end())
+	{
+		WPSOLEParserInternal::OleDef const &dOle = pos->second;
+		if (pos->first != id) break;
+		++pos;
 
-		while (pos != listsById.end())
+		RVNGInputStreamPtr ole(m_index->m_input->getSubStreamByName(dOle.m_name.c_str()));
+		if (!ole)
 		{
-			WPSOLEParserInternal::OleDef const &dOle = pos->second;
-			if (pos->first != id) break;
-			++pos;
-
-			RVNGInputStreamPtr ole(file->getSubStreamByName(dOle.m_name.c_str()));
-			if (!ole)
-			{
-				WPS_DEBUG_MSG(("WPSOLEParser: error: can not find OLE part: \"%s\"\n", dOle.m_name.c_str()));
-				continue;
-			}
+			WPS_DEBUG_MSG(("WPSOLEParser: error: can not find OLE part: \"%s\"\n", dOle.m_name.c_str()));
+			continue;
+		}
 
-			libwps::DebugFile asciiFile(ole);
-			asciiFile.open(dOle.m_name);
+		libwps::DebugFile asciiFile(ole);
+		asciiFile.open(dOle.m_name);
 
-			librevenge::RVNGBinaryData data;
-			bool hasData = false;
-			int newConfidence = -2000;
-			std::string mime("image/pict");
-			bool ok = true;
-			WPSPosition pictPos;
+		librevenge::RVNGBinaryData data;
+		bool hasData = false;
+		int newConfidence = -2000;
+		std::string mime("image/pict");
+		bool ok = true;
+		WPSPosition pictPos;
 
-			try
+		try
+		{
+			if (readMM(ole, dOle.m_dir, asciiFile));
+			else if (readObjInfo(ole, dOle.m_dir, asciiFile));
+			else if (readOle(ole, dOle.m_dir, asciiFile));
+			else if (readMN0AndCheckWKS(ole, dOle.m_dir, data, asciiFile))
 			{
-				if (readMM(ole, dOle.m_dir, asciiFile));
-				else if (readObjInfo(ole, dOle.m_dir, asciiFile));
-				else if (readOle(ole, dOle.m_dir, asciiFile));
-				else if (readMN0AndCheckWKS(ole, dOle.m_dir, data, asciiFile))
-				{
-					hasData = true;
-					newConfidence = 10;
-					mime="image/wks-ods";
-				}
-				else if (isOlePres(ole, dOle.m_dir) &&
-				         readOlePres(ole, data, pictPos, asciiFile))
-				{
-					hasData = true;
-					newConfidence = 2;
-				}
-				else if (isOle10Native(ole, dOle.m_dir) &&
-				         readOle10Native(ole, data, asciiFile))
-				{
-					hasData = true;
-					// small size can be a symptom that this is a link to a
-					// basic msworks data file, so we reduce confidence
-					newConfidence = data.size() > 1000 ? 4 : 2;
-				}
-				else if (readCompObj(ole, dOle.m_dir, asciiFile));
-				else if (readContents(ole, dOle.m_dir, data, pictPos, asciiFile))
-				{
-					hasData = true;
-					newConfidence = 3;
-				}
-				else if (readCONTENTS(ole, dOle.m_dir, data, pictPos, asciiFile))
-				{
-					hasData = true;
-					newConfidence = 3;
-				}
-				else
-					ok = false;
+				hasData = true;
+				newConfidence = 10;
+				mime="image/wks-ods";
 			}
-			catch (...)
+			else if (isOlePres(ole, dOle.m_dir) &&
+			         readOlePres(ole, data, pictPos, asciiFile))
 			{
-				ok = false;
+				hasData = true;
+				newConfidence = 2;
 			}
-			if (!ok)
+			else if (isOle10Native(ole, dOle.m_dir) &&
+			         readOle10Native(ole, data, asciiFile))
 			{
-				m_unknownOLEs.push_back(dOle.m_name);
-				asciiFile.reset();
-				continue;
+				hasData = true;
+				// small size can be a symptom that this is a link to a
+				// basic msworks data file, so we reduce confidence
+				newConfidence = data.size() > 1000 ? 4 : 2;
 			}
-
-			if (hasData && data.size())
+			else if (readCompObj(ole, dOle.m_dir, asciiFile));
+			else if (readContents(ole, dOle.m_dir, data, pictPos, asciiFile))
 			{
-				// probably only a subs data
-				if (dOle.m_subId != -1) newConfidence -= 10;
-
-				if (newConfidence > confidence ||
-				        (newConfidence == confidence && pict.m_data.size() < data.size()))
-				{
-					confidence = newConfidence;
-					pict.m_data = data;
-					pict.m_position = pictPos;
-					pict.m_mime = mime;
-				}
-
-				if (pict.m_position.naturalSize().x() > 0 && pict.m_position.naturalSize().y() > 0)
-					potentialSize = pict.m_position;
-#ifdef DEBUG_WITH_FILES
-				libwps::Debug::dumpFile(data, dOle.m_name.c_str());
-#endif
+				hasData = true;
+				newConfidence = 3;
 			}
-
+			else if (readCONTENTS(ole, dOle.m_dir, data, pictPos, asciiFile))
+			{
+				hasData = true;
+				newConfidence = 3;
+			}
+			else
+				ok = false;
+		}
+		catch (...)
+		{
+			ok = false;
+		}
+		if (!ok)
+		{
+			m_unknownOLEs.push_back(dOle.m_name);
 			asciiFile.reset();
-
-#ifndef DEBUG
-			if (confidence >= 3) break;
-#endif
+			continue;
 		}
 
-		if (pict.m_data.size())
+		if (hasData && data.size())
 		{
-			m_objects.push_back(pict);
-			if (pict.m_position.naturalSize().x() <= 0. || pict.m_position.naturalSize().y() <= 0.)
+			// probably only a subs data
+			if (dOle.m_subId != -1) newConfidence -= 10;
+
+			if (newConfidence > confidence ||
+			        (newConfidence == confidence && pict.m_data.size() < data.size()))
 			{
-				Vec2f size = potentialSize.naturalSize();
-				if (size.x() > 0 && size.y() > 0)
-					pict.m_position.setNaturalSize(pict.m_position.getInvUnitScale(potentialSize.unit())*size);
+				confidence = newConfidence;
+				pict.m_data = data;
+				pict.m_position = pictPos;
+				pict.m_mime = mime;
 			}
-			m_objectsId.push_back(id);
+
+			if (pict.m_position.naturalSize().x() > 0 && pict.m_position.naturalSize().y() > 0)
+				potentialSize = pict.m_position;
+#ifdef DEBUG_WITH_FILES
+			libwps::Debug::dumpFile(data, dOle.m_name.c_str());
+#endif
 		}
+
+		asciiFile.reset();
+
+#ifndef DEBUG
+		if (confidence >= 3) break;
+#endif
 	}
 
+	if (!pict.m_data.size())
+		return false;
+	if (pict.m_position.naturalSize().x() <= 0. || pict.m_position.naturalSize().y() <= 0.)
+	{
+		Vec2f size = potentialSize.naturalSize();
+		if (size.x() > 0 && size.y() > 0)
+			pict.m_position.setNaturalSize(pict.m_position.getInvUnitScale(potentialSize.unit())*size);
+	}
 	return true;
 }
 
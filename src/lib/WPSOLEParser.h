@@ -73,6 +73,7 @@ class Storage;
 namespace WPSOLEParserInternal
 {
 class CompObj;
+struct Index;
 }
 
 /** small struct to store an object */
@@ -107,6 +108,16 @@ public:
 	    \return false if fileInput is not an Ole file */
 	bool parse(RVNGInputStreamPtr fileInput);
 
+	/** only groups the OLEs of fileInput by object id, ie. does not
+	    decode them (see readObject)
+	    \return false if fileInput is not an Ole file */
+	bool index(RVNGInputStreamPtr fileInput);
+	//! returns the list of object ids found by index
+	std::vector<int> getIndexedObjectsId() const;
+	/** tries to decode the object corresponding to an indexed id
+	    \return false if no representation is found */
+	bool readObject(int id, WPSOLEParserObject &object);
+
 	//! returns the list of unknown ole
 	std::vector<std::string> const &getNotParse() const
 	{
@@ -180,6 +191,8 @@ protected:
 
 	//! a smart ptr used to stored the list of compobj id->name
 	shared_ptr<WPSOLEParserInternal::CompObj> m_compObjIdName;
+	//! the list of OLEs grouped by id
+	shared_ptr<WPSOLEParserInternal::Index> m_index;
 
 };
 
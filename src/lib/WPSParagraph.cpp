@@ -251,24 +251,28 @@ void WPSParagraph::addTo(librevenge::RVNGPropertyList &propList, bool inTable) c
 			break;
 		if (m_spacings[0] < 0)
 		{
+#ifdef DEBUG
 			static bool first = true;
 			if (first)
 			{
 				WPS_DEBUG_MSG(("WPSParagraph::addTo: interline spacing seems bad\n"));
 				first = false;
 			}
+#endif
 		}
 		else if (m_spacingsInterlineUnit != librevenge::RVNG_PERCENT)
 			propList.insert("style:line-height-at-least", m_spacings[0], m_spacingsInterlineUnit);
 		else
 		{
 			propList.insert("style:line-height-at-least", m_spacings[0]*12.0, librevenge::RVNG_POINT);
+#ifdef DEBUG
 			static bool first = true;
 			if (first)
 			{
 				first = false;
 				WPS_DEBUG_MSG(("WPSParagraph::addTo: assume height=12 to set line spacing at least with percent type\n"));
 			}
+#endif
 		}
 		break;
 	default:
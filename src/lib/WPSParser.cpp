@@ -28,7 +28,7 @@
 #include "WPSParser.h"
 
 WPSParser::WPSParser(RVNGInputStreamPtr &input, WPSHeaderPtr &header) :
-	m_input(input), m_header(header), m_version(0), m_asciiFile(), m_nameMultiMap()
+	m_input(input), m_header(header), m_version(0), m_parseOptions(), m_asciiFile(), m_nameMultiMap()
 {
 	if (header)
 		m_version = header->getMajorVersion();
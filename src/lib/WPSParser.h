@@ -26,6 +26,8 @@
 #include <map>
 #include <string>
 
+#include <libwps/libwps.h>
+
 #include "libwps_internal.h"
 
 #include "WPSDebug.h"
@@ -42,6 +44,16 @@ public:
 	WPSParser(RVNGInputStreamPtr &input, WPSHeaderPtr &header);
 	virtual ~WPSParser();
 	virtual void parse(librevenge::RVNGTextInterface *documentInterface) = 0;
+	//! sets the parsing options (must be called before parse)
+	void setParseOptions(libwps::WPSParseOptions const &options)
+	{
+		m_parseOptions=options;
+	}
+	//! returns the parsing options
+	libwps::WPSParseOptions const &getParseOptions() const
+	{
+		return m_parseOptions;
+	}
 
 protected:
 	RVNGInputStreamPtr &getInput()
@@ -86,6 +98,8 @@ private:
 	WPSHeaderPtr m_header;
 	// the file version
 	int m_version;
+	//! the parsing options
+	libwps::WPSParseOptions m_parseOptions;
 	//! the debug file
 	libwps::DebugFile m_asciiFile;
 
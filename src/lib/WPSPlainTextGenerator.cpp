@@ -0,0 +1,40 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* libwps
+ * Version: MPL 2.0 / LGPLv2.1+
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * For minor contributions see the git repository.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU Lesser General Public License Version 2.1 or later
+ * (LGPLv2.1+), in which case the provisions of the LGPLv2.1+ are
+ * applicable instead of those above.
+ *
+ * For further information visit http://libwps.sourceforge.net
+ */
+
+#include "WPSPlainTextGenerator.h"
+
+WPSPlainTextGenerator::WPSPlainTextGenerator(librevenge::RVNGString &text) : m_text(text), m_numIgnored(0)
+{
+}
+
+WPSPlainTextGenerator::~WPSPlainTextGenerator()
+{
+}
+
+void WPSPlainTextGenerator::insertText(const librevenge::RVNGString &text)
+{
+	if (m_numIgnored>0) return;
+	m_text.append(text);
+}
+
+void WPSPlainTextGenerator::append(char c)
+{
+	if (m_numIgnored>0) return;
+	m_text.append(c);
+}
+/* vim:set shiftwidth=4 softtabstop=4 noexpandtab: */
@@ -0,0 +1,154 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* libwps
+ * Version: MPL 2.0 / LGPLv2.1+
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * For minor contributions see the git repository.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU Lesser General Public License Version 2.1 or later
+ * (LGPLv2.1+), in which case the provisions of the LGPLv2.1+ are
+ * applicable instead of those above.
+ *
+ * For further information visit http://libwps.sourceforge.net
+ */
+
+#ifndef WPSPLAINTEXTGENERATOR_H
+#define WPSPLAINTEXTGENERATOR_H
+
+#include <librevenge/librevenge.h>
+
+/** a minimal text interface which only appends the characters of a document
+	in a UTF-8 string: the properties are ignored, each paragraph and each table row
+	ends with a line break, each table cell with a tab.
+
+	\note the headers and the footers are skipped */
+class WPSPlainTextGenerator : public librevenge::RVNGTextInterface
+{
+public:
+	//! constructor given the string to fill
+	explicit WPSPlainTextGenerator(librevenge::RVNGString &text);
+	//! destructor
+	virtual ~WPSPlainTextGenerator();
+
+	virtual void setDocumentMetaData(const librevenge::RVNGPropertyList &) {}
+	virtual void startDocument(const librevenge::RVNGPropertyList &) {}
+	virtual void endDocument() {}
+	virtual void defineEmbeddedFont(const librevenge::RVNGPropertyList &) {}
+
+	virtual void definePageStyle(const librevenge::RVNGPropertyList &) {}
+	virtual void openPageSpan(const librevenge::RVNGPropertyList &) {}
+	virtual void closePageSpan() {}
+	virtual void openHeader(const librevenge::RVNGPropertyList &)
+	{
+		++m_numIgnored;
+	}
+	virtual void closeHeader()
+	{
+		--m_numIgnored;
+	}
+	virtual void openFooter(const librevenge::RVNGPropertyList &)
+	{
+		++m_numIgnored;
+	}
+	virtual void closeFooter()
+	{
+		--m_numIgnored;
+	}
+
+	virtual void defineParagraphStyle(const librevenge::RVNGPropertyList &) {}
+	virtual void openParagraph(const librevenge::RVNGPropertyList &) {}
+	virtual void closeParagraph()
+	{
+		append('\n');
+	}
+	virtual void defineCharacterStyle(const librevenge::RVNGPropertyList &) {}
+	virtual void openSpan(const librevenge::RVNGPropertyList &) {}
+	virtual void closeSpan() {}
+	virtual void openLink(const librevenge::RVNGPropertyList &) {}
+	virtual void closeLink() {}
+	virtual void defineSectionStyle(const librevenge::RVNGPropertyList &) {}
+	virtual void openSection(const librevenge::RVNGPropertyList &) {}
+	virtual void closeSection() {}
+
+	virtual void insertTab()
+	{
+		append('\t');
+	}
+	virtual void insertSpace()
+	{
+		append(' ');
+	}
+	virtual void insertText(const librevenge::RVNGString &text);
+	virtual void insertLineBreak()
+	{
+		append('\n');
+	}
+	virtual void insertField(const librevenge::RVNGPropertyList &) {}
+
+	virtual void openOrderedListLevel(const librevenge::RVNGPropertyList &) {}
+	virtual void openUnorderedListLevel(const librevenge::RVNGPropertyList &) {}
+	virtual void closeOrderedListLevel() {}
+	virtual void closeUnorderedListLevel() {}
+	virtual void openListElement(const librevenge::RVNGPropertyList &) {}
+	virtual void closeListElement()
+	{
+		append('\n');
+	}
+
+	virtual void openFootnote(const librevenge::RVNGPropertyList &) {}
+	virtual void closeFootnote() {}
+	virtual void openEndnote(const librevenge::RVNGPropertyList &) {}
+	virtual void closeEndnote() {}
+	virtual void openComment(const librevenge::RVNGPropertyList &) {}
+	virtual void closeComment() {}
+	virtual void openTextBox(const librevenge::RVNGPropertyList &) {}
+	virtual void closeTextBox() {}
+
+	virtual void openTable(const librevenge::RVNGPropertyList &) {}
+	virtual void openTableRow(const librevenge::RVNGPropertyList &) {}
+	virtual void closeTableRow()
+	{
+		append('\n');
+	}
+	virtual void openTableCell(const librevenge::RVNGPropertyList &) {}
+	virtual void closeTableCell()
+	{
+		append('\t');
+	}
+	virtual void insertCoveredTableCell(const librevenge::RVNGPropertyList &) {}
+	virtual void closeTable() {}
+
+	virtual void openFrame(const librevenge::RVNGPropertyList &) {}
+	virtual void closeFrame() {}
+	virtual void insertBinaryObject(const librevenge::RVNGPropertyList &) {}
+	virtual void insertEquation(const librevenge::RVNGPropertyList &) {}
+	virtual void openGroup(const librevenge::RVNGPropertyList &) {}
+	virtual void closeGroup() {}
+	virtual void defineGraphicStyle(const librevenge::RVNGPropertyList &) {}
+	virtual void drawRectangle(const librevenge::RVNGPropertyList &) {}
+	virtual void drawEllipse(const librevenge::RVNGPropertyList &) {}
+	virtual void drawPolygon(const librevenge::RVNGPropertyList &) {}
+	virtual void drawPolyline(const librevenge::RVNGPropertyList &) {}
+	virtual void drawPath(const librevenge::RVNGPropertyList &) {}
+	virtual void drawConnector(const librevenge::RVNGPropertyList &) {}
+
+protected:
+	//! appends a character if we are not in a header/footer
+	void append(char c);
+
+	//! the result
+	librevenge::RVNGString &m_text;
+	//! the number of opened headers/footers
+	int m_numIgnored;
+
+private:
+	WPSPlainTextGenerator(WPSPlainTextGenerator const &orig);
+	WPSPlainTextGenerator &operator=(WPSPlainTextGenerator const &orig);
+};
+
+#endif /* WPSPLAINTEXTGENERATOR_H */
+/* vim:set shiftwidth=4 softtabstop=4 noexpandtab: */
@@ -124,13 +124,15 @@ bool WPSTextParser::readFDP(WPSEntry const &entry,
 		WPS_DEBUG_MSG(("WPSTextParser::readFDP: FDP error: unknown type = '%s'\n", entry.type().c_str()));
 	}
 
+	// the fcLim and the bfprop arrays are read in one call
+	libwps::BufferedReader arrays(m_input, (unsigned long)(4+(4+deplSize)*static_cast<long>(cfod)));
 	/* Read array of fcLim of FODs.  The fcLim refers to the offset of the
 	   last character covered by the formatting. */
 	for (int i = 0; i <= cfod; ++i)
 	{
 		DataFOD fod;
 		fod.m_type = type;
-		fod.m_pos = (long) libwps::readU32(m_input);
+		fod.m_pos = (long) arrays.readU32();
 		if (fod.m_pos == 0) fod.m_pos=m_textPositions.begin();
 
 		/* check that fcLim is not too large */
@@ -163,7 +165,7 @@ bool WPSTextParser::readFDP(WPSEntry const &entry,
 	f << ", Tpos:defP=(";
 	for (fods_iter = fods.begin() + firstFod; fods_iter!= fods.end(); ++fods_iter)
 	{
-		unsigned depl = deplSize == 1 ? libwps::readU8(m_input) : libwps::readU16(m_input);
+		unsigned depl = deplSize == 1 ? arrays.readU8() : arrays.readU16();
 		/* check size of bfprop  */
 		if ((depl < unsigned(headerSize+(4+deplSize)*cfod) && depl > 0) ||
 		        page_offset+long(depl)  > endPage)
@@ -245,28 +247,13 @@ bool WPSTextParser::readFDP(WPSEntry const &entry,
 	return m_textPositions.end() > lastReadPos;
 }
 
-std::vector<WPSTextParser::DataFOD> WPSTextParser::mergeSortedFODLists
-(std::vector<WPSTextParser::DataFOD> const &lst1,
- std::vector<WPSTextParser::DataFOD> const &lst2) const
+void WPSTextParser::mergeSortedFODList(std::vector<WPSTextParser::DataFOD> const &lst, bool before)
 {
-	std::vector<WPSTextParser::DataFOD> res;
-	// we regroup these two lists in one list
-	size_t num1 = lst1.size(), i1 = 0;
-	size_t num2 = lst2.size(), i2 = 0;
-
-	while (i1 < num1 || i2 < num2)
-	{
-		DataFOD val;
-		if (i2 == num2) val = lst1[i1++];
-		else if (i1 == num1 || lst2[i2].m_pos < lst1[i1].m_pos)
-			val = lst2[i2++];
-		else val = lst1[i1++];
-
-		if (val.m_pos < m_textPositions.begin() || val.m_pos > m_textPositions.end())
-			continue;
+	m_FODList.merge(lst, m_textPositions.begin(), m_textPositions.end(), before);
+}
 
-		res.push_back(val);
-	}
-	return res;
+size_t WPSTextParser::findFirstFOD(long pos) const
+{
+	return m_FODList.findFirst(pos);
 }
 /* vim:set shiftwidth=4 softtabstop=4 noexpandtab: */
@@ -32,6 +32,7 @@
 
 #include "WPSDebug.h"
 #include "WPSEntry.h"
+#include "WPSFODIndex.h"
 
 class WPSParser;
 
@@ -63,33 +64,17 @@ protected:
 
 protected:
 	//! structure which retrieves data information which correspond to a text position
-	struct DataFOD
-	{
-		/** different type which can be associated to a text position
-		 *
-		 * ATTR_TEXT: all text attributes (font, size, ...)
-		 * ATTR_PARAG: all paragraph attributes (margin, tabs, ...)
-		 * ATTR_PLC: other attribute (note, fields ... )
-		 */
-		enum Type { ATTR_TEXT, ATTR_PARAG, ATTR_PLC, ATTR_UNKN };
-
-		//! the constructor
-		DataFOD() : m_type(ATTR_UNKN), m_pos(-1), m_defPos(0), m_id(-1) {}
-
-		//! the type of the attribute
-		Type m_type;
-		//! the offset position of the text modified by this attribute
-		long m_pos;
-		//! the offset position of the definition of the attribute in the file
-		long m_defPos;
-		//! an identificator (which must be unique by category)
-		int m_id;
-	};
-
-	/** function which takes two sorted list of attribute (by text position).
-	    \return a list of attribute */
-	std::vector<DataFOD> mergeSortedFODLists
-	(std::vector<DataFOD> const &lst1, std::vector<DataFOD> const &lst2) const;
+	typedef WPSFOD DataFOD;
+
+	/** merges a sorted list of attribute (by text position) into m_FODList.
+
+	    The attributes which are outside the text zone are ignored. If
+	    before is set, the new attributes are placed before the existing
+	    attributes with the same position; otherwise, after them. */
+	void mergeSortedFODList(std::vector<DataFOD> const &lst, bool before);
+
+	//! returns the index of the first attribute of m_FODList whose position is greater or equal to pos
+	size_t findFirstFOD(long pos) const;
 
 	/** callback when a new attribute is found in an FDPP/FDPC entry
 	 *
@@ -127,7 +112,7 @@ protected:
 	//! an entry which corresponds to the complete text zone
 	WPSEntry m_textPositions;
 	//! the list of a FOD
-	std::vector<DataFOD> m_FODList;
+	WPSFODIndex m_FODList;
 	//! the ascii file
 	libwps::DebugFile &m_asciiFile;
 };
@@ -26,6 +26,7 @@
 #include <cmath>
 #include <cstdarg>
 #include <cstdio>
+#include <cstring>
 #include <iomanip>
 #include <limits>
 #include <sstream>
@@ -35,6 +36,16 @@
 
 #include "libwps_internal.h"
 
+/* the UTF-16LE to UTF-8 conversion uses the widest vector instructions
+   which are enabled at compile time (AVX2, SSE2) to convert the ASCII runs */
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#  define WPS_USE_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define WPS_USE_SSE2 1
+#endif
+
 namespace libwps
 {
 uint8_t readU8(librevenge::RVNGInputStream *input)
@@ -44,12 +55,14 @@ uint8_t readU8(librevenge::RVNGInputStream *input)
 
 	if (!p || numBytesRead != sizeof(uint8_t))
 	{
+#ifdef DEBUG
 		static bool first = true;
 		if (first)
 		{
 			first = false;
 			WPS_DEBUG_MSG(("libwps::readU8: can not read data\n"));
 		}
+#endif
 		return 0;
 	}
 
@@ -63,9 +76,14 @@ int8_t read8(librevenge::RVNGInputStream *input)
 
 uint16_t readU16(librevenge::RVNGInputStream *input)
 {
-	uint8_t p0 = readU8(input);
-	uint8_t p1 = readU8(input);
-	return (uint16_t)(p0|(p1<<8));
+	unsigned long numBytesRead;
+	unsigned char const *p = input->read(sizeof(uint16_t), numBytesRead);
+	if (p && numBytesRead == sizeof(uint16_t))
+		return WPS_LE_GET_GUINT16(p);
+	// short read: decode the available byte, the missing one is 0
+	uint16_t res = (p && numBytesRead) ? uint16_t(p[0]) : 0;
+	readU8(input); // signal the problem
+	return res;
 }
 
 int16_t read16(librevenge::RVNGInputStream *input)
@@ -75,11 +93,19 @@ int16_t read16(librevenge::RVNGInputStream *input)
 
 uint32_t readU32(librevenge::RVNGInputStream *input)
 {
-	uint8_t p0 = readU8(input);
-	uint8_t p1 = readU8(input);
-	uint8_t p2 = readU8(input);
-	uint8_t p3 = readU8(input);
-	return (uint32_t)((p0<<0)|(p1<<8)|(p2<<16)|(p3<<24));
+	unsigned long numBytesRead;
+	unsigned char const *p = input->read(sizeof(uint32_t), numBytesRead);
+	if (p && numBytesRead == sizeof(uint32_t))
+		return WPS_LE_GET_GUINT32(p);
+	// short read: decode the available bytes, the missing ones are 0
+	uint32_t res=0;
+	if (p)
+	{
+		for (unsigned long i=0; i<numBytesRead && i<sizeof(uint32_t); ++i)
+			res |= uint32_t(p[i])<<(8*i);
+	}
+	readU8(input); // signal the problem
+	return res;
 }
 
 int32_t read32(librevenge::RVNGInputStream *input)
@@ -87,6 +113,52 @@ int32_t read32(librevenge::RVNGInputStream *input)
 	return (int32_t) readU32(input);
 }
 
+BufferedReader::BufferedReader(librevenge::RVNGInputStream *input, unsigned long sz) :
+	m_askedSize(sz), m_size(0), m_pos(0), m_buffer(), m_data(m_localBuffer)
+{
+	init(input);
+}
+
+BufferedReader::BufferedReader(RVNGInputStreamPtr &input, unsigned long sz) :
+	m_askedSize(sz), m_size(0), m_pos(0), m_buffer(), m_data(m_localBuffer)
+{
+	init(input.get());
+}
+
+BufferedReader::~BufferedReader()
+{
+}
+
+void BufferedReader::init(librevenge::RVNGInputStream *input)
+{
+	if (!input || !m_askedSize) return;
+	unsigned long numBytesRead;
+	unsigned char const *p = input->read(m_askedSize, numBytesRead);
+	if (!p || !numBytesRead) return;
+	if (numBytesRead > m_askedSize) numBytesRead=m_askedSize;
+	// the stream data are only valid until the next read, so copy them
+	if (numBytesRead > sizeof(m_localBuffer))
+	{
+		m_buffer.assign(p, p+numBytesRead);
+		m_data=&m_buffer[0];
+	}
+	else
+		std::memcpy(m_localBuffer, p, size_t(numBytesRead));
+	m_size=numBytesRead;
+}
+
+void BufferedReader::shortRead()
+{
+#ifdef DEBUG
+	static bool first = true;
+	if (first)
+	{
+		first = false;
+		WPS_DEBUG_MSG(("libwps::BufferedReader: can not read data\n"));
+	}
+#endif
+}
+
 bool readDouble4(RVNGInputStreamPtr &input, double &res, bool &isNaN)
 {
 	isNaN=false;
@@ -532,12 +604,14 @@ bool WPSBorder::addTo(librevenge::RVNGPropertyList &propList, std::string const
 	stream << m_width << "pt ";
 	if (m_type==WPSBorder::Double || m_type==WPSBorder::Triple)
 	{
+#ifdef DEBUG
 		static bool first = true;
 		if (first && m_style!=Simple)
 		{
 			WPS_DEBUG_MSG(("WPSBorder::addTo: find double or tripe border with complex style\n"));
 			first = false;
 		}
+#endif
 		stream << "double";
 	}
 	else
@@ -570,12 +644,14 @@ bool WPSBorder::addTo(librevenge::RVNGPropertyList &propList, std::string const
 		return true;
 	if (m_type!=WPSBorder::Double || numRelWidth!=3)
 	{
+#ifdef DEBUG
 		static bool first = true;
 		if (first)
 		{
 			WPS_DEBUG_MSG(("WPSBorder::addTo: relative width is only implemented with double style\n"));
 			first = false;
 		}
+#endif
 		return true;
 	}
 	double totalWidth=0;
@@ -715,12 +791,13 @@ std::ostream &operator<<(std::ostream &o, WPSEmbeddedObject const &pict)
 ////////////////////////////////////////////////////////////
 namespace libwps
 {
-void appendUnicode(uint32_t val, librevenge::RVNGString &buffer)
+//! converts an unicode character in UTF-8, returns the number of bytes or 0 if the character must be skipped
+static int convertInUTF8(uint32_t val, char *outbuf)
 {
 	if (val < 0x20)
 	{
 		WPS_DEBUG_MSG(("libwps::appendUnicode: find an old char %x, skip it\n", val));
-		return;
+		return 0;
 	}
 	uint8_t first;
 	int len;
@@ -755,7 +832,6 @@ void appendUnicode(uint32_t val, librevenge::RVNGString &buffer)
 		len = 6;
 	}
 
-	char outbuf[7];
 	int i;
 	for (i = len - 1; i > 0; --i)
 	{
@@ -764,7 +840,120 @@ void appendUnicode(uint32_t val, librevenge::RVNGString &buffer)
 	}
 	outbuf[0] = char(val | first);
 	outbuf[len] = 0;
-	buffer.append(outbuf);
+	return len;
+}
+
+void appendUnicode(uint32_t val, librevenge::RVNGString &buffer)
+{
+	char outbuf[7];
+	if (convertInUTF8(val, outbuf))
+		buffer.append(outbuf);
+}
+
+void appendUnicode(uint32_t val, std::string &buffer)
+{
+	if (val < 0x80 && val >= 0x20)
+	{
+		buffer += char(val);
+		return;
+	}
+	char outbuf[7];
+	int len=convertInUTF8(val, outbuf);
+	if (len)
+		buffer.append(outbuf, size_t(len));
+}
+
+//! appends the first ASCII characters (0x20-0x7f) of an UTF-16LE buffer to res, returns the number of converted characters
+static unsigned long appendASCIIUTF16LE(unsigned char const *data, unsigned long numUnits, std::string &res)
+{
+	unsigned long u=0;
+#if defined(WPS_USE_AVX2)
+	__m256i const notASCII=_mm256_set1_epi16(short(0xff80));
+	__m256i const control=_mm256_set1_epi16(0x1f);
+	__m256i const zero=_mm256_setzero_si256();
+	char buffer[16];
+	while (u+16<=numUnits)
+	{
+		__m256i const val=_mm256_loadu_si256(reinterpret_cast<__m256i const *>(data+2*u));
+		__m256i const ok=_mm256_and_si256(_mm256_cmpeq_epi16(_mm256_and_si256(val, notASCII), zero),
+		                                  _mm256_cmpgt_epi16(val, control));
+		if (_mm256_movemask_epi8(ok)!=-1)
+			break;
+		// packus works on each 128 bits lane, so regroup the two lanes
+		__m256i const packed=_mm256_permute4x64_epi64(_mm256_packus_epi16(val, val), 0x08);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(buffer), _mm256_castsi256_si128(packed));
+		res.append(buffer, 16);
+		u+=16;
+	}
+#elif defined(WPS_USE_SSE2)
+	__m128i const notASCII=_mm_set1_epi16(short(0xff80));
+	__m128i const control=_mm_set1_epi16(0x1f);
+	__m128i const zero=_mm_setzero_si128();
+	char buffer[8];
+	while (u+8<=numUnits)
+	{
+		__m128i const val=_mm_loadu_si128(reinterpret_cast<__m128i const *>(data+2*u));
+		__m128i const ok=_mm_and_si128(_mm_cmpeq_epi16(_mm_and_si128(val, notASCII), zero),
+		                               _mm_cmpgt_epi16(val, control));
+		if (_mm_movemask_epi8(ok)!=0xffff)
+			break;
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(buffer), _mm_packus_epi16(val, val));
+		res.append(buffer, 8);
+		u+=8;
+	}
+#endif
+	unsigned long first=u;
+	while (u<numUnits && data[2*u+1]==0 && data[2*u]>=0x20 && data[2*u]<0x80)
+		++u;
+	if (u!=first)
+	{
+		size_t const len=res.size();
+		res.resize(len+size_t(u-first));
+		for (unsigned long c=first; c<u; ++c)
+			res[len+size_t(c-first)]=char(data[2*c]);
+	}
+	return u;
+}
+
+void appendUTF16LE(unsigned char const *data, unsigned long numUnits, std::string &res, uint32_t replaceChar)
+{
+	if (!data || !numUnits) return;
+	res.reserve(res.size()+size_t(numUnits));
+	unsigned long u=0;
+	while (u<numUnits)
+	{
+		u+=appendASCIIUTF16LE(data+2*u, numUnits-u, res);
+		if (u>=numUnits) break;
+		uint32_t val=WPS_LE_GET_GUINT16(data+2*u);
+		++u;
+		if (val>=0xdc00 && val<0xe000)
+		{
+			WPS_DEBUG_MSG(("libwps::appendUTF16LE: error: find low surrogate %x\n", val));
+			val=replaceChar;
+		}
+		else if (val>=0xd800 && val<0xdc00)
+		{
+			if (u>=numUnits)
+			{
+				WPS_DEBUG_MSG(("libwps::appendUTF16LE: error: find high surrogate without low\n"));
+				val=replaceChar;
+			}
+			else
+			{
+				uint32_t lowVal=WPS_LE_GET_GUINT16(data+2*u);
+				++u;
+				if (lowVal>=0xdc00 && lowVal<0xe000)
+					val=0x10000+((val-0xd800)<<10)+(lowVal-0xdc00);
+				else
+				{
+					WPS_DEBUG_MSG(("libwps::appendUTF16LE: error: surrogate character = %x\n", val));
+					val=replaceChar;
+				}
+			}
+		}
+		if (val)
+			appendUnicode(val, res);
+	}
 }
 }
 
@@ -155,6 +155,25 @@ class GenericException
 };
 }
 
+#define WPS_LE_GET_GUINT16(p)				  			\
+        (uint16_t)((((uint8_t const *)(p))[0] << 0)  |	\
+                  (((uint8_t const *)(p))[1] << 8))
+#define WPS_LE_GET_GUINT32(p)				  			\
+        (uint32_t)((((uint8_t const *)(p))[0] << 0) |	\
+                  (((uint8_t const *)(p))[1] << 8)  |	\
+                  (((uint8_t const *)(p))[2] << 16) |	\
+                  (((uint8_t const *)(p))[3] << 24))
+
+#define WPS_LE_PUT_GUINT16(p, v)				  		\
+	*((uint8_t*)(p)) = uint8_t(v);				  		\
+	*(((uint8_t*)(p)) + 1) = uint8_t((v) >> 8)
+
+#define WPS_LE_PUT_GUINT32(p, v)				  		\
+	*((uint8_t*)(p)) = uint8_t(v);				  		\
+	*(((uint8_t*)(p)) + 1) = uint8_t((v) >> 8);			\
+	*(((uint8_t*)(p)) + 2) = uint8_t((v) >> 16);		\
+	*(((uint8_t*)(p)) + 3) = uint8_t((v) >> 24)
+
 /* ---------- input ----------------- */
 namespace libwps
 {
@@ -192,6 +211,131 @@ inline int32_t read32(RVNGInputStreamPtr &input)
 	return read32(input.get());
 }
 
+/** small class used to read a zone of little endian data with only one call to
+	RVNGInputStream::read, the fields being then decoded from an internal buffer.
+
+	\note as with readU8, reading after the end of the zone returns 0 */
+class BufferedReader
+{
+public:
+	//! constructor: tries to read sz bytes from the actual position of input
+	BufferedReader(librevenge::RVNGInputStream *input, unsigned long sz);
+	//! constructor: tries to read sz bytes from the actual position of input
+	BufferedReader(RVNGInputStreamPtr &input, unsigned long sz);
+	//! destructor
+	~BufferedReader();
+	//! returns true if all the asked data have been read
+	bool isOk() const
+	{
+		return m_size==m_askedSize;
+	}
+	//! returns the number of bytes read in the input
+	unsigned long size() const
+	{
+		return m_size;
+	}
+	//! returns the actual position in the zone
+	unsigned long tell() const
+	{
+		return m_pos;
+	}
+	//! returns the number of bytes which remain to be read
+	unsigned long remaining() const
+	{
+		return m_pos<m_size ? m_size-m_pos : 0;
+	}
+	//! returns true if we have read all the zone
+	bool isEnd() const
+	{
+		return m_pos>=m_size;
+	}
+	//! sets the position in the zone
+	void seek(unsigned long pos)
+	{
+		m_pos=pos;
+	}
+	//! skips n bytes
+	void skip(unsigned long n)
+	{
+		m_pos+=n;
+	}
+	//! returns a pointer to the actual position in the zone or 0 if we are at the end of the zone
+	unsigned char const *data() const
+	{
+		return m_pos<m_size ? m_data+m_pos : 0;
+	}
+	//! reads a unsigned 8 bits integer
+	uint8_t readU8()
+	{
+		if (m_pos>=m_size)
+		{
+			shortRead();
+			return 0;
+		}
+		return m_data[m_pos++];
+	}
+	//! reads a unsigned 16 bits integer
+	uint16_t readU16()
+	{
+		if (m_pos+2>m_size)
+		{
+			uint16_t res=readU8();
+			return uint16_t(res|(readU8()<<8));
+		}
+		uint16_t res=WPS_LE_GET_GUINT16(m_data+m_pos);
+		m_pos+=2;
+		return res;
+	}
+	//! reads a unsigned 32 bits integer
+	uint32_t readU32()
+	{
+		if (m_pos+4>m_size)
+		{
+			uint32_t res=readU16();
+			return res|(uint32_t(readU16())<<16);
+		}
+		uint32_t res=WPS_LE_GET_GUINT32(m_data+m_pos);
+		m_pos+=4;
+		return res;
+	}
+	//! reads a signed 8 bits integer
+	int8_t read8()
+	{
+		return (int8_t) readU8();
+	}
+	//! reads a signed 16 bits integer
+	int16_t read16()
+	{
+		return (int16_t) readU16();
+	}
+	//! reads a signed 32 bits integer
+	int32_t read32()
+	{
+		return (int32_t) readU32();
+	}
+protected:
+	//! initializes the buffer
+	void init(librevenge::RVNGInputStream *input);
+	//! called when we try to read after the end of the zone
+	void shortRead();
+
+	//! the number of bytes we want to read
+	unsigned long m_askedSize;
+	//! the number of bytes read
+	unsigned long m_size;
+	//! the actual position
+	unsigned long m_pos;
+	//! a small buffer used to store short zones
+	unsigned char m_localBuffer[32];
+	//! a buffer used to store long zones
+	std::vector<unsigned char> m_buffer;
+	//! a pointer to the zone data
+	unsigned char const *m_data;
+private:
+	BufferedReader(BufferedReader const &orig);
+	BufferedReader &operator=(BufferedReader const &orig);
+};
+
 //! read a double store with 4 bytes: mantisse 2.5 bytes, exponent 1.5 bytes
 bool readDouble4(RVNGInputStreamPtr &input, double &res, bool &isNaN);
 //! read a double store with 8 bytes: mantisse 6.5 bytes, exponent 1.5 bytes
@@ -209,26 +353,18 @@ bool readData(RVNGInputStreamPtr &input, unsigned long sz, librevenge::RVNGBinar
 bool readDataToEnd(RVNGInputStreamPtr &input, librevenge::RVNGBinaryData &data);
 //! adds an unicode character to a string ( with correct encoding ).
 void appendUnicode(uint32_t val, librevenge::RVNGString &buffer);
-}
-
-#define WPS_LE_GET_GUINT16(p)				  			\
-        (uint16_t)((((uint8_t const *)(p))[0] << 0)  |	\
-                  (((uint8_t const *)(p))[1] << 8))
-#define WPS_LE_GET_GUINT32(p)				  			\
-        (uint32_t)((((uint8_t const *)(p))[0] << 0) |	\
-                  (((uint8_t const *)(p))[1] << 8)  |	\
-                  (((uint8_t const *)(p))[2] << 16) |	\
-                  (((uint8_t const *)(p))[3] << 24))
+//! adds an unicode character to a UTF-8 std::string buffer
+void appendUnicode(uint32_t val, std::string &buffer);
+/** converts a UTF-16LE buffer of numUnits characters in UTF-8 and appends it to res.
 
-#define WPS_LE_PUT_GUINT16(p, v)				  		\
-	*((uint8_t*)(p)) = uint8_t(v);				  		\
-	*(((uint8_t*)(p)) + 1) = uint8_t((v) >> 8)
+	The surrogate pairs are combined, the unpaired surrogates are replaced
+	by replaceChar (or skipped if replaceChar is 0) and the characters less
+	than 0x20 are skipped.
 
-#define WPS_LE_PUT_GUINT32(p, v)				  		\
-	*((uint8_t*)(p)) = uint8_t(v);				  		\
-	*(((uint8_t*)(p)) + 1) = uint8_t((v) >> 8);			\
-	*(((uint8_t*)(p)) + 2) = uint8_t((v) >> 16);		\
-	*(((uint8_t*)(p)) + 3) = uint8_t((v) >> 24)
+	\note as readU16 followed by a per character decoding, a high surrogate
+	consumes the following character even if it is not a low surrogate. */
+void appendUTF16LE(unsigned char const *data, unsigned long numUnits, std::string &res, uint32_t replaceChar=0xfffd);
+}
 
 // Various helper structures for the parser..
 /* ---------- small enum/class ------------- */
@@ -7128,157 +7128,244 @@ static unsigned long unicodeFromMacSymbol(unsigned char c)
 	return macSymbol[c - 0x20];
 }
 
-unsigned long Font::LICSunicode(unsigned char c, Type type)
-{
-	static unsigned char const LICS[] =
-	{
-		0xB0, 0xEF, 0xB1, 0xF9, 0xB2, 0x9F, 0xB4, 0xB9, 0xBA, 0xBB, 0xBC, 0xBF, 0xC0, 0xC1, 0xC2, 0xC3,
-		0xC5, 0xC8, 0xC9, 0xCB, 0xCC, 0xD5, 0xC4, 0xD9, 0xDA, 0xDB, 0xDC, 0xDF, 0xF2, 0xB3, 0xFE, 0xFF,
-		0xCA, 0xAD, 0xBD, 0x9C, 0xCD, 0xBE, 0xDD, 0xF5, 0xCF, 0xB8, 0xA6, 0xAE, 0xAA, 0xF0, 0xA9, 0xEE,
-		0xF8, 0xF1, 0xFD, 0xFC, 0xCE, 0xE6, 0xF4, 0xFA, 0xF7, 0xFB, 0xA7, 0xAF, 0xAC, 0xAB, 0xF3, 0xA8,
-		0xB7, 0xB5, 0xB6, 0xC7, 0x8E, 0x8F, 0x92, 0x80, 0xD4, 0x90, 0xD2, 0xD3, 0xDE, 0xD6, 0xD7, 0xD8,
-		0xD1, 0xA5, 0xE3, 0xE0, 0xE2, 0xE5, 0x99, 0x9E, 0x9D, 0xEB, 0xE9, 0xEA, 0x9A, 0xED, 0xE7, 0xE1,
-		0x85, 0xA0, 0x83, 0xC6, 0x84, 0x86, 0x91, 0x87, 0x8A, 0x82, 0x88, 0x89, 0x8D, 0xA1, 0x8C, 0x8B,
-		0xD0, 0xA4, 0x95, 0xA2, 0x93, 0xE4, 0x94, 0xF6, 0x9B, 0x97, 0xA3, 0x96, 0x81, 0x98, 0xE8, 0xEC
-	};
-	if (c < 0x80) return unicode(c,type);
-	return unicode(LICS[c - 0x80],type);
-}
-
-unsigned long Font::unicode(unsigned char c, Font::Type type)
+//! converts a character in unicode using the per code page functions
+static unsigned long unicodeFromType(unsigned char c, Font::Type type)
 {
 	switch (type)
 	{
-	case CP_037:
+	case Font::CP_037:
 		return unicodeFromCP037(c);
-	case CP_424:
+	case Font::CP_424:
 		return unicodeFromCP424(c);
-	case CP_437:
+	case Font::CP_437:
 		return unicodeFromCP437(c);
-	case CP_500:
+	case Font::CP_500:
 		return unicodeFromCP500(c);
-	case CP_737:
+	case Font::CP_737:
 		return unicodeFromCP737(c);
-	case CP_775:
+	case Font::CP_775:
 		return unicodeFromCP775(c);
-	case DOS_850:
+	case Font::DOS_850:
 		return unicodeFromCP850(c);
-	case CP_852:
+	case Font::CP_852:
 		return unicodeFromCP852(c);
-	case CP_855:
+	case Font::CP_855:
 		return unicodeFromCP855(c);
-	case CP_856:
+	case Font::CP_856:
 		return unicodeFromCP856(c);
-	case CP_857:
+	case Font::CP_857:
 		return unicodeFromCP857(c);
-	case CP_860:
+	case Font::CP_860:
 		return unicodeFromCP860(c);
-	case CP_861:
+	case Font::CP_861:
 		return unicodeFromCP861(c);
-	case CP_862:
+	case Font::CP_862:
 		return unicodeFromCP862(c);
-	case CP_863:
+	case Font::CP_863:
 		return unicodeFromCP863(c);
-	case CP_864:
+	case Font::CP_864:
 		return unicodeFromCP864(c);
-	case CP_865:
+	case Font::CP_865:
 		return unicodeFromCP865(c);
-	case CP_866:
+	case Font::CP_866:
 		return unicodeFromCP866(c);
-	case CP_869:
+	case Font::CP_869:
 		return unicodeFromCP869(c);
-	case CP_874:
+	case Font::CP_874:
 		return unicodeFromCP874(c);
-	case CP_875:
+	case Font::CP_875:
 		return unicodeFromCP875(c);
-	case CP_1006:
+	case Font::CP_1006:
 		return unicodeFromCP1006(c);
-	case CP_1026:
+	case Font::CP_1026:
 		return unicodeFromCP1026(c);
-	case WIN3_ARABIC:
+	case Font::WIN3_ARABIC:
 		return unicodeFromCP1256(c);
-	case WIN3_BALTIC:
+	case Font::WIN3_BALTIC:
 		return unicodeFromCP1257(c);
-	case WIN3_CEUROPE:
+	case Font::WIN3_CEUROPE:
 		return unicodeFromCP1250(c);
-	case WIN3_CYRILLIC:
+	case Font::WIN3_CYRILLIC:
 		return unicodeFromCP1251(c);
-	case WIN3_GREEK:
+	case Font::WIN3_GREEK:
 		return unicodeFromCP1253(c);
-	case WIN3_HEBREW:
+	case Font::WIN3_HEBREW:
 		return unicodeFromCP1255(c);
-	case WIN3_TURKISH:
+	case Font::WIN3_TURKISH:
 		return unicodeFromCP1254(c);
-	case WIN3_VIETNAMESE:
+	case Font::WIN3_VIETNAMESE:
 		return unicodeFromCP1258(c);
-	case WIN3_WEUROPE:
+	case Font::WIN3_WEUROPE:
 		return unicodeFromCP1252(c);
-	case WIN3_WINGDINGS:
+	case Font::WIN3_WINGDINGS:
 		return unicodeFromWingdings(c);
 
-	case MAC_ARABIC:
+	case Font::MAC_ARABIC:
 		return unicodeFromMacArabic(c);
-	case MAC_CELTIC:
+	case Font::MAC_CELTIC:
 		return unicodeFromMacCeltic(c);
-	case MAC_CEUROPE:
+	case Font::MAC_CEUROPE:
 		return unicodeFromMacCEurope(c);
-	case MAC_CROATIAN:
+	case Font::MAC_CROATIAN:
 		return unicodeFromMacCroatian(c);
-	case MAC_CYRILLIC:
+	case Font::MAC_CYRILLIC:
 		return unicodeFromMacCyrillic(c);
-	case MAC_DEVANAGA:
+	case Font::MAC_DEVANAGA:
 		return unicodeFromMacDevanaga(c);
-	case MAC_FARSI:
+	case Font::MAC_FARSI:
 		return unicodeFromMacFarsi(c);
-	case MAC_GAELIC:
+	case Font::MAC_GAELIC:
 		return unicodeFromMacGaelic(c);
-	case MAC_GREEK:
+	case Font::MAC_GREEK:
 		return unicodeFromMacGreek(c);
-	case MAC_GUJARATI:
+	case Font::MAC_GUJARATI:
 		return unicodeFromMacGujarati(c);
-	case MAC_GURMUKHI:
+	case Font::MAC_GURMUKHI:
 		return unicodeFromMacGurmukhi(c);
-	case MAC_HEBREW:
+	case Font::MAC_HEBREW:
 		return unicodeFromMacHebrew(c);
-	case MAC_ICELAND:
+	case Font::MAC_ICELAND:
 		return unicodeFromMacIceland(c);
-	case MAC_INUIT:
+	case Font::MAC_INUIT:
 		return unicodeFromMacInuit(c);
-	case MAC_ROMAN:
+	case Font::MAC_ROMAN:
 		return unicodeFromMacRoman(c);
-	case MAC_ROMANIAN:
+	case Font::MAC_ROMANIAN:
 		return unicodeFromMacRomanian(c);
-	case MAC_THAI:
+	case Font::MAC_THAI:
 		return unicodeFromMacThai(c);
-	case MAC_TURKISH:
+	case Font::MAC_TURKISH:
 		return unicodeFromMacTurkish(c);
 
-	case MAC_SYMBOL:
+	case Font::MAC_SYMBOL:
 		return unicodeFromMacSymbol(c);
-	case CP_932:
-	case CP_950:
-	case UNKNOWN:
+	case Font::CP_932:
+	case Font::CP_950:
+	case Font::UNKNOWN:
 	default:
-		WPS_DEBUG_MSG(("Font::unicode: called with unimplemented type\n"));
 		return c;
 	}
 }
 
+//! the LICS to DOS 850 characters table
+static unsigned char const s_LICSToCP850[] =
+{
+	0xB0, 0xEF, 0xB1, 0xF9, 0xB2, 0x9F, 0xB4, 0xB9, 0xBA, 0xBB, 0xBC, 0xBF, 0xC0, 0xC1, 0xC2, 0xC3,
+	0xC5, 0xC8, 0xC9, 0xCB, 0xCC, 0xD5, 0xC4, 0xD9, 0xDA, 0xDB, 0xDC, 0xDF, 0xF2, 0xB3, 0xFE, 0xFF,
+	0xCA, 0xAD, 0xBD, 0x9C, 0xCD, 0xBE, 0xDD, 0xF5, 0xCF, 0xB8, 0xA6, 0xAE, 0xAA, 0xF0, 0xA9, 0xEE,
+	0xF8, 0xF1, 0xFD, 0xFC, 0xCE, 0xE6, 0xF4, 0xFA, 0xF7, 0xFB, 0xA7, 0xAF, 0xAC, 0xAB, 0xF3, 0xA8,
+	0xB7, 0xB5, 0xB6, 0xC7, 0x8E, 0x8F, 0x92, 0x80, 0xD4, 0x90, 0xD2, 0xD3, 0xDE, 0xD6, 0xD7, 0xD8,
+	0xD1, 0xA5, 0xE3, 0xE0, 0xE2, 0xE5, 0x99, 0x9E, 0x9D, 0xEB, 0xE9, 0xEA, 0x9A, 0xED, 0xE7, 0xE1,
+	0x85, 0xA0, 0x83, 0xC6, 0x84, 0x86, 0x91, 0x87, 0x8A, 0x82, 0x88, 0x89, 0x8D, 0xA1, 0x8C, 0x8B,
+	0xD0, 0xA4, 0x95, 0xA2, 0x93, 0xE4, 0x94, 0xF6, 0x9B, 0x97, 0xA3, 0x96, 0x81, 0x98, 0xE8, 0xEC
+};
 
-librevenge::RVNGString Font::unicodeString(const unsigned char *p, unsigned long size, Font::Type type)
+/** the tables used to convert the one byte encodings in unicode
+
+	\note the multi-bytes encodings and UNKNOWN correspond to an identity table */
+struct UnicodeTables
 {
-	librevenge::RVNGString str;
+	//! constructor: creates the table of each encoding
+	UnicodeTables()
+	{
+		for (int t=0; t<=Font::UNKNOWN; ++t)
+		{
+			Font::Type type=Font::Type(t);
+			m_isDefined[t]=type!=Font::CP_932 && type!=Font::CP_950 && type!=Font::UNKNOWN;
+			m_isASCIICompatible[t]=true;
+			for (int c=0; c<256; ++c)
+			{
+				m_tables[t][c]=uint32_t(unicodeFromType((unsigned char) c, type));
+				if (c>=0x20 && c<0x80 && m_tables[t][c]!=uint32_t(c))
+					m_isASCIICompatible[t]=false;
+			}
+		}
+	}
+	//! the character to unicode tables
+	uint32_t m_tables[Font::UNKNOWN+1][256];
+	//! a flag to know if a table is defined
+	bool m_isDefined[Font::UNKNOWN+1];
+	//! a flag to know if the characters 0x20-0x7f are converted in themselves
+	bool m_isASCIICompatible[Font::UNKNOWN+1];
+};
+
+//! the unicode tables (computed once when the library is loaded)
+static UnicodeTables const s_unicodeTables;
+
+uint32_t const *Font::unicodeTable(Type type)
+{
+	if (type<0 || type>=UNKNOWN || !s_unicodeTables.m_isDefined[type])
+		return 0;
+	return s_unicodeTables.m_tables[type];
+}
+
+unsigned long Font::LICSunicode(unsigned char c, Type type)
+{
+	if (c < 0x80) return unicode(c,type);
+	return unicode(s_LICSToCP850[c - 0x80],type);
+}
+
+unsigned long Font::unicode(unsigned char c, Font::Type type)
+{
+	uint32_t const *table=unicodeTable(type);
+	if (table)
+		return table[c];
+	WPS_DEBUG_MSG(("Font::unicode: called with unimplemented type\n"));
+	return c;
+}
+
+void Font::appendUnicodeString(const unsigned char *p, unsigned long size, Type type,
+                               librevenge::RVNGString &str, bool LICS, bool skipUndefined)
+{
+	if (!p || !size) return;
+	if (type == CP_932 || type == CP_950)
+	{
+		str.append(type == CP_932 ? unicodeFromCP932(p, size) : unicodeFromCP950(p, size));
+		return;
+	}
+	int const t=(type<0 || type>UNKNOWN) ? int(UNKNOWN) : int(type);
+	if (!s_unicodeTables.m_isDefined[t])
+	{
+		WPS_DEBUG_MSG(("Font::appendUnicodeString: called with unimplemented type\n"));
+	}
+	uint32_t const *table=s_unicodeTables.m_tables[t];
+	bool const asciiCompatible=s_unicodeTables.m_isASCIICompatible[t];
+	std::string buffer;
+	buffer.reserve(size_t(size)+16);
+	unsigned long i=0;
+	while (i<size)
+	{
+		if (asciiCompatible)
+		{
+			// fast path: copy the runs of ASCII characters
+			unsigned long first=i;
+			while (i<size && p[i]>=0x20 && p[i]<0x80)
+				++i;
+			if (i!=first)
+				buffer.append(reinterpret_cast<char const *>(p+first), size_t(i-first));
+			if (i>=size) break;
+		}
+		unsigned char c=p[i++];
+		if (LICS && c>=0x80)
+			c=s_LICSToCP850[c-0x80];
+		uint32_t val=table[c];
+		if (val==0xfffd && skipUndefined)
+			continue;
+		libwps::appendUnicode(val, buffer);
+	}
+	str.append(buffer.c_str());
+}
+
 
+librevenge::RVNGString Font::unicodeString(const unsigned char *p, unsigned long size, Font::Type type)
+{
 	if (type == CP_932)
 		return unicodeFromCP932(p, size);
 	if (type == CP_950)
 		return unicodeFromCP950(p, size);
 
-	for (unsigned long i=0; i<size; i++)
-	{
-		libwps::appendUnicode((uint32_t) unicode(p[i], type), str);
-	}
-
+	librevenge::RVNGString str;
+	appendUnicodeString(p, size, type, str);
 	return str;
 }
 
@@ -65,6 +65,16 @@ public:
 	static unsigned long unicode(unsigned char c, Type type);
 	//! converts a LICS character in unicode, knowing the character and the font type
 	static unsigned long LICSunicode(unsigned char c, Type type);
+	/** returns the 256 entries table used to convert the characters of a one byte encoding in unicode
+
+		\note returns 0 for the multi-bytes encodings and UNKNOWN */
+	static uint32_t const *unicodeTable(Type type);
+	/** converts a string in unicode and appends it to str
+
+		\param LICS if true, the characters are first converted from LICS
+		\param skipUndefined if true, the undefined characters (0xfffd) are skipped */
+	static void appendUnicodeString(const unsigned char *p, unsigned long size, Type type, librevenge::RVNGString &str,
+	                                bool LICS=false, bool skipUndefined=false);
 	/*! returns the type corresponding to Windows OEM */
 	static Type getTypeForOEM(int oem);
 	/*! returns the type corresponding to encoding string */
@@ -77,6 +87,7 @@ public:
 	static Type getFontType(librevenge::RVNGString &name);
 	//! return the type name
 	static librevenge::RVNGString getTypeName(Type type);
+	//! converts a string in unicode
 	static librevenge::RVNGString unicodeString(const unsigned char *p, unsigned long size, Type type);
 protected:
 };